@@ -0,0 +1,119 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using namespace exl; // NOLINT
+
+static auto random_set(const usize len, const u32 seed) -> BitSet {
+  auto rng = std::mt19937_64(seed);
+  auto set = BitSet(len);
+  for (usize i = 0; i < len; i += 64) {
+    set.data()[i / 64] = rng();
+  }
+  set.resize(len);
+  return set;
+}
+
+static auto random_bools(const usize len, const u32 seed)
+    -> std::vector<bool> {
+  auto rng = std::mt19937_64(seed);
+  auto ret = std::vector<bool>(len);
+  for (usize i = 0; i < len; ++i) {
+    ret[i] = (rng() & 1) != 0;
+  }
+  return ret;
+}
+
+static auto BM_BitSetAnd(benchmark::State &state) -> void {
+  auto lhs = random_set(state.range(0), 1);
+  const auto rhs = random_set(state.range(0), 2);
+  for (auto _ : state) {
+    lhs &= rhs;
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) / 8);
+}
+
+static auto BM_VectorBoolAnd(benchmark::State &state) -> void {
+  auto lhs = random_bools(state.range(0), 1);
+  const auto rhs = random_bools(state.range(0), 2);
+  for (auto _ : state) {
+    for (usize i = 0; i < lhs.size(); ++i) {
+      lhs[i] = lhs[i] && rhs[i];
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) / 8);
+}
+
+static auto BM_BitSetCount(benchmark::State &state) -> void {
+  const auto set = random_set(state.range(0), 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(set.count());
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) / 8);
+}
+
+static auto BM_VectorBoolCount(benchmark::State &state) -> void {
+  const auto set = random_bools(state.range(0), 1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::count(set.begin(), set.end(), true));
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) / 8);
+}
+
+static auto BM_BitSetIterate(benchmark::State &state) -> void {
+  const auto set = random_set(state.range(0), 1);
+  for (auto _ : state) {
+    usize sum = 0;
+    for (const auto bit : set) {
+      sum += bit;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) / 8);
+}
+
+static auto BM_VectorBoolIterate(benchmark::State &state) -> void {
+  const auto set = random_bools(state.range(0), 1);
+  for (auto _ : state) {
+    usize sum = 0;
+    for (usize i = 0; i < set.size(); ++i) {
+      if (set[i]) {
+        sum += i;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0) / 8);
+}
+
+static auto BM_Rank(benchmark::State &state) -> void {
+  const auto set = random_set(state.range(0), 1);
+  const auto index = RankIndex(set.as_slice());
+  auto rng = std::mt19937_64(3);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index.rank(rng() % set.size()));
+  }
+}
+
+static auto BM_Select(benchmark::State &state) -> void {
+  const auto set = random_set(state.range(0), 1);
+  const auto index = RankIndex(set.as_slice());
+  const auto ones = set.count();
+  auto rng = std::mt19937_64(3);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(index.select(rng() % ones));
+  }
+}
+
+BENCHMARK(BM_BitSetAnd)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK(BM_VectorBoolAnd)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK(BM_BitSetCount)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK(BM_VectorBoolCount)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK(BM_BitSetIterate)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK(BM_VectorBoolIterate)->RangeMultiplier(10)->Range(1000, 10000000);
+BENCHMARK(BM_Rank)->Arg(10000000);
+BENCHMARK(BM_Select)->Arg(10000000);
@@ -0,0 +1,105 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "../tests/count_alloc.hpp"
+
+using namespace exl; // NOLINT
+
+static constexpr usize FRAMES = 256;
+static constexpr usize FRAME_SIZE = 4096;
+static constexpr usize TOKEN = 64;
+
+static char INPUT[FRAME_SIZE]; // NOLINT
+
+template <typename T, usize N> static auto send(SpscQueue<T, N> &queue, T val) {
+  while (true) {
+    auto back = queue.try_push(std::move(val));
+    if (back.is_none()) {
+      return;
+    }
+    val = back.unwrap();
+    std::this_thread::yield();
+  }
+}
+
+template <typename T, usize N> static auto recv(SpscQueue<T, N> &queue) -> T {
+  while (true) {
+    if (auto val = queue.try_pop(); val.is_some()) {
+      return val.unwrap();
+    }
+    std::this_thread::yield();
+  }
+}
+
+// reader -> tokenizer -> consumer, one thread per stage. Every stage hands
+// its output on by value, the way owning buffers are passed between threads.
+template <typename Buf, typename MakeFrame, typename Split>
+static auto run_pipeline(benchmark::State &state, MakeFrame make_frame,
+                         Split split) -> void {
+  usize copied = 0;
+  const auto before = ALLOCATIONS.load();
+
+  for (auto _ : state) {
+    auto frames = SpscQueue<Buf, 16>{};
+    auto tokens = SpscQueue<Buf, 256>{};
+
+    auto reader = std::thread([&]() {
+      for (usize i = 0; i < FRAMES; ++i) {
+        send(frames, make_frame(i));
+      }
+    });
+    auto tokenizer = std::thread([&]() {
+      for (usize i = 0; i < FRAMES; ++i) {
+        auto frame = recv(frames);
+        for (usize at = 0; at < FRAME_SIZE; at += TOKEN) {
+          send(tokens, split(frame, at, copied));
+        }
+      }
+    });
+
+    usize sum = 0;
+    for (usize i = 0; i < FRAMES * FRAME_SIZE / TOKEN; ++i) {
+      sum += recv(tokens).size();
+    }
+    benchmark::DoNotOptimize(sum);
+    reader.join();
+    tokenizer.join();
+  }
+
+  state.SetBytesProcessed(state.iterations() * FRAMES * FRAME_SIZE);
+  state.counters["copied/iter"] = benchmark::Counter(
+      static_cast<double>(copied) / static_cast<double>(state.iterations()));
+  state.counters["allocs/iter"] = benchmark::Counter(
+      static_cast<double>(ALLOCATIONS.load() - before) /
+      static_cast<double>(state.iterations()));
+}
+
+static auto BM_PipelineString(benchmark::State &state) -> void {
+  run_pipeline<std::string>(
+      state,
+      [](const usize /*i*/) { return std::string(INPUT, FRAME_SIZE); },
+      [](const std::string &frame, const usize at, usize &copied) {
+        copied += TOKEN;
+        return frame.substr(at, TOKEN);
+      });
+}
+
+static auto BM_PipelineBytes(benchmark::State &state) -> void {
+  run_pipeline<Bytes>(
+      state,
+      [](const usize /*i*/) {
+        auto buf = BytesMut::with_capacity(FRAME_SIZE);
+        buf.append({INPUT, FRAME_SIZE});
+        return buf.freeze();
+      },
+      [](const Bytes &frame, const usize at, usize & /*copied*/) {
+        return frame.slice(at, at + TOKEN).unwrap();
+      });
+}
+
+BENCHMARK(BM_PipelineString)->UseRealTime();
+BENCHMARK(BM_PipelineBytes)->UseRealTime();
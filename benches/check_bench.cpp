@@ -0,0 +1,87 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace exl; // NOLINT
+
+static constexpr usize LEN = 1 << 14;
+
+static auto random_indices(const usize len) -> std::vector<u32> {
+  auto rng = std::mt19937(42); // NOLINT
+  auto idx = std::vector<u32>(len);
+  std::ranges::generate(idx, [&rng, len]() { return rng() % len; });
+  return idx;
+}
+
+// Kept out of line so `nm --size-sort` shows what each policy costs in code.
+template <typename P>
+[[gnu::noinline]] static auto sum_indexed(const Slice<u32, P> slice) -> u64 {
+  u64 sum = 0;
+  for (usize i = 0; i < slice.cap; ++i) {
+    sum += slice[i];
+  }
+  return sum;
+}
+
+template <typename P>
+[[gnu::noinline]] static auto gather(const Slice<u32, P> slice,
+                                     const Slice<u32> idx) -> u64 {
+  u64 sum = 0;
+  for (const auto i : idx) {
+    sum += slice[i];
+  }
+  return sum;
+}
+
+template <typename P>
+static auto BM_SumIndexed(benchmark::State &state) -> void {
+  auto data = random_indices(LEN);
+  auto slice = Slice<u32, P>::from_unchecked(data.data(), data.size());
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(sum_indexed(slice));
+  }
+  state.SetItemsProcessed(state.iterations() * LEN);
+}
+
+template <typename P> static auto BM_Gather(benchmark::State &state) -> void {
+  auto data = random_indices(LEN);
+  auto idx = random_indices(LEN);
+  auto slice = Slice<u32, P>::from_unchecked(data.data(), data.size());
+  auto indices = Slice<u32>::from_unchecked(idx.data(), idx.size());
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(gather(slice, indices));
+  }
+  state.SetItemsProcessed(state.iterations() * LEN);
+}
+
+static auto BM_UnwrapChecked(benchmark::State &state) -> void {
+  auto val = Option<u64>(1);
+  u64 sum = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(val);
+    sum += val.unwrap();
+  }
+  benchmark::DoNotOptimize(sum);
+}
+
+static auto BM_UnwrapUnchecked(benchmark::State &state) -> void {
+  auto val = Option<u64>(1);
+  u64 sum = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(val);
+    sum += val.unwrap<check::Unchecked>();
+  }
+  benchmark::DoNotOptimize(sum);
+}
+
+BENCHMARK(BM_SumIndexed<check::Checked>);
+BENCHMARK(BM_SumIndexed<check::Unchecked>);
+BENCHMARK(BM_Gather<check::Checked>);
+BENCHMARK(BM_Gather<check::Unchecked>);
+BENCHMARK(BM_UnwrapChecked);
+BENCHMARK(BM_UnwrapUnchecked);
@@ -0,0 +1,88 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <unordered_map>
+
+using namespace exl; // NOLINT
+
+static constexpr u64 KEYS = 1 << 16;
+static constexpr usize OPS = 1024;
+
+struct LockedMap {
+  std::mutex lock;
+  std::unordered_map<u64, u64> map;
+
+  auto get(const u64 key) -> Option<u64> {
+    const auto guard = std::lock_guard(lock);
+    const auto it = map.find(key);
+    return it == map.end() ? Option<u64>() : Option<u64>(it->second);
+  }
+
+  auto upsert(const u64 key, const u64 val) -> void {
+    const auto guard = std::lock_guard(lock);
+    map.insert_or_assign(key, val);
+  }
+};
+
+struct ShardedMap {
+  ConcurrentMap<u64, u64> map;
+
+  auto get(const u64 key) -> Option<u64> { return map.get(key); }
+
+  auto upsert(const u64 key, const u64 val) -> void { map.upsert(key, val); }
+};
+
+// One map per benchmark run, filled by thread 0 before the timed loop.
+template <typename M> static auto shared_map() -> M & {
+  static auto *map = new M(); // NOLINT
+  return *map;
+}
+
+// WRITES out of every 100 operations are upserts, the rest lookups.
+template <typename M, u64 WRITES>
+static auto BM_Mix(benchmark::State &state) {
+  auto &map = shared_map<M>();
+  if (state.thread_index() == 0) {
+    for (u64 key = 0; key < KEYS; ++key) {
+      map.upsert(key, key);
+    }
+  }
+  auto rng =
+      static_cast<u64>(state.thread_index() + 1) * 0x9e3779b97f4a7c15ULL;
+  for (auto _ : state) {
+    for (usize i = 0; i < OPS; ++i) {
+      rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+      const auto key = (rng >> 20) % KEYS;
+      if ((rng >> 56) % 100 < WRITES) {
+        map.upsert(key, rng);
+      } else {
+        benchmark::DoNotOptimize(map.get(key));
+      }
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * OPS);
+}
+
+// Fills a fresh map from one thread with keys `i << shift`. Keys that
+// differ only in their high bits, such as packed ids, must spread as well
+// as dense ones.
+static auto BM_InsertStrided(benchmark::State &state) {
+  const auto shift = static_cast<u64>(state.range(0));
+  static constexpr u64 COUNT = 200000;
+  for (auto _ : state) {
+    auto map = ConcurrentMap<u64, u64>();
+    for (u64 i = 0; i < COUNT; ++i) {
+      map.upsert(i << shift, i);
+    }
+    benchmark::DoNotOptimize(map.size());
+  }
+  state.SetItemsProcessed(state.iterations() * COUNT);
+}
+
+// 5% writes, like a warm memoization cache, and 50%.
+BENCHMARK_TEMPLATE2(BM_Mix, LockedMap, 5)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE2(BM_Mix, ShardedMap, 5)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE2(BM_Mix, LockedMap, 50)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK_TEMPLATE2(BM_Mix, ShardedMap, 50)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_InsertStrided)->Arg(0)->Arg(32)->Unit(benchmark::kMillisecond);
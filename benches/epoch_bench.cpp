@@ -0,0 +1,104 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <shared_mutex>
+
+using namespace exl; // NOLINT
+
+using Clock = std::chrono::steady_clock;
+
+// NOLINTBEGIN
+static sync::Epoch DOMAIN;
+static std::shared_mutex RW_LOCK;
+// NOLINTEND
+
+static auto BM_PinUnpin(benchmark::State &state) {
+  for (auto _ : state) {
+    const auto guard = DOMAIN.pin();
+    benchmark::ClobberMemory();
+  }
+}
+
+// What a read-mostly structure pays without reclamation: a shared lock.
+static auto BM_SharedLock(benchmark::State &state) {
+  for (auto _ : state) {
+    const auto guard = std::shared_lock(RW_LOCK);
+    benchmark::ClobberMemory();
+  }
+}
+
+struct Node {
+  Clock::time_point retired;
+  u64 value;
+};
+
+static constexpr usize SLOTS = 1024;
+
+// NOLINTBEGIN
+static std::array<std::atomic<Node *>, SLOTS> SLOTS_OF_NODES{};
+static std::atomic<u64> LATENCY_NS{};
+static std::atomic<u64> FREED{};
+static std::atomic<u64> MAX_LATENCY_NS{};
+// NOLINTEND
+
+static auto free_node(void *ptr) -> void {
+  auto *node = static_cast<Node *>(ptr);
+  const auto latency = static_cast<u64>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() -
+                                                           node->retired)
+          .count());
+  LATENCY_NS.fetch_add(latency, std::memory_order_relaxed);
+  FREED.fetch_add(1, std::memory_order_relaxed);
+  auto max = MAX_LATENCY_NS.load(std::memory_order_relaxed);
+  while (latency > max &&
+         !MAX_LATENCY_NS.compare_exchange_weak(max, latency,
+                                               std::memory_order_relaxed)) {
+  }
+  delete node; // NOLINT
+}
+
+// Thread 0 replaces nodes as fast as it can while the other threads read
+// them under pins. Reports how long retired nodes waited to be freed.
+static auto BM_WriteChurn(benchmark::State &state) {
+  auto rng = static_cast<u64>(state.thread_index()) * 0x9e3779b97f4a7c15ULL;
+  if (state.thread_index() == 0) {
+    for (auto &slot : SLOTS_OF_NODES) {
+      if (auto *old = slot.exchange(new Node{Clock::now(), 1})) {
+        DOMAIN.retire(old);
+      }
+    }
+    LATENCY_NS = 0;
+    FREED = 0;
+    MAX_LATENCY_NS = 0;
+  }
+  for (auto _ : state) {
+    rng = rng * 6364136223846793005ULL + 1442695040888963407ULL;
+    const auto slot = (rng >> 33) % SLOTS;
+    if (state.thread_index() == 0) {
+      auto *fresh = new Node{Clock::now(), rng};
+      auto *old = SLOTS_OF_NODES[slot].exchange(fresh);
+      old->retired = Clock::now();
+      DOMAIN.retire(old, free_node);
+    } else {
+      const auto guard = DOMAIN.pin();
+      benchmark::DoNotOptimize(
+          SLOTS_OF_NODES[slot].load(std::memory_order_acquire)->value);
+    }
+  }
+  if (state.thread_index() == 0) {
+    const auto freed = static_cast<double>(FREED.load());
+    state.counters["freed_pct"] =
+        100 * freed / static_cast<double>(state.iterations());
+    state.counters["avg_latency_us"] =
+        freed == 0 ? 0 : static_cast<double>(LATENCY_NS) / freed / 1000;
+    state.counters["max_latency_us"] =
+        static_cast<double>(MAX_LATENCY_NS) / 1000;
+  }
+}
+
+BENCHMARK(BM_PinUnpin)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_SharedLock)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_WriteChurn)->ThreadRange(2, 8)->UseRealTime();
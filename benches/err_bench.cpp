@@ -0,0 +1,85 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <fmt/format.h>
+#include <string>
+
+#include "../tests/count_alloc.hpp"
+
+using namespace exl; // NOLINT
+
+static auto report_allocations(benchmark::State &state, const usize before)
+    -> void {
+  state.counters["allocs/iter"] = benchmark::Counter(
+      static_cast<double>(ALLOCATIONS.load() - before) /
+      static_cast<double>(state.iterations()));
+}
+
+struct OwnedParseError {
+  usize offset{};
+
+  [[nodiscard]] auto description() const -> std::string {
+    return fmt::format("Unexpected byte at {}", offset);
+  }
+};
+
+struct ParseError {
+  usize offset{};
+
+  template <typename OutputIt> auto format_to(OutputIt out) const -> OutputIt {
+    return fmt::format_to(out, "Unexpected byte at {}", offset);
+  }
+};
+
+template <typename E>
+static auto parse_digits(const std::string_view src) -> Result<u64, E> {
+  u64 res = 0;
+  for (usize i = 0; i < src.size(); ++i) {
+    if (src[i] < '0' || src[i] > '9') {
+      return {E{i}};
+    }
+    res = res * 10 + static_cast<u64>(src[i] - '0'); // NOLINT
+  }
+  return {res};
+}
+
+static constexpr auto BAD_INPUT = std::string_view("12345x7");
+
+static auto BM_FailingParseOwnedStrings(benchmark::State &state) -> void {
+  const auto before = ALLOCATIONS.load();
+  for (auto _ : state) {
+    auto res = parse_digits<OwnedParseError>(BAD_INPUT);
+    auto msg = std::string("loading file: reading header: ");
+    msg += std::get<OwnedParseError>(res).description();
+    benchmark::DoNotOptimize(msg);
+  }
+  report_allocations(state, before);
+}
+
+static auto BM_FailingParseContext(benchmark::State &state) -> void {
+  auto buf = fmt::memory_buffer();
+  const auto before = ALLOCATIONS.load();
+  for (auto _ : state) {
+    auto res = parse_digits<::ParseError>(BAD_INPUT)
+                   .context("reading header")
+                   .context("loading file");
+    buf.clear();
+    fmt::format_to(std::back_inserter(buf), "{}",
+                   std::get<Context<::ParseError>>(res));
+    benchmark::DoNotOptimize(buf.data());
+  }
+  report_allocations(state, before);
+}
+
+static auto BM_FailingParseNoFormat(benchmark::State &state) -> void {
+  for (auto _ : state) {
+    auto res = parse_digits<::ParseError>(BAD_INPUT)
+                   .context("reading header")
+                   .context("loading file");
+    benchmark::DoNotOptimize(res);
+  }
+}
+
+BENCHMARK(BM_FailingParseOwnedStrings);
+BENCHMARK(BM_FailingParseContext);
+BENCHMARK(BM_FailingParseNoFormat);
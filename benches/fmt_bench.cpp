@@ -0,0 +1,93 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+
+using namespace exl; // NOLINT
+
+// Formats the way exl::println did before: runtime format string and a
+// second stdio call for the newline.
+template <typename T, typename... Args>
+static auto legacy_println(std::FILE *file, const T format,
+                           const Args &...args) -> void {
+  fmt::print(file, fmt::runtime(format), args...);
+  std::putc('\n', file);
+}
+
+struct NullStdout {
+  std::FILE *null = std::fopen("/dev/null", "w");
+  std::FILE *saved = impl::stdout_buffer().file;
+  usize saved_flush_at = impl::stdout_buffer().flush_at;
+
+  // Buffered as for redirected output, even when run from a terminal.
+  NullStdout() {
+    impl::stdout_buffer().file = null;
+    impl::stdout_buffer().flush_at = impl::PrintBuffer::PRINT_FLUSH_AT;
+  }
+
+  NullStdout(const NullStdout &) = delete;
+  NullStdout(NullStdout &&) = delete;
+  auto operator=(const NullStdout &) -> NullStdout & = delete;
+  auto operator=(NullStdout &&) -> NullStdout & = delete;
+
+  ~NullStdout() {
+    flush();
+    impl::stdout_buffer().file = saved;
+    impl::stdout_buffer().flush_at = saved_flush_at;
+    std::fclose(null);
+  }
+};
+
+static auto BM_LegacyPrintln(benchmark::State &state) -> void {
+  auto *null = std::fopen("/dev/null", "w");
+  u64 line = 0;
+  for (auto _ : state) {
+    legacy_println(null, "[INFO] {}:{} evaluated {} in {}us", "main.expr",
+                   ++line, "x + y", 42); // NOLINT
+  }
+  std::fclose(null);
+  state.SetItemsProcessed(state.iterations());
+}
+
+static auto BM_Println(benchmark::State &state) -> void {
+  auto guard = NullStdout();
+  u64 line = 0;
+  for (auto _ : state) {
+    println("[INFO] {}:{} evaluated {} in {}us", "main.expr", ++line, "x + y",
+            42); // NOLINT
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static auto BM_PrintlnCompiled(benchmark::State &state) -> void {
+  auto guard = NullStdout();
+  u64 line = 0;
+  for (auto _ : state) {
+    println(FMT_COMPILE("[INFO] {}:{} evaluated {} in {}us"), "main.expr",
+            ++line, "x + y", 42); // NOLINT
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static auto BM_PrintlnShort(benchmark::State &state) -> void {
+  auto guard = NullStdout();
+  for (auto _ : state) {
+    println("ok");
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+static auto BM_LegacyPrintlnShort(benchmark::State &state) -> void {
+  auto *null = std::fopen("/dev/null", "w");
+  for (auto _ : state) {
+    legacy_println(null, "ok");
+  }
+  std::fclose(null);
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK(BM_LegacyPrintln);
+BENCHMARK(BM_Println);
+BENCHMARK(BM_PrintlnCompiled);
+BENCHMARK(BM_LegacyPrintlnShort);
+BENCHMARK(BM_PrintlnShort);
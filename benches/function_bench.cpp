@@ -0,0 +1,78 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <functional>
+
+#include "../tests/count_alloc.hpp"
+
+using namespace exl; // NOLINT
+
+static auto report_allocations(benchmark::State &state, const usize before)
+    -> void {
+  state.counters["allocs/iter"] = benchmark::Counter(
+      static_cast<double>(ALLOCATIONS.load() - before) /
+      static_cast<double>(state.iterations()));
+}
+
+[[gnu::noinline]] static auto call_std(const std::function<u64(u64)> &fn,
+                                       const u64 val) -> u64 {
+  return fn(val);
+}
+
+[[gnu::noinline]] static auto call_ref(const FnRef<u64(u64)> fn, const u64 val)
+    -> u64 {
+  return fn(val);
+}
+
+[[gnu::noinline]] static auto call_inplace(InplaceFn<u64(u64)> &fn,
+                                           const u64 val) -> u64 {
+  return fn(val);
+}
+
+static auto BM_CallStdFunction(benchmark::State &state) -> void {
+  auto captures = std::array<u64, 3>{1, 2, 3};
+  const auto before = ALLOCATIONS.load();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(call_std(
+        [captures](u64 val) { return val + captures[0] + captures[2]; }, 1));
+  }
+  report_allocations(state, before);
+}
+
+static auto BM_CallFnRef(benchmark::State &state) -> void {
+  auto captures = std::array<u64, 3>{1, 2, 3};
+  const auto before = ALLOCATIONS.load();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(call_ref(
+        [captures](u64 val) { return val + captures[0] + captures[2]; }, 1));
+  }
+  report_allocations(state, before);
+}
+
+static auto BM_CallInplaceFn(benchmark::State &state) -> void {
+  auto captures = std::array<u64, 3>{1, 2, 3};
+  const auto before = ALLOCATIONS.load();
+  for (auto _ : state) {
+    auto fn = InplaceFn<u64(u64)>(
+        [captures](u64 val) { return val + captures[0] + captures[2]; });
+    benchmark::DoNotOptimize(call_inplace(fn, 1));
+  }
+  report_allocations(state, before);
+}
+
+static auto BM_UnwrapOrElse(benchmark::State &state) -> void {
+  auto captures = std::array<u64, 3>{1, 2, 3};
+  auto opt = Option<u64>();
+  const auto before = ALLOCATIONS.load();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        opt.unwrap_or_else([captures]() { return captures[1]; }));
+  }
+  report_allocations(state, before);
+}
+
+BENCHMARK(BM_CallStdFunction);
+BENCHMARK(BM_CallFnRef);
+BENCHMARK(BM_CallInplaceFn);
+BENCHMARK(BM_UnwrapOrElse);
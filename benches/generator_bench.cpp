@@ -0,0 +1,78 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+using namespace exl; // NOLINT
+
+struct CountIter {
+  ssize count{};
+  ssize last{};
+
+  [[nodiscard]] constexpr auto is_done() const -> bool { return count >= last; }
+  [[nodiscard]] constexpr auto operator*() const -> ssize { return count; }
+  constexpr auto operator++() -> void { ++count; }
+};
+
+auto count_to(const ssize n) -> Generator<ssize> {
+  for (ssize i = 0; i < n; ++i) {
+    co_yield i;
+  }
+}
+
+auto count_nested(const ssize depth, const ssize width) -> Generator<ssize> {
+  if (depth == 0) {
+    for (ssize i = 0; i < width; ++i) {
+      co_yield i;
+    }
+    co_return;
+  }
+  co_yield count_nested(depth - 1, width);
+}
+
+static auto BM_StateMachine(benchmark::State &state) -> void {
+  const auto len = state.range(0);
+  for (auto _ : state) {
+    ssize res = 0;
+    for (auto it = CountIter{0, len}; !it.is_done(); ++it) {
+      res += *it;
+      benchmark::DoNotOptimize(res);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * len);
+}
+
+static auto BM_Generator(benchmark::State &state) -> void {
+  const auto len = state.range(0);
+  for (auto _ : state) {
+    ssize res = 0;
+    for (auto i : count_to(len)) {
+      res += i;
+      benchmark::DoNotOptimize(res);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * len);
+}
+
+static auto BM_GeneratorYieldFrom(benchmark::State &state) -> void {
+  const auto depth = state.range(0);
+  const auto len = 1024;
+  for (auto _ : state) {
+    ssize res = 0;
+    for (auto i : count_nested(depth, len)) {
+      res += i;
+      benchmark::DoNotOptimize(res);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * len);
+}
+
+static auto BM_GeneratorFrame(benchmark::State &state) -> void {
+  for (auto _ : state) {
+    auto gen = count_to(1);
+    benchmark::DoNotOptimize(gen.handle);
+  }
+}
+
+BENCHMARK(BM_StateMachine)->Range(8, 1 << 16);
+BENCHMARK(BM_Generator)->Range(8, 1 << 16);
+BENCHMARK(BM_GeneratorYieldFrom)->DenseRange(0, 16, 4);
+BENCHMARK(BM_GeneratorFrame);
@@ -0,0 +1,152 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+using namespace exl; // NOLINT
+
+// Generated programs: node (depth, shape) combines two children picked
+// from SHAPES shapes one level down, so a tree with 2^depth leaves has
+// only SHAPES distinct subtrees per level.
+static constexpr u64 SHAPES = 4;
+
+static auto left(const u64 shape) -> u64 { return (shape * 7 + 1) % SHAPES; }
+static auto right(const u64 shape) -> u64 { return (shape * 3 + 2) % SHAPES; }
+
+struct BoxExpr;
+
+struct BoxLit {
+  u64 value;
+};
+
+struct BoxAdd {
+  std::unique_ptr<BoxExpr> lhs;
+  std::unique_ptr<BoxExpr> rhs;
+};
+
+struct BoxMul {
+  std::unique_ptr<BoxExpr> lhs;
+  std::unique_ptr<BoxExpr> rhs;
+};
+
+struct BoxExpr {
+  Union<BoxLit, BoxAdd, BoxMul> _data;
+};
+
+struct Expr;
+
+struct Lit {
+  u64 value;
+};
+
+struct Add {
+  Interned<Expr> lhs;
+  Interned<Expr> rhs;
+};
+
+struct Mul {
+  Interned<Expr> lhs;
+  Interned<Expr> rhs;
+};
+
+struct Expr {
+  Union<Lit, Add, Mul> _data;
+};
+
+static auto build_boxed(const u64 depth, const u64 shape)
+    -> std::unique_ptr<BoxExpr> {
+  if (depth == 0) {
+    return std::make_unique<BoxExpr>(BoxExpr{BoxLit{shape + 1}});
+  }
+  auto lhs = build_boxed(depth - 1, left(shape));
+  auto rhs = build_boxed(depth - 1, right(shape));
+  if (shape % 2 == 0) {
+    return std::make_unique<BoxExpr>(
+        BoxExpr{BoxAdd{std::move(lhs), std::move(rhs)}});
+  }
+  return std::make_unique<BoxExpr>(
+      BoxExpr{BoxMul{std::move(lhs), std::move(rhs)}});
+}
+
+static auto build_interned(HashCons<Expr> &table, const u64 depth,
+                           const u64 shape) -> Interned<Expr> {
+  if (depth == 0) {
+    return table.make(Lit{shape + 1});
+  }
+  const auto lhs = build_interned(table, depth - 1, left(shape));
+  const auto rhs = build_interned(table, depth - 1, right(shape));
+  if (shape % 2 == 0) {
+    return table.make(Add{lhs, rhs});
+  }
+  return table.make(Mul{lhs, rhs});
+}
+
+static auto eval_boxed(const BoxExpr &root) -> u64 {
+  return match_recursively<u64>(root)(
+      [](auto, const BoxLit &lit) { return lit.value; },
+      [](auto recurse, const BoxAdd &add) {
+        return recurse(*add.lhs) + recurse(*add.rhs);
+      },
+      [](auto recurse, const BoxMul &mul) {
+        return recurse(*mul.lhs) * recurse(*mul.rhs);
+      });
+}
+
+static auto eval_shared(const Interned<Expr> &root) -> u64 {
+  return match_shared<u64>(root)(
+      [](auto, const Lit &lit) { return lit.value; },
+      [](auto recurse, const Add &add) {
+        return recurse(add.lhs) + recurse(add.rhs);
+      },
+      [](auto recurse, const Mul &mul) {
+        return recurse(mul.lhs) * recurse(mul.rhs);
+      });
+}
+
+// Bytes of node payload, leaving allocator and hash table overhead out.
+static auto boxed_bytes(const u64 depth) -> double {
+  const auto nodes = (u64{2} << depth) - 1;
+  return static_cast<double>(nodes * sizeof(BoxExpr));
+}
+
+static auto BM_BuildBoxed(benchmark::State &state) {
+  const auto depth = static_cast<u64>(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(build_boxed(depth, 0));
+  }
+  state.counters["bytes"] = boxed_bytes(depth);
+}
+
+static auto BM_BuildInterned(benchmark::State &state) {
+  const auto depth = static_cast<u64>(state.range(0));
+  usize nodes = 0;
+  for (auto _ : state) {
+    auto table = HashCons<Expr>();
+    benchmark::DoNotOptimize(build_interned(table, depth, 0));
+    nodes = table.size();
+  }
+  state.counters["bytes"] =
+      static_cast<double>(nodes * sizeof(HashCons<Expr>::Entry));
+}
+
+static auto BM_EvalBoxed(benchmark::State &state) {
+  const auto root = build_boxed(static_cast<u64>(state.range(0)), 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(eval_boxed(*root));
+  }
+}
+
+static auto BM_EvalShared(benchmark::State &state) {
+  auto table = HashCons<Expr>();
+  const auto root = build_interned(table, static_cast<u64>(state.range(0)), 0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(eval_shared(root));
+  }
+}
+
+BENCHMARK(BM_BuildBoxed)->DenseRange(12, 20, 4)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_BuildInterned)
+    ->DenseRange(12, 20, 4)
+    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_EvalBoxed)->DenseRange(12, 20, 4)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_EvalShared)->DenseRange(12, 20, 4)->Unit(benchmark::kMicrosecond);
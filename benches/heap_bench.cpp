@@ -0,0 +1,101 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <random>
+
+using namespace exl; // NOLINT
+
+struct Glibc {
+  static auto alloc(const usize size) -> void * {
+    return std::malloc(size); // NOLINT
+  }
+  static auto free(void *ptr, const usize /*size*/) -> void {
+    std::free(ptr); // NOLINT
+  }
+  static auto free(void *ptr) -> void {
+    std::free(ptr); // NOLINT
+  }
+};
+
+struct ExlHeap {
+  static auto alloc(const usize size) -> void * {
+    return mem::Heap::alloc(size);
+  }
+  static auto free(void *ptr, const usize size) -> void {
+    mem::Heap::free(ptr, size);
+  }
+  static auto free(void *ptr) -> void { mem::Heap::free(ptr); }
+};
+
+// Mostly small objects with a tail up to 4 KiB, like AST nodes, strings
+// and vectors of a long-lived service.
+static auto random_size(std::mt19937 &rng) -> usize {
+  const auto roll = rng() % 100;
+  if (roll < 80) {
+    return 16 + rng() % 112;
+  }
+  if (roll < 98) {
+    return 128 + rng() % 896;
+  }
+  return 1024 + rng() % 3072;
+}
+
+static constexpr usize WINDOW = 256;
+static constexpr usize OPS = 1024;
+
+// Each thread replaces random blocks of its own window of live blocks.
+template <typename A> static auto BM_LocalChurn(benchmark::State &state) {
+  auto rng = std::mt19937(state.thread_index()); // NOLINT
+  auto sizes = std::array<usize, WINDOW>{};
+  auto live = std::array<void *, WINDOW>{};
+  for (usize i = 0; i < WINDOW; ++i) {
+    sizes[i] = random_size(rng);
+    live[i] = A::alloc(sizes[i]);
+  }
+  for (auto _ : state) {
+    for (usize i = 0; i < OPS; ++i) {
+      const auto slot = rng() % WINDOW;
+      A::free(live[slot], sizes[slot]);
+      sizes[slot] = random_size(rng);
+      live[slot] = A::alloc(sizes[slot]);
+      *static_cast<u8 *>(live[slot]) = 1;
+    }
+  }
+  for (usize i = 0; i < WINDOW; ++i) {
+    A::free(live[i], sizes[i]);
+  }
+  state.SetItemsProcessed(state.iterations() * OPS);
+}
+
+static constexpr usize SHARED = 4096;
+
+// NOLINTNEXTLINE
+static std::array<std::atomic<void *>, SHARED> SHARED_SLOTS{};
+
+// Blocks are swapped through slots shared by all threads, so most frees
+// release a block another thread allocated.
+template <typename A> static auto BM_CrossThreadChurn(benchmark::State &state) {
+  auto rng = std::mt19937(state.thread_index()); // NOLINT
+  for (auto _ : state) {
+    for (usize i = 0; i < OPS; ++i) {
+      auto *block = A::alloc(random_size(rng));
+      *static_cast<u8 *>(block) = 1;
+      A::free(SHARED_SLOTS[rng() % SHARED].exchange(
+          block, std::memory_order_acq_rel));
+    }
+  }
+  if (state.thread_index() == 0) {
+    for (auto &slot : SHARED_SLOTS) {
+      A::free(slot.exchange(nullptr));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * OPS);
+}
+
+BENCHMARK(BM_LocalChurn<Glibc>)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_LocalChurn<ExlHeap>)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_CrossThreadChurn<Glibc>)->ThreadRange(1, 8)->UseRealTime();
+BENCHMARK(BM_CrossThreadChurn<ExlHeap>)->ThreadRange(1, 8)->UseRealTime();
@@ -0,0 +1,140 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using namespace exl; // NOLINT
+
+static constexpr usize LEN = 1 << 16;
+
+// Token kinds: a few dozen values, skewed towards the common ones.
+static auto token_kinds() -> std::vector<u32> {
+  auto rng = std::mt19937(42); // NOLINT
+  auto dist = std::geometric_distribution<u32>(0.15);
+  auto ret = std::vector<u32>(LEN);
+  for (auto &kind : ret) {
+    kind = std::min<u32>(dist(rng), 63);
+  }
+  return ret;
+}
+
+// Sorted node ids with small gaps, as in an adjacency or posting list.
+static auto node_ids() -> std::vector<u32> {
+  auto rng = std::mt19937(42); // NOLINT
+  auto gap = std::geometric_distribution<u32>(0.05);
+  auto ret = std::vector<u32>(LEN);
+  u32 id = 0;
+  for (auto &elem : ret) {
+    elem = id += gap(rng) + 1;
+  }
+  return ret;
+}
+
+// Source offsets: monotonic with token sized steps and the odd long comment.
+static auto source_offsets() -> std::vector<u32> {
+  auto rng = std::mt19937(42); // NOLINT
+  auto step = std::uniform_int_distribution<u32>(1, 16);
+  auto ret = std::vector<u32>(LEN);
+  u32 offset = 0;
+  for (usize i = 0; i < LEN; ++i) {
+    offset += step(rng) + (i % 512 == 0 ? 4096 : 0);
+    ret[i] = offset;
+  }
+  return ret;
+}
+
+static auto report(benchmark::State &state, const usize encoded) -> void {
+  state.SetBytesProcessed(state.iterations() * LEN * sizeof(u32));
+  state.counters["ratio"] = benchmark::Counter(
+      static_cast<double>(LEN * sizeof(u32)) / static_cast<double>(encoded));
+}
+
+static auto BM_PackedUnpack(benchmark::State &state) -> void {
+  auto kinds = token_kinds();
+  auto packed = PackedArray<6>::pack(
+      Slice<const u32>::from_unchecked(kinds.data(), kinds.size()));
+  auto out = std::vector<u32>(LEN);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        packed.unpack(Slice<u32>::from_unchecked(out.data(), out.size())));
+    benchmark::ClobberMemory();
+  }
+  report(state, packed.bytes());
+}
+
+static auto BM_PackedLoad(benchmark::State &state) -> void {
+  auto kinds = token_kinds();
+  auto packed = PackedArray<6>::pack(
+      Slice<const u32>::from_unchecked(kinds.data(), kinds.size()));
+  auto out = std::vector<u32>(LEN);
+
+  for (auto _ : state) {
+    for (usize i = 0; i < LEN; ++i) {
+      out[i] = packed.load(i);
+    }
+    benchmark::ClobberMemory();
+  }
+  report(state, packed.bytes());
+}
+
+static auto BM_PackedPack(benchmark::State &state) -> void {
+  auto kinds = token_kinds();
+  const auto in = Slice<const u32>::from_unchecked(kinds.data(), kinds.size());
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(PackedArray<6>::pack(in));
+  }
+  state.SetBytesProcessed(state.iterations() * LEN * sizeof(u32));
+}
+
+template <auto Make>
+static auto BM_DeltaDecode(benchmark::State &state) -> void {
+  auto values = Make();
+  auto seq = DeltaSeq::encode(
+      Slice<const u32>::from_unchecked(values.data(), values.size()));
+  auto out = std::vector<u32>(LEN);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        seq.decode(Slice<u32>::from_unchecked(out.data(), out.size())));
+    benchmark::ClobberMemory();
+  }
+  report(state, seq.bytes());
+}
+
+template <auto Make>
+static auto BM_DeltaRandomAccess(benchmark::State &state) -> void {
+  auto values = Make();
+  auto seq = DeltaSeq::encode(
+      Slice<const u32>::from_unchecked(values.data(), values.size()));
+  auto rng = std::mt19937(7); // NOLINT
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(seq.load(rng() % LEN));
+  }
+}
+
+static auto BM_DeltaIterate(benchmark::State &state) -> void {
+  auto values = node_ids();
+  auto seq = DeltaSeq::encode(
+      Slice<const u32>::from_unchecked(values.data(), values.size()));
+
+  for (auto _ : state) {
+    u64 sum = 0;
+    for (const auto id : seq) {
+      sum += id;
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  report(state, seq.bytes());
+}
+
+BENCHMARK(BM_PackedUnpack);
+BENCHMARK(BM_PackedLoad);
+BENCHMARK(BM_PackedPack);
+BENCHMARK(BM_DeltaDecode<node_ids>);
+BENCHMARK(BM_DeltaDecode<source_offsets>);
+BENCHMARK(BM_DeltaRandomAccess<node_ids>);
+BENCHMARK(BM_DeltaIterate);
@@ -0,0 +1,209 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace exl; // NOLINT
+
+static constexpr usize COUNT = 1 << 14;
+
+// Space separated literals, as they would appear in expression source.
+static auto int_corpus() -> std::string {
+  auto rng = std::mt19937_64(42); // NOLINT
+  auto ret = std::string();
+  for (usize i = 0; i < COUNT; ++i) {
+    ret += std::to_string(static_cast<s64>(rng() >> (rng() % 64)));
+    ret += ' ';
+  }
+  return ret;
+}
+
+static auto float_corpus() -> std::string {
+  auto rng = std::mt19937_64(42); // NOLINT
+  auto dist = std::uniform_real_distribution<d64>(-1e6, 1e6);
+  auto ret = std::string();
+  char buf[32]; // NOLINT
+  for (usize i = 0; i < COUNT; ++i) {
+    // Alternate short decimals with full precision values.
+    const auto len = i % 2 == 0 ? std::snprintf(buf, 32, "%.3f", dist(rng))
+                                : std::snprintf(buf, 32, "%.17g", dist(rng));
+    ret.append(buf, len);
+    ret += ' ';
+  }
+  return ret;
+}
+
+template <typename T, typename Parse>
+static auto parse_all(const std::string &input, Parse &&parse_one) -> T {
+  T sum{};
+  const auto *first = input.data();
+  const auto *last = first + input.size();
+  while (first < last) {
+    first = parse_one(first, last, sum);
+    ++first;
+  }
+  return sum;
+}
+
+static auto BM_ParseIntExl(benchmark::State &state) -> void {
+  const auto input = int_corpus();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse_all<s64>(
+        input, [](const char *first, const char *last, s64 &sum) {
+          const auto [val, len] =
+              parse<s64>(Slice<const u8>::from_unchecked(
+                             ptr::cast<u8>(first), last - first))
+                  .unwrap();
+          sum += val;
+          return first + len;
+        }));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static auto BM_ParseIntFromChars(benchmark::State &state) -> void {
+  const auto input = int_corpus();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse_all<s64>(
+        input, [](const char *first, const char *last, s64 &sum) {
+          s64 val{};
+          const auto res = std::from_chars(first, last, val);
+          sum += val;
+          return res.ptr;
+        }));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static auto BM_ParseIntStrtoll(benchmark::State &state) -> void {
+  const auto input = int_corpus();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse_all<s64>(
+        input, [](const char *first, const char * /*last*/, s64 &sum) {
+          char *end{};
+          sum += std::strtoll(first, &end, 10);
+          return static_cast<const char *>(end);
+        }));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+// The std::string temporary is part of what stoll costs at call sites.
+static auto BM_ParseIntStoll(benchmark::State &state) -> void {
+  const auto input = int_corpus();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse_all<s64>(
+        input, [](const char *first, const char *last, s64 &sum) {
+          const auto *end = std::find(first, last, ' ');
+          sum += std::stoll(std::string(first, end));
+          return end;
+        }));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static auto BM_ParseFloatExl(benchmark::State &state) -> void {
+  const auto input = float_corpus();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse_all<d64>(
+        input, [](const char *first, const char *last, d64 &sum) {
+          const auto [val, len] =
+              parse<d64>(Slice<const u8>::from_unchecked(
+                             ptr::cast<u8>(first), last - first))
+                  .unwrap();
+          sum += val;
+          return first + len;
+        }));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static auto BM_ParseFloatFromChars(benchmark::State &state) -> void {
+  const auto input = float_corpus();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse_all<d64>(
+        input, [](const char *first, const char *last, d64 &sum) {
+          d64 val{};
+          const auto res = std::from_chars(first, last, val);
+          sum += val;
+          return res.ptr;
+        }));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static auto BM_ParseFloatStrtod(benchmark::State &state) -> void {
+  const auto input = float_corpus();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(parse_all<d64>(
+        input, [](const char *first, const char * /*last*/, d64 &sum) {
+          char *end{};
+          sum += std::strtod(first, &end);
+          return static_cast<const char *>(end);
+        }));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static auto float_values() -> std::vector<d64> {
+  const auto input = float_corpus();
+  auto ret = std::vector<d64>();
+  const auto *first = input.data();
+  const auto *last = first + input.size();
+  while (first < last) {
+    d64 val{};
+    first = std::from_chars(first, last, val).ptr + 1;
+    ret.push_back(val);
+  }
+  return ret;
+}
+
+static auto BM_WriteFloatExl(benchmark::State &state) -> void {
+  const auto values = float_values();
+  u8 buf[32]; // NOLINT
+  const auto out = Slice<u8>::from_unchecked(buf, 32);
+  for (auto _ : state) {
+    for (const auto val : values) {
+      benchmark::DoNotOptimize(write_num(out, val));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+static auto BM_WriteFloatFmt(benchmark::State &state) -> void {
+  const auto values = float_values();
+  char buf[32]; // NOLINT
+  for (auto _ : state) {
+    for (const auto val : values) {
+      benchmark::DoNotOptimize(fmt::format_to_n(buf, 32, "{}", val));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+static auto BM_WriteFloatSnprintf(benchmark::State &state) -> void {
+  const auto values = float_values();
+  char buf[32]; // NOLINT
+  for (auto _ : state) {
+    for (const auto val : values) {
+      benchmark::DoNotOptimize(std::snprintf(buf, 32, "%.17g", val));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+BENCHMARK(BM_ParseIntExl);
+BENCHMARK(BM_ParseIntFromChars);
+BENCHMARK(BM_ParseIntStrtoll);
+BENCHMARK(BM_ParseIntStoll);
+BENCHMARK(BM_ParseFloatExl);
+BENCHMARK(BM_ParseFloatFromChars);
+BENCHMARK(BM_ParseFloatStrtod);
+BENCHMARK(BM_WriteFloatExl);
+BENCHMARK(BM_WriteFloatFmt);
+BENCHMARK(BM_WriteFloatSnprintf);
@@ -0,0 +1,109 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+using namespace exl; // NOLINT
+
+using StdMap = std::unordered_map<u64, u64>;
+using Hamt = PersistentMap<u64, u64>;
+
+static constexpr usize BINDINGS = 4;
+
+static auto keys(const usize len) -> std::vector<u64> {
+  auto rng = std::mt19937_64(len);
+  auto out = std::vector<u64>(len);
+  for (auto &key : out) {
+    key = rng();
+  }
+  return out;
+}
+
+static auto build(const std::vector<u64> &keys) -> Hamt {
+  auto transient = Hamt().transient();
+  for (const auto key : keys) {
+    transient.set(key, key);
+  }
+  return std::move(transient).persistent();
+}
+
+// Entering a scope: snapshot the environment and bind a few names.
+static auto BM_ScopeStd(benchmark::State &state) {
+  const auto all = keys(static_cast<usize>(state.range(0)));
+  auto env = StdMap();
+  for (const auto key : all) {
+    env.emplace(key, key);
+  }
+  u64 name = 0;
+  for (auto _ : state) {
+    auto scope = env;
+    for (usize i = 0; i < BINDINGS; ++i) {
+      ++name;
+      scope[name] = name;
+    }
+    benchmark::DoNotOptimize(scope);
+  }
+}
+
+static auto BM_ScopeHamt(benchmark::State &state) {
+  const auto env = build(keys(static_cast<usize>(state.range(0))));
+  u64 name = 0;
+  for (auto _ : state) {
+    auto scope = env;
+    for (usize i = 0; i < BINDINGS; ++i) {
+      ++name;
+      scope = scope.set(name, name);
+    }
+    benchmark::DoNotOptimize(scope);
+  }
+}
+
+static auto BM_LookupStd(benchmark::State &state) {
+  const auto all = keys(static_cast<usize>(state.range(0)));
+  auto map = StdMap();
+  for (const auto key : all) {
+    map.emplace(key, key);
+  }
+  usize at = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.find(all[at++ % all.size()]));
+  }
+}
+
+static auto BM_LookupHamt(benchmark::State &state) {
+  const auto all = keys(static_cast<usize>(state.range(0)));
+  const auto map = build(all);
+  usize at = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(map.get(all[at++ % all.size()]));
+  }
+}
+
+static auto BM_BuildPersistent(benchmark::State &state) {
+  const auto all = keys(static_cast<usize>(state.range(0)));
+  for (auto _ : state) {
+    auto map = Hamt();
+    for (const auto key : all) {
+      map = map.set(key, key);
+    }
+    benchmark::DoNotOptimize(map);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static auto BM_BuildTransient(benchmark::State &state) {
+  const auto all = keys(static_cast<usize>(state.range(0)));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(build(all));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(BM_ScopeStd)->RangeMultiplier(10)->Range(10, 100000);
+BENCHMARK(BM_ScopeHamt)->RangeMultiplier(10)->Range(10, 100000);
+BENCHMARK(BM_LookupStd)->RangeMultiplier(10)->Range(10, 1000000);
+BENCHMARK(BM_LookupHamt)->RangeMultiplier(10)->Range(10, 1000000);
+BENCHMARK(BM_BuildPersistent)->Arg(100000);
+BENCHMARK(BM_BuildTransient)->Arg(100000);
@@ -0,0 +1,125 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+using namespace exl; // NOLINT
+
+static constexpr usize FAN_IN = 4;
+static constexpr usize WORK = 64;
+
+struct Def {
+  u32 id;
+};
+
+struct Unresolved {
+  u32 id;
+
+  auto operator==(const Unresolved &) const -> bool = default;
+};
+
+// Definition i refers to up to FAN_IN earlier definitions, mostly nearby
+// ones, like a program where code uses what was declared above it.
+static auto graph(const usize len) -> std::vector<std::vector<u32>> {
+  auto rng = std::mt19937_64(len);
+  auto refs = std::vector<std::vector<u32>>(len);
+  for (usize i = 1; i < len; ++i) {
+    for (usize j = 0; j < FAN_IN; ++j) {
+      const auto back = rng() % std::min<usize>(i, 64);
+      refs[i].push_back(static_cast<u32>(i - 1 - back));
+    }
+  }
+  return refs;
+}
+
+// Stands in for checking one definition: some hashing over its source.
+static auto check_def(u64 source, const u64 seed) -> u64 {
+  for (usize i = 0; i < WORK; ++i) {
+    source = (source ^ seed) * 0x9e3779b97f4a7c15ULL + i;
+  }
+  return source;
+}
+
+// Sources keep a signature in the high half, which is what other
+// definitions see, and a body in the low half. Edits touch bodies.
+static auto signature(const u64 source) -> u64 { return source >> 32; }
+
+static auto edit(const u64 source, const u64 body) -> u64 {
+  return (source & ~u64{0xffffffff}) | (body & 0xffffffff);
+}
+
+// Rechecks every definition after each edit.
+static auto BM_Full(benchmark::State &state) {
+  const auto refs = graph(static_cast<usize>(state.range(0)));
+  auto sources = std::vector<u64>(refs.size(), u64{1} << 32);
+  auto rng = std::mt19937_64(1);
+  for (auto _ : state) {
+    const auto at = rng() % sources.size();
+    sources[at] = edit(sources[at], rng());
+    u64 total = 0;
+    for (usize i = 0; i < refs.size(); ++i) {
+      u64 seed = 0;
+      for (const auto ref : refs[i]) {
+        seed ^= check_def(signature(sources[ref]), 0);
+      }
+      total += check_def(sources[i], seed);
+    }
+    benchmark::DoNotOptimize(total);
+  }
+}
+
+// Edits one body, then asks for the checked total or, like an editor
+// refreshing diagnostics, for the edited definition alone. The edited
+// signature query reruns but comes out equal, so only that definition's
+// check reruns.
+static auto BM_Incremental(benchmark::State &state) {
+  const auto refs = graph(static_cast<usize>(state.range(0)));
+  const auto whole = state.range(1) != 0;
+  auto db = query::Database();
+  auto source = query::Input<Def, u64>(db);
+  auto sig = query::derived<Def, u64, Unresolved>(
+      db, [&](auto &, const Def &def) -> Result<u64, Unresolved> {
+        return {check_def(signature(source.get(def).unwrap()), 0)};
+      });
+  auto checked = query::derived<Def, u64, Unresolved>(
+      db, [&](auto &, const Def &def) -> Result<u64, Unresolved> {
+        u64 seed = 0;
+        for (const auto ref : refs[def.id]) {
+          seed ^= sig.get({ref}).unwrap();
+        }
+        return {check_def(source.get(def).unwrap(), seed)};
+      });
+  auto total = query::derived<u32, u64, Unresolved>(
+      db, [&](auto &, const u32 &len) -> Result<u64, Unresolved> {
+        u64 sum = 0;
+        for (u32 id = 0; id < len; ++id) {
+          sum += checked.get({id}).unwrap();
+        }
+        return {sum};
+      });
+  const auto len = static_cast<u32>(refs.size());
+  for (u32 id = 0; id < len; ++id) {
+    source.set({id}, u64{1} << 32);
+  }
+  benchmark::DoNotOptimize(total.get(len));
+  const auto warm = checked.executions;
+  auto rng = std::mt19937_64(1);
+  for (auto _ : state) {
+    const auto def = Def{static_cast<u32>(rng() % len)};
+    source.set(def, edit(source.get(def).unwrap(), rng()));
+    if (whole) {
+      benchmark::DoNotOptimize(total.get(len));
+    } else {
+      benchmark::DoNotOptimize(checked.get(def));
+    }
+  }
+  state.counters["rechecked"] = benchmark::Counter(
+      static_cast<double>(checked.executions - warm),
+      benchmark::Counter::kAvgIterations);
+}
+
+BENCHMARK(BM_Full)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK(BM_Incremental)
+    ->ArgsProduct({{1000, 10000, 100000}, {1, 0}})
+    ->ArgNames({"defs", "total"});
@@ -0,0 +1,150 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <thread>
+#include <vector>
+
+using namespace exl; // NOLINT
+
+static constexpr u64 ITEMS = 1 << 18;
+static constexpr usize BATCH = 32;
+
+static auto BM_SpscThroughput(benchmark::State &state) -> void {
+  for (auto _ : state) {
+    auto queue = SpscQueue<u64, 1024>{};
+    auto producer = std::thread([&queue]() {
+      for (u64 i = 0; i < ITEMS; ++i) {
+        while (queue.try_push(i).is_some()) {
+          std::this_thread::yield();
+        }
+      }
+    });
+
+    for (u64 n = 0; n < ITEMS;) {
+      if (queue.try_pop().is_some()) {
+        ++n;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    producer.join();
+  }
+  state.SetItemsProcessed(state.iterations() * ITEMS);
+}
+
+static auto BM_SpscBatchThroughput(benchmark::State &state) -> void {
+  for (auto _ : state) {
+    auto queue = SpscQueue<u64, 1024>{};
+    auto producer = std::thread([&queue]() {
+      u64 buf[BATCH]{}; // NOLINT
+      for (u64 i = 0; i < ITEMS; i += BATCH) {
+        for (usize j = 0; j < BATCH; ++j) {
+          buf[j] = i + j;
+        }
+        for (usize sent = 0; sent < BATCH;) {
+          sent += queue.push_batch(
+              Slice<u64>::from_unchecked(buf + sent, BATCH - sent));
+          if (sent < BATCH) {
+            std::this_thread::yield();
+          }
+        }
+      }
+    });
+
+    u64 buf[BATCH]{}; // NOLINT
+    for (u64 n = 0; n < ITEMS;) {
+      auto len = queue.pop_batch(Slice<u64>::from_unchecked(buf, BATCH));
+      n += len;
+      if (len == 0) {
+        std::this_thread::yield();
+      }
+    }
+    producer.join();
+  }
+  state.SetItemsProcessed(state.iterations() * ITEMS);
+}
+
+static auto BM_MpmcThroughput(benchmark::State &state) -> void {
+  const auto producers = static_cast<u64>(state.range(0));
+  const auto consumers = static_cast<u64>(state.range(1));
+  const auto per_producer = ITEMS / producers;
+
+  for (auto _ : state) {
+    auto queue = MpmcQueue<u64>(1024); // NOLINT
+    auto popped = std::atomic<u64>{0};
+    auto workers = std::vector<std::thread>{};
+
+    for (u64 p = 0; p < producers; ++p) {
+      workers.emplace_back([&]() {
+        for (u64 i = 0; i < per_producer; ++i) {
+          while (queue.try_push(i).is_some()) {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+    for (u64 c = 0; c < consumers; ++c) {
+      workers.emplace_back([&]() {
+        while (popped.load(std::memory_order_relaxed) <
+               per_producer * producers) {
+          if (queue.try_pop().is_some()) {
+            popped.fetch_add(1, std::memory_order_relaxed);
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * per_producer * producers);
+}
+
+static auto BM_MpmcSingleThreadBatch(benchmark::State &state) -> void {
+  auto queue = MpmcQueue<u64>(1024); // NOLINT
+  u64 buf[BATCH]{};                  // NOLINT
+  const auto slice = Slice<u64>::from_unchecked(buf, BATCH);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(queue.push_batch(slice));
+    benchmark::DoNotOptimize(queue.pop_batch(slice));
+  }
+  state.SetItemsProcessed(state.iterations() * BATCH);
+}
+
+static auto BM_SpscPingPongLatency(benchmark::State &state) -> void {
+  auto ping = SpscQueue<u64, 16>{};
+  auto pong = SpscQueue<u64, 16>{};
+  auto done = std::atomic<bool>{false};
+
+  auto echo = std::thread([&]() {
+    while (!done.load(std::memory_order_relaxed)) {
+      if (auto val = ping.try_pop(); val.is_some()) {
+        while (pong.try_push(val.unwrap()).is_some()) {
+        }
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  for (auto _ : state) {
+    while (ping.try_push(1).is_some()) {
+    }
+    while (pong.try_pop().is_none()) {
+      std::this_thread::yield();
+    }
+  }
+  done = true;
+  echo.join();
+}
+
+BENCHMARK(BM_SpscThroughput)->UseRealTime();
+BENCHMARK(BM_SpscBatchThroughput)->UseRealTime();
+BENCHMARK(BM_MpmcThroughput)
+    ->ArgsProduct({{1, 2, 4, 8}, {1, 2, 4, 8}})
+    ->UseRealTime();
+BENCHMARK(BM_MpmcSingleThreadBatch);
+BENCHMARK(BM_SpscPingPongLatency)->UseRealTime();
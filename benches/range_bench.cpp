@@ -0,0 +1,86 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <numeric>
+#include <vector>
+
+using namespace exl; // NOLINT
+
+static auto BM_SumRawLoop(benchmark::State &state) -> void {
+  auto data = std::vector<s32>(state.range(0));
+  std::iota(data.begin(), data.end(), 0);
+  const auto len = static_cast<ssize>(data.size());
+
+  for (auto _ : state) {
+    s32 res = 0;
+    for (ssize i = 0; i < len; ++i) {
+      res += data[i];
+    }
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * len);
+}
+
+// Built with -O3 -fopt-info-vec-optimized, GCC reports the Range loop here
+// as vectorized, like the raw loop above.
+static auto BM_SumRange(benchmark::State &state) -> void {
+  auto data = std::vector<s32>(state.range(0));
+  std::iota(data.begin(), data.end(), 0);
+  const auto len = static_cast<ssize>(data.size());
+
+  for (auto _ : state) {
+    s32 res = 0;
+    for (auto i : Range(0, len - 1)) {
+      res += data[i];
+    }
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * len);
+}
+
+static auto BM_SumRangeStrided(benchmark::State &state) -> void {
+  auto data = std::vector<s32>(state.range(0));
+  std::iota(data.begin(), data.end(), 0);
+  const auto len = static_cast<ssize>(data.size());
+
+  for (auto _ : state) {
+    s32 res = 0;
+    for (auto i : Range(0, len - 1, 2)) {
+      res += data[i];
+    }
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * len / 2);
+}
+
+static auto BM_SumRangeValues(benchmark::State &state) -> void {
+  const auto len = state.range(0);
+
+  for (auto _ : state) {
+    ssize res = 0;
+    for (auto i : Range(0, len - 1)) {
+      res += i * i;
+    }
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * len);
+}
+
+static auto BM_SumStaticFor(benchmark::State &state) -> void {
+  s32 data[16]{}; // NOLINT
+  std::iota(data, data + 16, 0);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(data);
+    s32 res = 0;
+    static_for<0, 15>([&](auto i) { res += data[i]; });
+    benchmark::DoNotOptimize(res);
+  }
+  state.SetItemsProcessed(state.iterations() * 16);
+}
+
+BENCHMARK(BM_SumRawLoop)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SumRange)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SumRangeStrided)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SumRangeValues)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SumStaticFor);
@@ -0,0 +1,69 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+
+using namespace exl; // NOLINT
+
+// A source file of `len` bytes with 60-column lines.
+static auto source(const usize len) -> std::string {
+  auto out = std::string(len, 'x');
+  for (usize i = 59; i < len; i += 60) {
+    out[i] = '\n';
+  }
+  return out;
+}
+
+// Typing: one byte inserted and one erased at random places per iteration,
+// so the size stays put.
+static auto BM_EditString(benchmark::State &state) {
+  auto text = source(static_cast<usize>(state.range(0)));
+  auto rng = std::mt19937_64(1);
+  for (auto _ : state) {
+    text.insert(rng() % text.size(), 1, 'y');
+    text.erase(rng() % text.size(), 1);
+    benchmark::DoNotOptimize(text.data());
+  }
+}
+
+static auto BM_EditRope(benchmark::State &state) {
+  auto rope = Rope(source(static_cast<usize>(state.range(0))));
+  auto rng = std::mt19937_64(1);
+  for (auto _ : state) {
+    rope.insert(rng() % rope.size(), "y");
+    const auto at = rng() % rope.size();
+    benchmark::DoNotOptimize(rope.erase(at, at + 1));
+  }
+}
+
+// An editor keeps the previous version around for undo.
+static auto BM_SnapshotString(benchmark::State &state) {
+  const auto text = source(static_cast<usize>(state.range(0)));
+  for (auto _ : state) {
+    auto copy = text;
+    benchmark::DoNotOptimize(copy.data());
+  }
+}
+
+static auto BM_SnapshotRope(benchmark::State &state) {
+  const auto rope = Rope(source(static_cast<usize>(state.range(0))));
+  for (auto _ : state) {
+    auto copy = rope;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+
+static auto BM_LineStartRope(benchmark::State &state) {
+  const auto rope = Rope(source(static_cast<usize>(state.range(0))));
+  auto rng = std::mt19937_64(1);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(rope.line_start(rng() % rope.lines()));
+  }
+}
+
+BENCHMARK(BM_EditString)->RangeMultiplier(4)->Range(1 << 16, 1 << 24);
+BENCHMARK(BM_EditRope)->RangeMultiplier(4)->Range(1 << 16, 1 << 24);
+BENCHMARK(BM_SnapshotString)->RangeMultiplier(4)->Range(1 << 16, 1 << 24);
+BENCHMARK(BM_SnapshotRope)->RangeMultiplier(4)->Range(1 << 16, 1 << 24);
+BENCHMARK(BM_LineStartRope)->RangeMultiplier(4)->Range(1 << 16, 1 << 24);
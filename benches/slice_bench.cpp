@@ -0,0 +1,100 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace exl; // NOLINT
+
+static auto random_keys(const usize len) -> std::vector<u32> {
+  auto rng = std::mt19937(42); // NOLINT
+  auto keys = std::vector<u32>(len);
+  std::ranges::generate(keys, rng);
+  return keys;
+}
+
+static auto BM_CopyElementLoop(benchmark::State &state) -> void {
+  auto src = random_keys(state.range(0));
+  auto dst = std::vector<u32>(src.size());
+  auto in = Slice<u32>::from_unchecked(src.data(), src.size());
+
+  for (auto _ : state) {
+    auto out = dst.data();
+    for (auto &elem : in) {
+      *out++ = elem;
+    }
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * src.size() * sizeof(u32));
+}
+
+static auto BM_CopySlice(benchmark::State &state) -> void {
+  auto src = random_keys(state.range(0));
+  auto dst = std::vector<u32>(src.size());
+  auto in = Slice<u32>::from_unchecked(src.data(), src.size());
+  auto out = Slice<u32>::from_unchecked(dst.data(), dst.size());
+
+  for (auto _ : state) {
+    std::ranges::copy(in, out.begin());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * src.size() * sizeof(u32));
+}
+
+static auto BM_CopyPointer(benchmark::State &state) -> void {
+  auto src = random_keys(state.range(0));
+  auto dst = std::vector<u32>(src.size());
+
+  for (auto _ : state) {
+    std::copy(src.data(), src.data() + src.size(), dst.data());
+    benchmark::ClobberMemory();
+  }
+  state.SetBytesProcessed(state.iterations() * src.size() * sizeof(u32));
+}
+
+static auto BM_SortSlice(benchmark::State &state) -> void {
+  const auto keys = random_keys(state.range(0));
+  auto buf = keys;
+  auto slice = Slice<u32>::from_unchecked(buf.data(), buf.size());
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::ranges::copy(keys, slice.begin());
+    state.ResumeTiming();
+    std::ranges::sort(slice);
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+static auto BM_SortPointer(benchmark::State &state) -> void {
+  const auto keys = random_keys(state.range(0));
+  auto buf = keys;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::ranges::copy(keys, buf.begin());
+    state.ResumeTiming();
+    std::sort(buf.data(), buf.data() + buf.size());
+  }
+  state.SetItemsProcessed(state.iterations() * keys.size());
+}
+
+static auto BM_LowerBoundSlice(benchmark::State &state) -> void {
+  auto keys = random_keys(state.range(0));
+  std::ranges::sort(keys);
+  auto slice = Slice<u32>::from_unchecked(keys.data(), keys.size());
+  u32 needle = 0;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::ranges::lower_bound(slice, needle));
+    needle += 0x9E3779B9; // NOLINT
+  }
+}
+
+BENCHMARK(BM_CopyElementLoop)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_CopySlice)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_CopyPointer)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SortSlice)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_SortPointer)->Range(1 << 10, 1 << 20);
+BENCHMARK(BM_LowerBoundSlice)->Range(1 << 10, 1 << 20);
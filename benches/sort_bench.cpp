@@ -0,0 +1,92 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#ifdef EXPRLIB_HAVE_TBB
+#include <execution>
+#endif
+
+using namespace exl; // NOLINT
+
+// Up to 64M keys; the scratch copies of larger inputs do not fit the
+// memory of a typical CI box.
+static constexpr s64 MIN_LEN = s64{1} << 10;
+static constexpr s64 MAX_LEN = s64{1} << 26;
+
+template <typename T> static auto input(const usize len) -> std::vector<T> {
+  auto rng = std::mt19937_64(len);
+  auto keys = std::vector<T>(len);
+  for (auto &key : keys) {
+    key = static_cast<T>(rng());
+  }
+  return keys;
+}
+
+// Sorts a fresh copy of the same random keys each iteration; the copy is
+// not timed.
+template <typename T, typename TF>
+static auto run(benchmark::State &state, TF &&sort_fn) -> void {
+  const auto len = static_cast<usize>(state.range(0));
+  const auto keys = input<T>(len);
+  auto work = keys;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::copy(keys.begin(), keys.end(), work.begin());
+    state.ResumeTiming();
+    sort_fn(Slice(work.data(), work.size()));
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename T> static auto BM_StdSort(benchmark::State &state) {
+  run<T>(state, [](auto slice) { std::sort(slice.begin(), slice.end()); });
+}
+
+#ifdef EXPRLIB_HAVE_TBB
+template <typename T> static auto BM_StdSortPar(benchmark::State &state) {
+  run<T>(state, [](auto slice) {
+    std::sort(std::execution::par, slice.data(),
+              slice.data() + slice.size());
+  });
+}
+#endif
+
+template <typename T> static auto BM_Pdq(benchmark::State &state) {
+  run<T>(state, [](auto slice) { sort::pdq(slice); });
+}
+
+template <typename T> static auto BM_Radix(benchmark::State &state) {
+  run<T>(state, [](auto slice) { sort::radix(slice); });
+}
+
+template <typename T> static auto BM_RadixInPlace(benchmark::State &state) {
+  run<T>(state, [](auto slice) { sort::radix_in_place(slice); });
+}
+
+template <typename T> static auto BM_Parallel(benchmark::State &state) {
+  run<T>(state,
+         [](auto slice) { sort::parallel(ThreadPool::global(), slice); });
+}
+
+#define SORT_BENCH(fn)                                                         \
+  BENCHMARK_TEMPLATE(fn, u32)                                                  \
+      ->RangeMultiplier(8)                                                     \
+      ->Range(MIN_LEN, MAX_LEN)                                                \
+      ->Unit(benchmark::kMicrosecond);                                         \
+  BENCHMARK_TEMPLATE(fn, u64)                                                  \
+      ->RangeMultiplier(8)                                                     \
+      ->Range(MIN_LEN, MAX_LEN)                                                \
+      ->Unit(benchmark::kMicrosecond)
+
+SORT_BENCH(BM_StdSort);
+#ifdef EXPRLIB_HAVE_TBB
+SORT_BENCH(BM_StdSortPar);
+#endif
+SORT_BENCH(BM_Pdq);
+SORT_BENCH(BM_Radix);
+SORT_BENCH(BM_RadixInPlace);
+SORT_BENCH(BM_Parallel);
@@ -0,0 +1,97 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <fmt/format.h>
+#include <string>
+
+#include "../tests/count_alloc.hpp"
+
+using namespace exl; // NOLINT
+
+static auto report_allocations(benchmark::State &state, const usize before)
+    -> void {
+  state.counters["allocs/iter"] = benchmark::Counter(
+      static_cast<double>(ALLOCATIONS.load() - before) /
+      static_cast<double>(state.iterations()));
+}
+
+static auto BM_CenterString(benchmark::State &state) -> void {
+  auto title = std::string("Results");
+  const auto before = ALLOCATIONS.load();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(center(title, 40, '=')); // NOLINT
+  }
+  report_allocations(state, before);
+}
+
+static auto BM_CenterStrBuf(benchmark::State &state) -> void {
+  auto buf = InlineStrBuf<64>();
+  const auto before = ALLOCATIONS.load();
+  for (auto _ : state) {
+    buf.clear();
+    buf.center("Results", 40, '='); // NOLINT
+    benchmark::DoNotOptimize(buf.ptr);
+  }
+  report_allocations(state, before);
+}
+
+static auto BM_MessageFormatString(benchmark::State &state) -> void {
+  const auto before = ALLOCATIONS.load();
+  usize offset = 0;
+  for (auto _ : state) {
+    auto msg = fmt::format("Tried to index slice of size {}, at offset {}",
+                           16, ++offset); // NOLINT
+    msg += " in ";
+    msg += "main.expr";
+    benchmark::DoNotOptimize(msg);
+  }
+  report_allocations(state, before);
+}
+
+static auto BM_MessageStrBuf(benchmark::State &state) -> void {
+  auto buf = InlineStrBuf<128>();
+  const auto before = ALLOCATIONS.load();
+  usize offset = 0;
+  for (auto _ : state) {
+    buf.clear();
+    buf.format("Tried to index slice of size {}, at offset {}", 16,
+               ++offset) // NOLINT
+        .append(" in ")
+        .append("main.expr");
+    benchmark::DoNotOptimize(buf.ptr);
+  }
+  report_allocations(state, before);
+}
+
+static auto BM_JoinString(benchmark::State &state) -> void {
+  const auto before = ALLOCATIONS.load();
+  for (auto _ : state) {
+    auto msg = std::string();
+    for (auto i : Range(0, 15)) { // NOLINT
+      if (!msg.empty()) {
+        msg += ", ";
+      }
+      msg += std::to_string(i);
+    }
+    benchmark::DoNotOptimize(msg);
+  }
+  report_allocations(state, before);
+}
+
+static auto BM_JoinStrBuf(benchmark::State &state) -> void {
+  auto buf = InlineStrBuf<128>();
+  const auto before = ALLOCATIONS.load();
+  for (auto _ : state) {
+    buf.clear();
+    buf.join(Range(0, 15), ", "); // NOLINT
+    benchmark::DoNotOptimize(buf.ptr);
+  }
+  report_allocations(state, before);
+}
+
+BENCHMARK(BM_CenterString);
+BENCHMARK(BM_CenterStrBuf);
+BENCHMARK(BM_MessageFormatString);
+BENCHMARK(BM_MessageStrBuf);
+BENCHMARK(BM_JoinString);
+BENCHMARK(BM_JoinStrBuf);
@@ -0,0 +1,92 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+using namespace exl; // NOLINT
+
+static constexpr usize CORPUS = 1 << 20;
+
+// Source code: identifiers, operators, indentation, the odd comment.
+static auto ascii_corpus() -> std::string {
+  auto ret = std::string();
+  while (ret.size() < CORPUS) {
+    ret += "    let total_count = compute_value(first_arg, 42) + offset;\n"
+           "    // keeps the running sum of every visited node\n"
+           "    if (total_count > limit) { return Err(\"overflow\"); }\n";
+  }
+  return ret;
+}
+
+// Prose mixing Latin, Greek, Cyrillic, CJK and emoji.
+static auto multilingual_corpus() -> std::string {
+  auto ret = std::string();
+  while (ret.size() < CORPUS) {
+    ret += "Grüße aus Köln. Καλημέρα κόσμε. Привет, мир! "
+           "こんにちは世界。你好，世界。안녕하세요 🌍🚀 ";
+  }
+  return ret;
+}
+
+static auto use_isa(benchmark::State &state) -> void {
+  text::set_isa(static_cast<text::Isa>(state.range(0)));
+  state.SetLabel(state.range(0) == 0 ? "scalar" : "avx2");
+}
+
+template <auto Corpus>
+static auto BM_Validate(benchmark::State &state) -> void {
+  use_isa(state);
+  const auto input = Corpus();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(text::validate(text::as_bytes(input)));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+template <auto Corpus> static auto BM_Decode(benchmark::State &state) -> void {
+  use_isa(state);
+  const auto input = Corpus();
+  auto out = std::vector<u32>(input.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        text::decode(text::as_bytes(input),
+                     Slice<u32>::from_unchecked(out.data(), out.size())));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+// The lexer loop: skip blanks, then take an identifier or a single byte.
+static auto BM_LexTokens(benchmark::State &state) -> void {
+  use_isa(state);
+  const auto input = ascii_corpus();
+  const auto bytes = text::as_bytes(input);
+  for (auto _ : state) {
+    usize tokens = 0;
+    for (usize at = text::skip_while(bytes, text::SPACE); at < bytes.cap;
+         at = text::skip_while(bytes, text::SPACE, at)) {
+      const auto end = text::skip_while(bytes, text::IDENT, at);
+      at = end == at ? at + 1 : end;
+      ++tokens;
+    }
+    benchmark::DoNotOptimize(tokens);
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+static auto BM_FindNonAscii(benchmark::State &state) -> void {
+  use_isa(state);
+  const auto input = ascii_corpus();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        text::find_first_of(text::as_bytes(input), text::NON_ASCII));
+  }
+  state.SetBytesProcessed(state.iterations() * input.size());
+}
+
+BENCHMARK(BM_Validate<ascii_corpus>)->Arg(0)->Arg(1);
+BENCHMARK(BM_Validate<multilingual_corpus>)->Arg(0)->Arg(1);
+BENCHMARK(BM_Decode<ascii_corpus>)->Arg(0)->Arg(1);
+BENCHMARK(BM_Decode<multilingual_corpus>)->Arg(0)->Arg(1);
+BENCHMARK(BM_LexTokens)->Arg(0)->Arg(1);
+BENCHMARK(BM_FindNonAscii)->Arg(0)->Arg(1);
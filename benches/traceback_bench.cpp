@@ -0,0 +1,73 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+using namespace exl; // NOLINT
+
+struct DepthError {
+  [[nodiscard]] auto description() const -> std::string_view {
+    return "Depth Error";
+  }
+};
+
+[[gnu::noinline]] static auto leaf(const bool fail) -> Result<u64, DepthError> {
+  if (fail) {
+    return {DepthError{}};
+  }
+  return {1};
+}
+
+[[gnu::noinline]] static auto traced(const u64 depth, const bool fail)
+    -> Result<u64, DepthError> {
+  if (depth == 0) {
+    return leaf(fail);
+  }
+  return {EXL_TRY(traced(depth - 1, fail)) + 1};
+}
+
+[[gnu::noinline]] static auto untraced(const u64 depth, const bool fail)
+    -> Result<u64, DepthError> {
+  if (depth == 0) {
+    return leaf(fail);
+  }
+  auto res = untraced(depth - 1, fail);
+  if (res.is_err()) {
+    return trace::propagate(std::get<1>(res));
+  }
+  return {std::get<0>(res) + 1};
+}
+
+static auto BM_PropagateUntraced(benchmark::State &state) -> void {
+  const auto fail = state.range(0) != 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(untraced(16, fail)); // NOLINT
+  }
+}
+
+static auto BM_PropagateTraced(benchmark::State &state) -> void {
+  const auto fail = state.range(0) != 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(traced(16, fail)); // NOLINT
+    trace::clear();
+  }
+}
+
+static auto BM_BacktraceOnError(benchmark::State &state) -> void {
+  void *frames[MAX_DUMP]; // NOLINT
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(untraced(16, true)); // NOLINT
+    benchmark::DoNotOptimize(backtrace(frames, MAX_DUMP));
+  }
+}
+
+static auto BM_SymbolizeTrace(benchmark::State &state) -> void {
+  benchmark::DoNotOptimize(traced(16, true)); // NOLINT
+  const auto hops = trace::take();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fmt::format("{}", hops));
+  }
+}
+
+BENCHMARK(BM_PropagateUntraced)->Arg(0)->Arg(1);
+BENCHMARK(BM_PropagateTraced)->Arg(0)->Arg(1);
+BENCHMARK(BM_BacktraceOnError);
+BENCHMARK(BM_SymbolizeTrace);
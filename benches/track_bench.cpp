@@ -0,0 +1,64 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <memory>
+#include <random>
+
+using namespace exl; // NOLINT
+
+static constexpr usize WINDOW = 256;
+static constexpr usize OPS = 1024;
+
+// Replaces random blocks of a window of live blocks, with the sizes of
+// small AST nodes and strings.
+template <typename Alloc> static auto churn(benchmark::State &state) -> void {
+  auto alloc = Alloc();
+  auto rng = std::mt19937(42); // NOLINT
+  auto sizes = std::array<usize, WINDOW>{};
+  auto live = std::array<u8 *, WINDOW>{};
+  for (usize i = 0; i < WINDOW; ++i) {
+    sizes[i] = 16 + rng() % 240;
+    live[i] = alloc.allocate(sizes[i]);
+  }
+  for (auto _ : state) {
+    for (usize i = 0; i < OPS; ++i) {
+      const auto slot = rng() % WINDOW;
+      alloc.deallocate(live[slot], sizes[slot]);
+      sizes[slot] = 16 + rng() % 240;
+      live[slot] = alloc.allocate(sizes[slot]);
+    }
+  }
+  for (usize i = 0; i < WINDOW; ++i) {
+    alloc.deallocate(live[i], sizes[i]);
+  }
+  state.SetItemsProcessed(state.iterations() * OPS);
+}
+
+using Tracked = mem::TrackingAllocator<"bench", u8, mem::HeapAllocator<u8>>;
+
+static auto BM_Untracked(benchmark::State &state) -> void {
+  churn<mem::HeapAllocator<u8>>(state);
+}
+
+static auto BM_Tracked(benchmark::State &state) -> void {
+  mem::track::set_enabled(true);
+  churn<Tracked>(state);
+}
+
+static auto BM_TrackedDisabled(benchmark::State &state) -> void {
+  mem::track::set_enabled(false);
+  churn<Tracked>(state);
+  mem::track::set_enabled(true);
+}
+
+static auto BM_TrackedSampled(benchmark::State &state) -> void {
+  mem::track::set_sample_rate(state.range(0));
+  churn<Tracked>(state);
+  mem::track::set_sample_rate(0);
+}
+
+BENCHMARK(BM_Untracked);
+BENCHMARK(BM_Tracked);
+BENCHMARK(BM_TrackedDisabled);
+BENCHMARK(BM_TrackedSampled)->Arg(512 << 10)->Arg(64 << 10);
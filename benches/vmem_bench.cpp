@@ -0,0 +1,146 @@
+#include <exl/core.hpp>
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+using namespace exl; // NOLINT
+
+static constexpr usize COUNT = 100'000'000;
+static constexpr usize LOOKUPS = 10'000'000;
+
+// Peak RSS in KiB since the last reset_peak_rss().
+static auto peak_rss() -> usize {
+  auto status = std::ifstream("/proc/self/status");
+  for (auto line = std::string(); std::getline(status, line);) {
+    if (line.starts_with("VmHWM:")) {
+      return std::stoull(line.substr(6));
+    }
+  }
+  return 0;
+}
+
+static auto reset_peak_rss() -> void {
+  auto clear = std::ofstream("/proc/self/clear_refs");
+  clear << "5";
+}
+
+// Counts data TLB read misses of this thread, when perf events are allowed.
+struct TlbCounter {
+  int fd = -1;
+
+  TlbCounter() {
+    auto attr = perf_event_attr{};
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB |
+                  (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  auto start() const -> void {
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  [[nodiscard]] auto stop() const -> usize {
+    usize count = 0;
+    if (fd >= 0) {
+      ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+      if (read(fd, &count, sizeof(count)) != sizeof(count)) {
+        count = 0;
+      }
+    }
+    return count;
+  }
+
+  TlbCounter(const TlbCounter &) = delete;
+  auto operator=(const TlbCounter &) -> TlbCounter & = delete;
+
+  ~TlbCounter() {
+    if (fd >= 0) {
+      close(fd);
+    }
+  }
+};
+
+// Appends COUNT elements, then does LOOKUPS dependent random reads, the
+// access pattern of a node table being built and then walked.
+template <typename Table>
+static auto fill_and_walk(Table &table, benchmark::State &state,
+                          const TlbCounter &tlb, usize &misses) -> void {
+  for (usize i = 0; i < COUNT; ++i) {
+    table.push_back(static_cast<u32>(i * 2654435761U));
+  }
+  state.PauseTiming();
+  tlb.start();
+  state.ResumeTiming();
+  u32 at = 0;
+  for (usize i = 0; i < LOOKUPS; ++i) {
+    at = table[at % COUNT];
+  }
+  benchmark::DoNotOptimize(at);
+  misses += tlb.stop();
+}
+
+static auto report(benchmark::State &state, const TlbCounter &tlb,
+                   const usize rss, const usize misses) -> void {
+  state.counters["peak_rss_MiB"] = static_cast<double>(rss) / 1024;
+  if (tlb.fd >= 0) {
+    state.counters["dtlb_misses"] = benchmark::Counter(
+        static_cast<double>(misses) / static_cast<double>(state.iterations()));
+  }
+  state.SetItemsProcessed(state.iterations() * COUNT);
+}
+
+static auto BM_StdVector(benchmark::State &state) -> void {
+  const auto tlb = TlbCounter();
+  usize misses = 0;
+  usize rss = 0;
+  for (auto _ : state) {
+    reset_peak_rss();
+    auto table = std::vector<u32>();
+    fill_and_walk(table, state, tlb, misses);
+    rss = peak_rss();
+  }
+  report(state, tlb, rss, misses);
+}
+
+// Adapter so fill_and_walk reads the same for both tables.
+struct VirtualTable {
+  mem::VirtualBuffer<u32> buf;
+
+  auto push_back(const u32 val) -> void { buf.push(val); }
+  auto operator[](const usize offset) const -> u32 {
+    return buf.as_slice().get_unchecked(offset);
+  }
+};
+
+static auto BM_VirtualBuffer(benchmark::State &state) -> void {
+  const auto tlb = TlbCounter();
+  usize misses = 0;
+  usize rss = 0;
+  for (auto _ : state) {
+    reset_peak_rss();
+    auto table =
+        VirtualTable{mem::VirtualBuffer<u32>::reserve(COUNT).unwrap()};
+    fill_and_walk(table, state, tlb, misses);
+    rss = peak_rss();
+  }
+  report(state, tlb, rss, misses);
+}
+
+BENCHMARK(BM_StdVector)->Unit(benchmark::kMillisecond)->Iterations(3);
+BENCHMARK(BM_VirtualBuffer)->Unit(benchmark::kMillisecond)->Iterations(3);
@@ -0,0 +1,497 @@
+#pragma once
+
+#include <exl/check.hpp>
+#include <exl/mem.hpp>
+#include <exl/option.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace exl::impl {
+
+// Baseline x86-64 has no popcnt instruction and std::popcount becomes a
+// libgcc call there; this form inlines and vectorizes with plain SSE2.
+[[nodiscard]] constexpr auto popcount64(u64 word) -> u64 {
+  word -= (word >> 1) & 0x5555555555555555ULL;
+  word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+  word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  word += word >> 8;
+  word += word >> 16;
+  word += word >> 32;
+  return word & 0x7f;
+}
+
+// Word loops run in groups of four through local copies, which the SLP
+// vectorizer turns into SSE2 code at -O2 without any alias checks.
+static constexpr usize WORD_GROUP = 4;
+
+template <typename Op>
+auto combine_words(u64 *dst, const u64 *src, const usize len, Op op) -> void {
+  usize i = 0;
+  for (; i + WORD_GROUP <= len; i += WORD_GROUP) {
+    u64 lhs[WORD_GROUP]; // NOLINT
+    u64 rhs[WORD_GROUP]; // NOLINT
+    std::memcpy(lhs, dst + i, sizeof(lhs));
+    std::memcpy(rhs, src + i, sizeof(rhs));
+    for (usize j = 0; j < WORD_GROUP; ++j) {
+      lhs[j] = op(lhs[j], rhs[j]);
+    }
+    std::memcpy(dst + i, lhs, sizeof(lhs));
+  }
+  for (; i < len; ++i) {
+    dst[i] = op(dst[i], src[i]);
+  }
+}
+
+[[nodiscard]] inline auto count_words(const u64 *src, const usize len)
+    -> usize {
+  usize ret = 0;
+  usize i = 0;
+  for (; i + WORD_GROUP <= len; i += WORD_GROUP) {
+    u64 words[WORD_GROUP]; // NOLINT
+    std::memcpy(words, src + i, sizeof(words));
+    for (auto &word : words) {
+      word = popcount64(word);
+    }
+    ret += words[0] + words[1] + words[2] + words[3];
+  }
+  for (; i < len; ++i) {
+    ret += popcount64(src[i]);
+  }
+  return ret;
+}
+
+// Position of the k-th set bit of `word`, counting from zero. Running byte
+// counts narrow it down to one byte before clearing bits one at a time.
+[[nodiscard]] constexpr auto select64(const u64 word, u64 k) -> usize {
+  auto counts = word - ((word >> 1) & 0x5555555555555555ULL);
+  counts = (counts & 0x3333333333333333ULL) +
+           ((counts >> 2) & 0x3333333333333333ULL);
+  counts = (counts + (counts >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  const auto prefix = counts * 0x0101010101010101ULL;
+
+  usize shift = 0;
+  while (((prefix >> shift) & 0xff) <= k) {
+    shift += 8;
+  }
+  if (shift != 0) {
+    k -= (prefix >> (shift - 8)) & 0xff;
+  }
+  auto bits = (word >> shift) & 0xff;
+  for (; k > 0; --k) {
+    bits &= bits - 1;
+  }
+  return shift + static_cast<usize>(std::countr_zero(bits));
+}
+
+} // namespace exl::impl
+
+namespace exl {
+
+// Forward iterator over the indices of the set bits.
+struct SetBitIter {
+  using Self = SetBitIter;
+
+  using value_type = usize;
+  using difference_type = ssize;
+  using reference = usize;
+  using iterator_category = std::input_iterator_tag;
+  using iterator_concept = std::forward_iterator_tag;
+
+  const u64 *words{};
+  usize len{};
+  usize index{};
+  u64 bits{};
+
+  [[nodiscard]] friend constexpr auto
+  operator==(const SetBitIter &rhs, const SetBitIter &lhs) // NOLINT
+      -> bool {
+    return rhs.index == lhs.index && rhs.bits == lhs.bits;
+  }
+
+  [[nodiscard]] constexpr auto operator*() const -> usize {
+    return index * 64 + static_cast<usize>(std::countr_zero(bits));
+  }
+
+  constexpr auto next() -> void {
+    bits &= bits - 1;
+    while (bits == 0 && ++index < len) {
+      bits = words[index];
+    }
+  }
+
+  constexpr auto operator++() -> Self & {
+    this->next();
+    return *this;
+  }
+  constexpr auto operator++(int) -> Self {
+    auto ret = *this;
+    this->next();
+    return ret;
+  }
+
+  [[nodiscard]] constexpr SetBitIter() = default;
+  [[nodiscard]] constexpr explicit SetBitIter(const u64 *_words,
+                                              const usize _len,
+                                              const usize _index = 0)
+      : words{_words}, len{_len}, index{_index} {
+    while (index < len && (bits = words[index]) == 0) {
+      ++index;
+    }
+  }
+};
+
+// Bit view over a Slice<u64>, bit i being bit i % 64 of word i / 64. Bits
+// past `len` in the last word are kept clear so that counting and
+// iteration never have to mask them.
+struct BitSlice {
+  using Self = BitSlice;
+  using It = SetBitIter;
+
+  Slice<u64> words;
+  usize len{};
+
+  [[nodiscard]] constexpr auto size() const -> usize { return len; }
+  [[nodiscard]] constexpr auto word_len() const -> usize { return words.cap; }
+
+  [[nodiscard]] constexpr auto begin() const -> It {
+    return It(words.as_ptr(), words.cap);
+  }
+  [[nodiscard]] constexpr auto end() const -> It {
+    return It(words.as_ptr(), words.cap, words.cap);
+  }
+
+  // P decides whether `bit` is checked against len, like Slice::operator[].
+  // A bit past len in the last word would otherwise break clear_tail's
+  // invariant without ever leaving the words.
+  template <traits::CheckPolicy P = check::Checked>
+  [[nodiscard]] constexpr auto test(const usize bit) const -> bool {
+    this->check_bit<P>(bit);
+    return ((words.as_ref(bit / 64) >> (bit % 64)) & 1) != 0;
+  }
+
+  template <traits::CheckPolicy P = check::Checked>
+  constexpr auto set(const usize bit) const -> void {
+    this->check_bit<P>(bit);
+    words.as_ref(bit / 64) |= u64{1} << (bit % 64);
+  }
+
+  template <traits::CheckPolicy P = check::Checked>
+  constexpr auto reset(const usize bit) const -> void {
+    this->check_bit<P>(bit);
+    words.as_ref(bit / 64) &= ~(u64{1} << (bit % 64));
+  }
+
+  auto set_all() const -> void {
+    std::fill(words.begin(), words.end(), ~u64{0});
+    this->clear_tail();
+  }
+
+  auto reset_all() const -> void {
+    std::fill(words.begin(), words.end(), u64{0});
+  }
+
+  [[nodiscard]] auto count() const -> usize {
+    return impl::count_words(words.as_ptr(), words.cap);
+  }
+
+  [[nodiscard]] auto any() const -> bool {
+    return std::any_of(words.begin(), words.end(),
+                       [](const u64 word) { return word != 0; });
+  }
+
+  [[nodiscard]] auto none() const -> bool { return !this->any(); }
+
+  // First set bit at or after `from`.
+  [[nodiscard]] constexpr auto find_next(const usize from) const
+      -> Option<usize> {
+    if (from >= len) {
+      return {};
+    }
+    auto index = from / 64;
+    auto bits = words.as_ref(index) & (~u64{0} << (from % 64));
+    while (bits == 0) {
+      if (++index == words.cap) {
+        return {};
+      }
+      bits = words.as_ref(index);
+    }
+    return {index * 64 + static_cast<usize>(std::countr_zero(bits))};
+  }
+
+  [[nodiscard]] constexpr auto find_first() const -> Option<usize> {
+    return this->find_next(0);
+  }
+
+  // The binary operations treat the shorter operand as zero extended.
+  auto operator&=(const BitSlice &other) const -> const Self & {
+    const auto shared = std::min(words.cap, other.words.cap);
+    impl::combine_words(words.as_ptr(), other.words.as_ptr(), shared,
+                        [](u64 lhs, u64 rhs) { return lhs & rhs; });
+    std::fill(words.as_ptr(shared), words.as_ptr(words.cap), u64{0});
+    return *this;
+  }
+
+  auto operator|=(const BitSlice &other) const -> const Self & {
+    impl::combine_words(words.as_ptr(), other.words.as_ptr(),
+                        std::min(words.cap, other.words.cap),
+                        [](u64 lhs, u64 rhs) { return lhs | rhs; });
+    this->clear_tail();
+    return *this;
+  }
+
+  auto operator^=(const BitSlice &other) const -> const Self & {
+    impl::combine_words(words.as_ptr(), other.words.as_ptr(),
+                        std::min(words.cap, other.words.cap),
+                        [](u64 lhs, u64 rhs) { return lhs ^ rhs; });
+    this->clear_tail();
+    return *this;
+  }
+
+  // Clears every bit that is set in `other`.
+  auto and_not(const BitSlice &other) const -> const Self & {
+    impl::combine_words(words.as_ptr(), other.words.as_ptr(),
+                        std::min(words.cap, other.words.cap),
+                        [](u64 lhs, u64 rhs) { return lhs & ~rhs; });
+    return *this;
+  }
+
+  [[nodiscard]] friend auto operator==(const BitSlice &rhs, // NOLINT
+                                       const BitSlice &lhs) -> bool {
+    return rhs.len == lhs.len && std::equal(rhs.words.begin(), rhs.words.end(),
+                                            lhs.words.begin());
+  }
+
+  template <traits::CheckPolicy P>
+  constexpr auto check_bit(const usize bit) const -> void {
+    if constexpr (P::enabled) {
+      if (bit >= len) [[unlikely]] {
+        impl::panic_bounds(len, bit);
+      }
+    }
+  }
+
+  constexpr auto clear_tail() const -> void {
+    if (len % 64 != 0) {
+      words.as_ref(words.cap - 1) &= (u64{1} << (len % 64)) - 1;
+    }
+  }
+
+  [[nodiscard]] static constexpr auto words_for(const usize bits) -> usize {
+    return (bits + 63) / 64;
+  }
+
+  [[nodiscard]] constexpr BitSlice() = default;
+  [[nodiscard]] constexpr explicit BitSlice(const Slice<u64> _words,
+                                            const usize _len)
+      : words{_words}, len{_len} {}
+
+  [[nodiscard]] static constexpr auto from_unchecked(const Slice<u64> _words,
+                                                     const usize _len)
+      -> Self {
+    return Self(_words, _len);
+  }
+
+  [[nodiscard]] static constexpr auto from(const Slice<u64> _words,
+                                           const usize _len) -> Option<Self> {
+    if (words_for(_len) != _words.cap) {
+      return {};
+    }
+    return {Self(_words, _len)};
+  }
+};
+
+// Growable bit set. Sets of up to INLINE * 64 bits live inside the object;
+// larger ones move to the heap.
+struct BitSet {
+  using Self = BitSet;
+  using It = SetBitIter;
+
+  static constexpr usize INLINE = 2;
+
+  u64 *heap{};
+  usize cap{INLINE};
+  usize len{};
+  u64 small[INLINE]{}; // NOLINT
+
+  [[nodiscard]] constexpr auto data() -> u64 * {
+    return heap == nullptr ? small : heap;
+  }
+  [[nodiscard]] constexpr auto data() const -> const u64 * {
+    return heap == nullptr ? small : heap;
+  }
+
+  [[nodiscard]] constexpr auto size() const -> usize { return len; }
+  [[nodiscard]] constexpr auto is_inline() const -> bool {
+    return heap == nullptr;
+  }
+
+  [[nodiscard]] auto as_slice() const -> BitSlice {
+    return BitSlice::from_unchecked(
+        Slice<u64>::from_unchecked(const_cast<u64 *>(this->data()), // NOLINT
+                                   BitSlice::words_for(len)),
+        len);
+  }
+
+  [[nodiscard]] auto begin() const -> It { return this->as_slice().begin(); }
+  [[nodiscard]] auto end() const -> It { return this->as_slice().end(); }
+
+  template <traits::CheckPolicy P = check::Checked>
+  [[nodiscard]] auto test(const usize bit) const -> bool {
+    return this->as_slice().test<P>(bit);
+  }
+  template <traits::CheckPolicy P = check::Checked>
+  auto set(const usize bit) -> void {
+    this->as_slice().set<P>(bit);
+  }
+  template <traits::CheckPolicy P = check::Checked>
+  auto reset(const usize bit) -> void {
+    this->as_slice().reset<P>(bit);
+  }
+  auto set_all() -> void { this->as_slice().set_all(); }
+  auto reset_all() -> void { this->as_slice().reset_all(); }
+
+  [[nodiscard]] auto count() const -> usize { return this->as_slice().count(); }
+  [[nodiscard]] auto any() const -> bool { return this->as_slice().any(); }
+  [[nodiscard]] auto none() const -> bool { return this->as_slice().none(); }
+
+  [[nodiscard]] auto find_first() const -> Option<usize> {
+    return this->as_slice().find_first();
+  }
+  [[nodiscard]] auto find_next(const usize from) const -> Option<usize> {
+    return this->as_slice().find_next(from);
+  }
+
+  auto operator&=(const BitSet &other) -> Self & {
+    this->as_slice() &= other.as_slice();
+    return *this;
+  }
+  auto operator|=(const BitSet &other) -> Self & {
+    this->as_slice() |= other.as_slice();
+    return *this;
+  }
+  auto operator^=(const BitSet &other) -> Self & {
+    this->as_slice() ^= other.as_slice();
+    return *this;
+  }
+  auto and_not(const BitSet &other) -> Self & {
+    this->as_slice().and_not(other.as_slice());
+    return *this;
+  }
+
+  [[nodiscard]] friend auto operator==(const BitSet &rhs, // NOLINT
+                                       const BitSet &lhs) -> bool {
+    return rhs.as_slice() == lhs.as_slice();
+  }
+
+  // Grows or shrinks to `_len` bits; new bits are clear.
+  auto resize(const usize _len) -> void {
+    const auto old_words = BitSlice::words_for(len);
+    const auto new_words = BitSlice::words_for(_len);
+    if (new_words > cap) {
+      auto *grown = new u64[std::max(new_words, cap * 2)];
+      std::copy(this->data(), this->data() + old_words, grown);
+      delete[] heap;
+      heap = grown;
+      cap = std::max(new_words, cap * 2);
+    }
+    if (new_words > old_words) {
+      std::fill(this->data() + old_words, this->data() + new_words, u64{0});
+    }
+    len = _len;
+    this->as_slice().clear_tail();
+  }
+
+  [[nodiscard]] BitSet() = default;
+  [[nodiscard]] explicit BitSet(const usize _len) { this->resize(_len); }
+
+  BitSet(const BitSet &other) : BitSet(other.len) {
+    std::copy(other.data(), other.data() + BitSlice::words_for(len),
+              this->data());
+  }
+
+  BitSet(BitSet &&other) noexcept
+      : heap{std::exchange(other.heap, nullptr)},
+        cap{std::exchange(other.cap, INLINE)},
+        len{std::exchange(other.len, 0)} {
+    std::copy(other.small, other.small + INLINE, small);
+  }
+
+  auto operator=(BitSet other) noexcept -> BitSet & {
+    std::swap(heap, other.heap);
+    std::swap(cap, other.cap);
+    std::swap(len, other.len);
+    std::swap(small, other.small);
+    return *this;
+  }
+
+  ~BitSet() { delete[] heap; }
+};
+
+// Rank/select directory over a BitSlice that must outlive it. Cumulative
+// counts every 512 bits make rank one lookup plus at most eight word
+// counts, and select a binary search plus the same scan.
+struct RankIndex {
+  using Self = RankIndex;
+
+  static constexpr usize WORDS_PER_BLOCK = 8;
+
+  BitSlice bits;
+  std::vector<u64> blocks;
+
+  // Number of set bits in [0, bit).
+  [[nodiscard]] auto rank(const usize bit) const -> usize {
+    const auto word = std::min(bit / 64, bits.word_len());
+    const auto block = word / WORDS_PER_BLOCK;
+    auto ret = blocks[block];
+    for (auto i = block * WORDS_PER_BLOCK; i < word; ++i) {
+      ret += impl::popcount64(bits.words.as_ref(i));
+    }
+    if (bit % 64 != 0 && word < bits.word_len()) {
+      ret += impl::popcount64(bits.words.as_ref(word) &
+                              ((u64{1} << (bit % 64)) - 1));
+    }
+    return ret;
+  }
+
+  // Position of the k-th set bit, counting from zero.
+  [[nodiscard]] auto select(usize k) const -> Option<usize> {
+    if (k >= blocks.back()) {
+      return {};
+    }
+    const auto block = static_cast<usize>(
+        std::upper_bound(blocks.begin(), blocks.end(), k) - blocks.begin() -
+        1);
+    k -= blocks[block];
+    for (auto i = block * WORDS_PER_BLOCK;; ++i) {
+      const auto word = bits.words.as_ref(i);
+      const auto ones = impl::popcount64(word);
+      if (k < ones) {
+        return {i * 64 + impl::select64(word, k)};
+      }
+      k -= ones;
+    }
+  }
+
+  [[nodiscard]] explicit RankIndex(const BitSlice _bits) : bits{_bits} {
+    const auto len = bits.word_len();
+    blocks.reserve(len / WORDS_PER_BLOCK + 2);
+    usize total = 0;
+    for (usize i = 0; i < len; i += WORDS_PER_BLOCK) {
+      blocks.push_back(total);
+      total += impl::count_words(bits.words.as_ptr(i),
+                                 std::min(WORDS_PER_BLOCK, len - i));
+    }
+    blocks.push_back(total);
+  }
+};
+
+static_assert(std::forward_iterator<SetBitIter>);
+static_assert(std::ranges::forward_range<BitSlice>);
+
+} // namespace exl
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <exl/check.hpp>
+#include <exl/mem.hpp>
+#include <exl/option.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <utility>
+
+namespace exl::impl {
+
+// Shared allocation behind Bytes and BytesMut: a refcount and capacity
+// followed directly by the data.
+struct BytesHeader {
+  std::atomic<usize> refs;
+  usize cap;
+
+  [[nodiscard]] auto data() -> u8 * { return ptr::cast<u8>(this + 1); }
+
+  [[nodiscard]] static auto alloc(const usize cap) -> BytesHeader * {
+    auto *mem = ::operator new(sizeof(BytesHeader) + cap);
+    return new (mem) BytesHeader{{1}, cap};
+  }
+
+  auto retain() -> void { refs.fetch_add(1, std::memory_order_relaxed); }
+
+  auto release() -> void {
+    if (refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      this->~BytesHeader();
+      ::operator delete(this);
+    }
+  }
+};
+
+} // namespace exl::impl
+
+namespace exl {
+
+// Immutable, atomically refcounted byte buffer. Copies and sub-slices share
+// the allocation, so they are cheap to hand to other threads. Buffers built
+// from static data carry no allocation at all.
+struct Bytes {
+  using Self = Bytes;
+  using Val = u8;
+  using Ptr = const u8 *;
+  using Ref = const u8 &;
+
+  using CIt = CIter<u8>;
+
+  impl::BytesHeader *shared{};
+  Ptr ptr{};
+  usize len{};
+
+  [[nodiscard]] constexpr auto size() const -> usize { return len; }
+  [[nodiscard]] constexpr auto is_empty() const -> bool { return len == 0; }
+  [[nodiscard]] constexpr auto data() const -> Ptr { return ptr; }
+
+  [[nodiscard]] constexpr auto as_ptr(const usize offset = 0) const -> Ptr {
+    return ptr::add(ptr, offset);
+  }
+
+  [[nodiscard]] constexpr auto as_str() const -> std::string_view {
+    return {ptr::cast<char>(ptr), len};
+  }
+
+  [[nodiscard]] constexpr auto as_slice() const -> Slice<const u8> {
+    return Slice<const u8>::from_unchecked(ptr, len);
+  }
+
+  [[nodiscard]] constexpr auto begin() const -> CIt {
+    return CIt::from_unchecked(ptr);
+  }
+  [[nodiscard]] constexpr auto end() const -> CIt {
+    return CIt::from_unchecked(this->as_ptr(len));
+  }
+
+  [[nodiscard]] constexpr auto operator[](const usize offset) const -> Ref {
+    if (offset >= len) [[unlikely]] {
+      impl::panic_bounds(len, offset);
+    }
+    return ptr[offset];
+  }
+
+  // Number of Bytes sharing this allocation, 0 for static data.
+  [[nodiscard]] auto use_count() const -> usize {
+    return shared == nullptr ? 0 : shared->refs.load(std::memory_order_relaxed);
+  }
+
+  // Shares the allocation instead of copying, with the bounds rules of
+  // Slice::slice.
+  [[nodiscard]] auto slice(const usize start, const usize end) const
+      -> Option<Self> {
+    if ((end > len) || (start >= end)) {
+      return {};
+    }
+    return {Self(shared, ptr::add(ptr, start), end - start)};
+  }
+
+  [[nodiscard]] friend auto operator==(const Bytes &rhs, const Bytes &lhs)
+      -> bool {
+    return rhs.as_str() == lhs.as_str();
+  }
+
+  [[nodiscard]] constexpr Bytes() = default;
+
+  [[nodiscard]] explicit Bytes(impl::BytesHeader *_shared, const Ptr _ptr,
+                               const usize _len)
+      : shared{_shared}, ptr{_ptr}, len{_len} {
+    if (shared != nullptr) {
+      shared->retain();
+    }
+  }
+
+  Bytes(const Bytes &other) : Bytes(other.shared, other.ptr, other.len) {}
+
+  Bytes(Bytes &&other) noexcept
+      : shared{std::exchange(other.shared, nullptr)},
+        ptr{std::exchange(other.ptr, nullptr)},
+        len{std::exchange(other.len, 0)} {}
+
+  auto operator=(Bytes other) noexcept -> Bytes & {
+    std::swap(shared, other.shared);
+    std::swap(ptr, other.ptr);
+    std::swap(len, other.len);
+    return *this;
+  }
+
+  ~Bytes() {
+    if (shared != nullptr) {
+      shared->release();
+    }
+  }
+
+  [[nodiscard]] static auto from_static(const std::string_view str) -> Self {
+    return Self(nullptr, ptr::cast<u8>(str.data()), str.size());
+  }
+
+  [[nodiscard]] static auto copy_from(const std::string_view str) -> Self;
+};
+
+// Growable, uniquely owned byte buffer. freeze() turns it into Bytes without
+// copying.
+struct BytesMut {
+  using Self = BytesMut;
+  using Val = u8;
+  using Ptr = u8 *;
+  using Ref = u8 &;
+
+  using It = Iter<u8>;
+
+  impl::BytesHeader *shared{};
+  usize len{};
+
+  [[nodiscard]] constexpr auto size() const -> usize { return len; }
+  [[nodiscard]] constexpr auto is_empty() const -> bool { return len == 0; }
+
+  [[nodiscard]] auto capacity() const -> usize {
+    return shared == nullptr ? 0 : shared->cap;
+  }
+
+  [[nodiscard]] auto as_ptr(const usize offset = 0) const -> Ptr {
+    return shared == nullptr ? nullptr : ptr::add(shared->data(), offset);
+  }
+
+  [[nodiscard]] auto data() const -> Ptr { return this->as_ptr(); }
+
+  [[nodiscard]] auto as_str() const -> std::string_view {
+    return {ptr::cast<char>(this->as_ptr()), len};
+  }
+
+  [[nodiscard]] auto as_slice() const -> Slice<u8> {
+    return Slice<u8>::from_unchecked(this->as_ptr(), len);
+  }
+
+  [[nodiscard]] auto begin() const -> It {
+    return It::from_unchecked(this->as_ptr());
+  }
+  [[nodiscard]] auto end() const -> It {
+    return It::from_unchecked(this->as_ptr(len));
+  }
+
+  auto reserve(const usize additional) -> void {
+    if (len + additional <= this->capacity()) {
+      return;
+    }
+    auto *grown = impl::BytesHeader::alloc(
+        std::max(len + additional, this->capacity() * 2));
+    if (shared != nullptr) {
+      std::memcpy(grown->data(), shared->data(), len);
+      shared->release();
+    }
+    shared = grown;
+  }
+
+  auto push(const u8 byte) -> Self & {
+    this->reserve(1);
+    shared->data()[len++] = byte;
+    return *this;
+  }
+
+  auto append(const std::string_view str) -> Self & {
+    if (str.empty()) {
+      return *this;
+    }
+    this->reserve(str.size());
+    std::memcpy(shared->data() + len, str.data(), str.size());
+    len += str.size();
+    return *this;
+  }
+
+  auto append(const Slice<const u8> bytes) -> Self & {
+    return this->append(
+        std::string_view(ptr::cast<char>(bytes.as_ptr()), bytes.cap));
+  }
+
+  auto clear() -> void { len = 0; }
+
+  // Hands the buffer over to an immutable Bytes, leaving this one empty.
+  [[nodiscard]] auto freeze() -> Bytes {
+    if (shared == nullptr) {
+      return {};
+    }
+    auto ret = Bytes(shared, shared->data(), std::exchange(len, 0));
+    // ret holds a reference now, so dropping ours never frees.
+    auto *const header = std::exchange(shared, nullptr);
+    header->refs.fetch_sub(1, std::memory_order_relaxed);
+    return ret;
+  }
+
+  [[nodiscard]] constexpr BytesMut() = default;
+
+  BytesMut(const BytesMut &) = delete;
+  auto operator=(const BytesMut &) -> BytesMut & = delete;
+
+  BytesMut(BytesMut &&other) noexcept
+      : shared{std::exchange(other.shared, nullptr)},
+        len{std::exchange(other.len, 0)} {}
+
+  auto operator=(BytesMut &&other) noexcept -> BytesMut & {
+    std::swap(shared, other.shared);
+    std::swap(len, other.len);
+    return *this;
+  }
+
+  ~BytesMut() {
+    if (shared != nullptr) {
+      shared->release();
+    }
+  }
+
+  [[nodiscard]] static auto with_capacity(const usize cap) -> Self {
+    auto ret = Self();
+    ret.reserve(cap);
+    return ret;
+  }
+};
+
+inline auto Bytes::copy_from(const std::string_view str) -> Self {
+  auto buf = BytesMut::with_capacity(str.size());
+  buf.append(str);
+  return buf.freeze();
+}
+
+} // namespace exl
+
+template <>
+struct fmt::formatter<exl::Bytes> : fmt::formatter<std::string_view> {
+  template <typename FormatContext>
+  auto format(const exl::Bytes &bytes, FormatContext &ctx) const
+      -> decltype(ctx.out()) {
+    return fmt::formatter<std::string_view>::format(bytes.as_str(), ctx);
+  }
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <exl/traceback.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <cstdlib>
+
+namespace exl::check {
+
+struct Checked {
+  static constexpr bool enabled = true;
+};
+
+struct DebugOnly {
+#ifdef NDEBUG
+  static constexpr bool enabled = false;
+#else
+  static constexpr bool enabled = true;
+#endif
+};
+
+struct Unchecked {
+  static constexpr bool enabled = false;
+};
+
+} // namespace exl::check
+
+namespace exl::traits {
+
+template <typename P>
+concept CheckPolicy = requires {
+  { P::enabled } -> std::convertible_to<bool>;
+};
+
+} // namespace exl::traits
+
+namespace exl::impl {
+
+// Failure paths live out of line so that a checked access inlines to a
+// compare and a branch to here.
+[[noreturn, gnu::cold, gnu::noinline]] inline auto
+panic_bounds(const usize len, const usize offset) -> void {
+  char msg[96]; // NOLINT
+  auto res =
+      fmt::format_to_n(msg, sizeof(msg),
+                       "Tried to index slice of size {}, at offset {}", len,
+                       offset);
+  panic({msg, std::min(res.size, sizeof(msg))});
+  std::abort();
+}
+
+[[noreturn, gnu::cold, gnu::noinline]] inline auto panic_null() -> void {
+  panic("Dereferenced a null iterator");
+  std::abort();
+}
+
+[[noreturn, gnu::cold, gnu::noinline]] inline auto
+panic_unwrap(const char *what) -> void {
+  panic(what);
+  std::abort();
+}
+
+} // namespace exl::impl
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <exl/epoch.hpp>
+#include <exl/mem.hpp>
+#include <exl/option.hpp>
+#include <exl/types.hpp>
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+namespace exl::impl {
+
+// Fibonacci hashing spreads identity hashes such as std::hash<u64> over
+// the top bits, which pick the shard, and the bits below, which pick the
+// slot.
+[[nodiscard]] constexpr auto spread(const u64 hash) -> u64 {
+  return hash * 0x9e3779b97f4a7c15ULL; // NOLINT
+}
+
+} // namespace exl::impl
+
+namespace exl {
+
+// Hash map for caches shared between threads. Keys hash to one of N shards;
+// each shard is a linear probing table guarded by its own write lock.
+// Readers take no lock: they pin the map's epoch domain, probe the table
+// and validate the shard's sequence counter, retrying if a writer
+// overwrote a slot or resized the table meanwhile. Tables replaced by a
+// resize are retired to the domain, so a shard grows without stopping the
+// others or its own readers.
+//
+// Slots are read while they may be written, so keys and values must be
+// trivially copyable; keep larger payloads elsewhere and map to handles.
+template <typename K, typename V, typename Hash = std::hash<K>, usize N = 64>
+struct ConcurrentMap {
+  static_assert(std::is_trivially_copyable_v<K> &&
+                    std::is_trivially_copyable_v<V>,
+                "ConcurrentMap keys and values must be trivially copyable");
+  static_assert(N > 0 && std::has_single_bit(N),
+                "ConcurrentMap shard count must be a power of two");
+
+  using Self = ConcurrentMap<K, V, Hash, N>;
+  using Key = K;
+  using Val = V;
+
+  static constexpr usize SHARD_BITS = std::countr_zero(N);
+  static constexpr usize MIN_CAPACITY = 8;
+
+  struct Entry {
+    K key;
+    V val;
+  };
+
+  static constexpr usize WORDS = (sizeof(Entry) + 7) / 8;
+
+  // An entry split into atomic words so that racing reads are well
+  // defined; the sequence counter tells the reader whether they were torn.
+  struct Slot {
+    std::array<std::atomic<u64>, WORDS> words;
+
+    [[nodiscard]] auto load() const -> Entry {
+      auto raw = std::array<u64, WORDS>{};
+      for (usize i = 0; i < WORDS; ++i) {
+        raw[i] = words[i].load(std::memory_order_acquire);
+      }
+      auto bytes = std::array<u8, sizeof(Entry)>{};
+      std::memcpy(bytes.data(), raw.data(), sizeof(Entry));
+      return std::bit_cast<Entry>(bytes);
+    }
+
+    auto store(const Entry &entry) -> void {
+      auto raw = std::array<u64, WORDS>{};
+      std::memcpy(raw.data(), &entry, sizeof(Entry));
+      for (usize i = 0; i < WORDS; ++i) {
+        words[i].store(raw[i], std::memory_order_release);
+      }
+    }
+  };
+
+  // A tag of 0 marks an empty slot; full slots keep their hash with the
+  // low bit set, so most mismatches never touch the slot.
+  struct Table {
+    usize mask;
+    usize shift;
+    std::unique_ptr<std::atomic<u64>[]> tags;
+    std::unique_ptr<Slot[]> slots;
+
+    explicit Table(const usize _capacity)
+        : mask{_capacity - 1},
+          shift{static_cast<usize>(64 - std::countr_zero(_capacity))},
+          tags{new std::atomic<u64>[_capacity]()},
+          slots{new Slot[_capacity]} {}
+
+    [[nodiscard]] auto capacity() const -> usize { return mask + 1; }
+
+    // Where the probe for `tag` starts: the bits just below the shard bits,
+    // the best mixed ones after the shard's.
+    [[nodiscard]] auto home(const u64 tag) const -> usize {
+      return static_cast<usize>((tag << SHARD_BITS) >> shift);
+    }
+
+    // Offset of the slot holding `key`, or of the empty slot ending its
+    // probe sequence.
+    [[nodiscard]] auto probe(const K &key, const u64 tag) const -> usize {
+      for (auto at = this->home(tag);; ++at) {
+        at &= mask;
+        const auto seen = tags[at].load(std::memory_order_acquire);
+        if (seen == 0 || (seen == tag && slots[at].load().key == key)) {
+          return at;
+        }
+      }
+    }
+  };
+
+  struct alignas(CACHE_LINE) Shard {
+    std::atomic<u64> seq{};
+    std::atomic<Table *> table{};
+    std::atomic<usize> len{};
+    std::mutex lock;
+  };
+
+  sync::Epoch domain;
+  std::array<Shard, N> shards;
+
+  ConcurrentMap() = default;
+
+  ConcurrentMap(const ConcurrentMap &) = delete;
+  auto operator=(const ConcurrentMap &) -> ConcurrentMap & = delete;
+
+  ~ConcurrentMap() {
+    for (auto &shard : shards) {
+      delete shard.table.load(std::memory_order_relaxed); // NOLINT
+    }
+  }
+
+  [[nodiscard]] auto size() const -> usize {
+    usize total = 0;
+    for (const auto &shard : shards) {
+      total += shard.len.load(std::memory_order_relaxed);
+    }
+    return total;
+  }
+
+  [[nodiscard]] auto is_empty() const -> bool { return this->size() == 0; }
+
+  [[nodiscard]] auto get(const K &key) -> Option<V> {
+    const auto tag = Self::tag_of(key);
+    auto &shard = this->shard_of(tag);
+    const auto guard = domain.pin();
+    for (;;) {
+      const auto seq = shard.seq.load(std::memory_order_acquire);
+      if ((seq & 1) != 0) [[unlikely]] {
+        std::this_thread::yield();
+        continue;
+      }
+      auto found = Option<V>();
+      if (const auto *table = shard.table.load(std::memory_order_acquire)) {
+        const auto at = table->probe(key, tag);
+        if (table->tags[at].load(std::memory_order_acquire) != 0) {
+          found = Option<V>(table->slots[at].load().val);
+        }
+      }
+      // The slot loads are acquire, so this load cannot move above them.
+      if (shard.seq.load(std::memory_order_relaxed) == seq) [[likely]] {
+        return found;
+      }
+    }
+  }
+
+  // Inserts or overwrites. Returns true if the key was new.
+  auto upsert(const K &key, const V &val) -> bool {
+    const auto tag = Self::tag_of(key);
+    auto &shard = this->shard_of(tag);
+    const auto guard = std::lock_guard(shard.lock);
+    auto *table = this->reserve_one(shard);
+    const auto at = table->probe(key, tag);
+    if (table->tags[at].load(std::memory_order_relaxed) != 0) {
+      shard.seq.fetch_add(1, std::memory_order_acq_rel);
+      table->slots[at].store({key, val});
+      shard.seq.fetch_add(1, std::memory_order_release);
+      return false;
+    }
+    Self::publish(shard, *table, at, {key, val}, tag);
+    return true;
+  }
+
+  // Returns the value of `key`, inserting `make()` first if it is missing.
+  // `make` runs under the shard's write lock, at most once per key.
+  template <typename TF> auto compute_if_absent(const K &key, TF &&make) -> V {
+    if (auto found = this->get(key); found.is_some()) {
+      return found.unwrap();
+    }
+    const auto tag = Self::tag_of(key);
+    auto &shard = this->shard_of(tag);
+    const auto guard = std::lock_guard(shard.lock);
+    auto *table = this->reserve_one(shard);
+    const auto at = table->probe(key, tag);
+    if (table->tags[at].load(std::memory_order_relaxed) != 0) {
+      return table->slots[at].load().val;
+    }
+    const auto val = V(std::forward<TF>(make)());
+    Self::publish(shard, *table, at, {key, val}, tag);
+    return val;
+  }
+
+private:
+  [[nodiscard]] static auto tag_of(const K &key) -> u64 {
+    return impl::spread(static_cast<u64>(Hash{}(key))) | 1;
+  }
+
+  [[nodiscard]] auto shard_of(const u64 tag) -> Shard & {
+    if constexpr (N == 1) {
+      return shards[0];
+    } else {
+      return shards[tag >> (64 - SHARD_BITS)];
+    }
+  }
+
+  // Slots go in before their tag, so a reader that sees the tag sees the
+  // entry and no sequence bump is needed.
+  static auto publish(Shard &shard, Table &table, const usize at,
+                      const Entry &entry, const u64 tag) -> void {
+    table.slots[at].store(entry);
+    table.tags[at].store(tag, std::memory_order_release);
+    shard.len.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // Makes room for one more entry, keeping the load factor under 3/4.
+  // Called under the shard lock.
+  auto reserve_one(Shard &shard) -> Table * {
+    auto *table = shard.table.load(std::memory_order_relaxed);
+    const auto len = shard.len.load(std::memory_order_relaxed);
+    if (table != nullptr && (len + 1) * 4 <= table->capacity() * 3) {
+      return table;
+    }
+    auto *grown = new Table( // NOLINT
+        table == nullptr ? MIN_CAPACITY : table->capacity() * 2);
+    if (table != nullptr) {
+      for (usize i = 0; i < table->capacity(); ++i) {
+        const auto tag = table->tags[i].load(std::memory_order_relaxed);
+        if (tag != 0) {
+          const auto entry = table->slots[i].load();
+          const auto at = grown->probe(entry.key, tag);
+          grown->slots[at].store(entry);
+          grown->tags[at].store(tag, std::memory_order_relaxed);
+        }
+      }
+    }
+    // Readers that saw the old table retry once the new one is in place.
+    shard.seq.fetch_add(1, std::memory_order_acq_rel);
+    shard.table.store(grown, std::memory_order_release);
+    shard.seq.fetch_add(1, std::memory_order_release);
+    if (table != nullptr) {
+      domain.retire(table);
+    }
+    return grown;
+  }
+};
+
+} // namespace exl
@@ -1,12 +1,33 @@
 #pragma once
 
+#include <exl/bitset.hpp>
+#include <exl/bytes.hpp>
+#include <exl/check.hpp>
+#include <exl/concurrent.hpp>
 #include <exl/defer.hpp>
+#include <exl/epoch.hpp>
 #include <exl/err.hpp>
 #include <exl/fmt.hpp>
+#include <exl/function.hpp>
+#include <exl/generator.hpp>
+#include <exl/hashcons.hpp>
+#include <exl/heap.hpp>
 #include <exl/iter.hpp>
 #include <exl/mem.hpp>
 #include <exl/option.hpp>
+#include <exl/packed.hpp>
+#include <exl/parse.hpp>
 #include <exl/pattern.hpp>
+#include <exl/persistent.hpp>
+#include <exl/pool.hpp>
+#include <exl/query.hpp>
+#include <exl/queue.hpp>
 #include <exl/reflection.hpp>
+#include <exl/rope.hpp>
+#include <exl/sort.hpp>
+#include <exl/strbuf.hpp>
+#include <exl/text.hpp>
 #include <exl/traceback.hpp>
+#include <exl/track.hpp>
 #include <exl/types.hpp>
+#include <exl/vmem.hpp>
@@ -0,0 +1,322 @@
+#pragma once
+
+#include <exl/defer.hpp>
+#include <exl/mem.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace exl::sync {
+
+struct Epoch;
+
+} // namespace exl::sync
+
+namespace exl::sync::impl {
+
+struct Retired {
+  void *ptr;
+  void (*deleter)(void *);
+};
+
+// Retired objects sealed at `epoch`. They are unreachable for readers that
+// pin at epoch + 1 or later, so they are freed once the global epoch is
+// two past it.
+struct Batch {
+  u64 epoch;
+  std::vector<Retired> items;
+};
+
+inline auto free_batch(Batch &batch) -> void {
+  for (const auto &item : batch.items) {
+    item.deleter(item.ptr);
+  }
+  batch.items.clear();
+}
+
+// A thread's participation in one domain. Only the owning thread touches it,
+// except `state`, which advancing threads read, and `domain`, which a dying
+// domain clears under its lock.
+struct alignas(CACHE_LINE) Local {
+  std::atomic<u64> state{}; // (epoch << 1) | 1 while pinned, 0 otherwise
+  Epoch *domain{};
+  Local *next{};
+  u32 depth{};
+  u32 pins{};
+  std::vector<Retired> limbo;
+  std::vector<Batch> sealed;
+};
+
+// Per-thread table of the Locals of every domain the thread has used, with
+// the last one used cached in trivially destructible thread_locals so that
+// pinning skips the table.
+struct Locals {
+  std::vector<Local *> list;
+
+  Locals() = default;
+  Locals(const Locals &) = delete;
+  auto operator=(const Locals &) -> Locals & = delete;
+
+  ~Locals();
+};
+
+// NOLINTBEGIN
+inline constinit thread_local Epoch *LAST_DOMAIN = nullptr;
+inline constinit thread_local Local *LAST_LOCAL = nullptr;
+// NOLINTEND
+
+// Ends a pin when the Guard holding it leaves scope. Moving hands the pin
+// over, so only one Guard ends it.
+struct Unpin {
+  Local *local;
+
+  explicit Unpin(Local *_local) : local{_local} {}
+  Unpin(Unpin &&other) noexcept : local{std::exchange(other.local, nullptr)} {}
+  Unpin(const Unpin &) = delete;
+  auto operator=(const Unpin &) -> Unpin & = delete;
+  auto operator=(Unpin &&) -> Unpin & = delete;
+  ~Unpin() = default;
+
+  auto operator()() const -> void {
+    if (local != nullptr && --local->depth == 0) {
+      local->state.store(0, std::memory_order_release);
+    }
+  }
+};
+
+} // namespace exl::sync::impl
+
+namespace exl::sync {
+
+// Pin scope: shared objects read while it lives are not freed under the
+// reader. Pins nest.
+using Guard = Defer<impl::Unpin>;
+
+// Epoch based reclamation domain. Readers pin the domain around accesses to
+// a lock-free structure; writers unlink objects and retire() them. Retired
+// objects wait in per-thread limbo lists, sealed into batches stamped with
+// the global epoch, and are freed once every pinned thread has moved two
+// epochs past the stamp. Pinning threads try to advance the epoch every
+// PINS_PER_COLLECT pins, so no background thread is needed.
+//
+// A domain must outlive the pins and retires made through it. Threads that
+// used it may exit before or after it is destroyed.
+struct Epoch {
+  static constexpr u32 PINS_PER_COLLECT = 128;
+  static constexpr usize BATCH = 64;
+
+  alignas(CACHE_LINE) std::atomic<u64> global{};
+  std::mutex lock;
+  impl::Local *locals{};
+  std::vector<impl::Batch> orphans;
+
+  [[nodiscard]] auto epoch() const -> u64 {
+    return global.load(std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] auto pin() -> Guard {
+    auto *local = this->local();
+    if (local->depth++ == 0) {
+      const auto now = global.load(std::memory_order_relaxed);
+      // seq_cst orders the announcement before every read made under the
+      // pin, as seen by advancing threads.
+      local->state.store((now << 1) | 1, std::memory_order_seq_cst);
+      if (++local->pins == PINS_PER_COLLECT) [[unlikely]] {
+        local->pins = 0;
+        this->collect(*local);
+      }
+    }
+    return Guard(impl::Unpin(local));
+  }
+
+  // Hands `ptr` to `deleter` once no pinned thread can still see it. The
+  // object must already be unreachable for new readers.
+  auto retire(void *ptr, void (*deleter)(void *)) -> void {
+    auto *local = this->local();
+    local->limbo.push_back({ptr, deleter});
+    if (local->limbo.size() >= BATCH) [[unlikely]] {
+      this->seal(*local);
+      this->collect(*local);
+    }
+  }
+
+  template <typename T> auto retire(T *ptr) -> void {
+    this->retire(ptr, [](void *obj) { delete static_cast<T *>(obj); });
+  }
+
+  // Seals the thread's limbo list and frees everything already safe, for
+  // quiescent points and tests. Returns how many objects this thread still
+  // waits on.
+  auto flush() -> usize {
+    auto *local = this->local();
+    this->seal(*local);
+    this->collect(*local);
+    usize pending = 0;
+    for (const auto &batch : local->sealed) {
+      pending += batch.items.size();
+    }
+    return pending;
+  }
+
+  Epoch() = default;
+
+  Epoch(const Epoch &) = delete;
+  auto operator=(const Epoch &) -> Epoch & = delete;
+
+  ~Epoch() {
+    const auto guard = std::lock_guard(lock);
+    for (auto *local = locals; local != nullptr; local = local->next) {
+      for (auto &batch : local->sealed) {
+        impl::free_batch(batch);
+      }
+      auto last = impl::Batch{0, std::move(local->limbo)};
+      impl::free_batch(last);
+      local->sealed.clear();
+      local->domain = nullptr;
+    }
+    for (auto &batch : orphans) {
+      impl::free_batch(batch);
+    }
+  }
+
+  // Domain for code that does not need its own.
+  [[nodiscard]] static auto global_domain() -> Epoch & {
+    static auto *domain = new Epoch(); // NOLINT
+    return *domain;
+  }
+
+private:
+  friend impl::Locals;
+
+  [[nodiscard]] auto local() -> impl::Local * {
+    if (impl::LAST_DOMAIN == this && impl::LAST_LOCAL->domain == this)
+        [[likely]] {
+      return impl::LAST_LOCAL;
+    }
+    return this->attach();
+  }
+
+  [[gnu::noinline]] auto attach() -> impl::Local * {
+    thread_local impl::Locals locals_of_thread;
+    auto &list = locals_of_thread.list;
+    auto it = std::find_if(list.begin(), list.end(), [this](auto *local) {
+      return local->domain == this;
+    });
+    impl::Local *local = nullptr;
+    if (it != list.end()) {
+      local = *it;
+    } else {
+      // Reuses the slot of a destroyed domain if there is one.
+      it = std::find_if(list.begin(), list.end(),
+                        [](auto *slot) { return slot->domain == nullptr; });
+      if (it != list.end()) {
+        local = *it;
+        local->next = nullptr;
+        local->depth = 0;
+        local->pins = 0;
+      } else {
+        local = list.emplace_back(new impl::Local()); // NOLINT
+      }
+      local->domain = this;
+      const auto guard = std::lock_guard(lock);
+      local->next = locals;
+      locals = local;
+    }
+    impl::LAST_DOMAIN = this;
+    impl::LAST_LOCAL = local;
+    return local;
+  }
+
+  auto seal(impl::Local &local) -> void {
+    if (local.limbo.empty()) {
+      return;
+    }
+    // seq_cst keeps the stamp from being read before the objects in the
+    // batch were unlinked.
+    local.sealed.push_back(
+        {global.load(std::memory_order_seq_cst), std::move(local.limbo)});
+    local.limbo = {};
+  }
+
+  // Advances the global epoch if every pinned thread has seen the current
+  // one. Skips the round when another thread holds the lock.
+  auto try_advance() -> void {
+    const auto now = global.load(std::memory_order_relaxed);
+    auto lock_guard = std::unique_lock(lock, std::try_to_lock);
+    if (!lock_guard.owns_lock()) {
+      return;
+    }
+    for (auto *local = locals; local != nullptr; local = local->next) {
+      const auto state = local->state.load(std::memory_order_seq_cst);
+      if ((state & 1) != 0 && (state >> 1) != now) {
+        return;
+      }
+    }
+    // acq_rel chains the unpins seen above to whoever frees memory after
+    // reading the new epoch.
+    auto expected = now;
+    global.compare_exchange_strong(expected, now + 1,
+                                   std::memory_order_acq_rel,
+                                   std::memory_order_acquire);
+
+    // Batches left by exited threads are freed by whoever advances.
+    const auto safe = global.load(std::memory_order_acquire);
+    auto done = std::partition(orphans.begin(), orphans.end(),
+                               [safe](const impl::Batch &batch) {
+                                 return batch.epoch + 2 > safe;
+                               });
+    for (auto it = done; it != orphans.end(); ++it) {
+      impl::free_batch(*it);
+    }
+    orphans.erase(done, orphans.end());
+  }
+
+  auto collect(impl::Local &local) -> void {
+    this->try_advance();
+    const auto now = global.load(std::memory_order_acquire);
+    auto done = std::find_if(local.sealed.begin(), local.sealed.end(),
+                             [now](const impl::Batch &batch) {
+                               return batch.epoch + 2 > now;
+                             });
+    for (auto it = local.sealed.begin(); it != done; ++it) {
+      impl::free_batch(*it);
+    }
+    local.sealed.erase(local.sealed.begin(), done);
+  }
+
+  // Called at thread exit: the thread's garbage becomes the domain's.
+  auto detach(impl::Local *local) -> void {
+    this->seal(*local);
+    const auto guard = std::lock_guard(lock);
+    for (auto &batch : local->sealed) {
+      orphans.push_back(std::move(batch));
+    }
+    for (auto **link = &locals; *link != nullptr; link = &(*link)->next) {
+      if (*link == local) {
+        *link = local->next;
+        break;
+      }
+    }
+  }
+};
+
+} // namespace exl::sync
+
+namespace exl::sync::impl {
+
+inline Locals::~Locals() {
+  for (auto *local : list) {
+    if (local->domain != nullptr) {
+      local->domain->detach(local);
+    }
+    delete local; // NOLINT
+  }
+  LAST_DOMAIN = nullptr;
+  LAST_LOCAL = nullptr;
+}
+
+} // namespace exl::sync::impl
@@ -1,17 +1,107 @@
 #pragma once
 
+#include <exl/types.hpp>
+
 #include "fmt/core.h"
+#include <algorithm>
+#include <string_view>
 #include <type_traits>
 
 namespace exl::traits {
 
+// An error either names itself with a borrowed string or writes itself
+// straight into the formatter's output, so formatting never allocates.
 template <typename E>
-concept Error = requires(E err) {
-                  { err.description() } -> std::same_as<std::string>;
-                };
+concept Error = requires(const E err, char *out) {
+  { err.description() } -> std::convertible_to<std::string_view>;
+} || requires(const E err, char *out) {
+  { err.format_to(out) } -> std::same_as<char *>;
+};
 
 } // namespace exl::traits
 
+namespace exl {
+
+template <typename OutputIt>
+constexpr auto write_str(const std::string_view str, OutputIt out)
+    -> OutputIt {
+  return std::copy(str.begin(), str.end(), out);
+}
+
+template <typename E, typename OutputIt>
+auto format_error(const E &err, OutputIt out) -> OutputIt {
+  if constexpr (requires { err.format_to(out); }) {
+    return err.format_to(out);
+  } else if constexpr (requires { err.description(); }) {
+    return write_str(err.description(), out);
+  } else {
+    return fmt::format_to(out, "{}", err);
+  }
+}
+
+// An error plus the context frames attached to it on the way up. Frames are
+// borrowed and meant to be string literals; they live in a fixed inline ring
+// that keeps the N outermost, and frames dropped from the inner end are only
+// counted.
+template <typename E, usize N = 4> struct Context {
+  using Self = Context<E, N>;
+  using Err = E;
+
+  E error;
+  std::string_view frames[N]{}; // NOLINT
+  usize head{};
+  usize len{};
+  usize dropped{};
+
+  [[nodiscard]] constexpr auto with(const std::string_view msg) const -> Self {
+    auto ret = *this;
+    if (ret.len < N) {
+      ret.frames[(ret.head + ret.len++) % N] = msg;
+    } else {
+      ret.frames[ret.head] = msg;
+      ret.head = (ret.head + 1) % N;
+      ++ret.dropped;
+    }
+    return ret;
+  }
+
+  template <typename OutputIt>
+  auto format_to(OutputIt out) const -> OutputIt {
+    for (auto i = len; i > 0; --i) {
+      out = write_str(frames[(head + i - 1) % N], out);
+      out = write_str(": ", out);
+    }
+    if (dropped != 0) {
+      out = fmt::format_to(out, "(+{} frames): ", dropped);
+    }
+    return format_error(error, out);
+  }
+
+  [[nodiscard]] constexpr explicit Context(const E &_error) : error{_error} {}
+};
+
+} // namespace exl
+
+namespace exl::traits {
+
+template <typename E> struct is_context : std::false_type {};
+
+template <typename E, usize N>
+struct is_context<Context<E, N>> : std::true_type {};
+
+template <typename E>
+concept IsContext = is_context<E>::value;
+
+} // namespace exl::traits
+
+namespace exl {
+
+template <typename E>
+using ContextFor =
+    std::conditional_t<traits::IsContext<E>, E, Context<E>>;
+
+} // namespace exl
+
 template <exl::traits::Error E> struct fmt::formatter<E> {
   constexpr auto parse(fmt::format_parse_context &ctx)
       -> decltype(ctx.begin()) {
@@ -20,6 +110,6 @@ template <exl::traits::Error E> struct fmt::formatter<E> {
 
   template <typename FormatContext>
   auto format(const E &err, FormatContext &ctx) const -> decltype(ctx.out()) {
-    return fmt::format_to(ctx.out(), "{}", err.description());
+    return exl::format_error(err, ctx.out());
   }
 };
@@ -1,32 +1,165 @@
 #pragma once
 
 #include <exl/types.hpp>
+#include <fmt/compile.h>
 #include <fmt/core.h>
+#include <fmt/format.h>
 #include <fmt/ranges.h>
+
+#include <cstdio>
 #include <string>
+#include <type_traits>
+
+#include <unistd.h>
 
 namespace exl {
 
-template <typename T, typename... Args>
-inline auto print(const T format, const Args &...args) -> void {
-  fmt::print(format, args...);
+namespace traits {
+
+// FMT_COMPILE strings derive from fmt::compiled_string, which fmt 11
+// exports. Older releases keep it in detail, so only they reach in there.
+#if FMT_VERSION >= 110000
+template <typename S>
+concept CompiledFormat = std::is_base_of_v<fmt::compiled_string, S>;
+#else
+template <typename S>
+concept CompiledFormat = fmt::detail::is_compiled_string<S>::value;
+#endif
+
+} // namespace traits
+
+namespace impl {
+
+// Per-thread staging buffer for stdout. Writes are coalesced and handed to
+// stdio once PRINT_FLUSH_AT bytes are pending, on flush(), or at thread exit.
+// On a terminal every print goes straight to stdio, which line buffers it,
+// so interactive output keeps its order and survives a panic. Redirected
+// output trades that for throughput: a panic or abort loses what other
+// threads still hold, up to PRINT_FLUSH_AT bytes each, and their stdout may
+// land after stderr written meanwhile.
+struct PrintBuffer {
+  static constexpr usize PRINT_FLUSH_AT = 4096;
+
+  fmt::memory_buffer buf{};
+  std::FILE *file{};
+  usize flush_at{PRINT_FLUSH_AT};
+
+  auto flush() -> void {
+    if (buf.size() != 0) {
+      std::fwrite(buf.data(), 1, buf.size(), file);
+      buf.clear();
+    }
+  }
+
+  auto maybe_flush() -> void {
+    if (buf.size() >= flush_at) {
+      this->flush();
+    }
+  }
+
+  [[nodiscard]] explicit PrintBuffer(std::FILE *_file)
+      : file{_file},
+        flush_at{isatty(fileno(_file)) != 0 ? 1 : PRINT_FLUSH_AT} {}
+
+  PrintBuffer(const PrintBuffer &) = delete;
+  PrintBuffer(PrintBuffer &&) = delete;
+  auto operator=(const PrintBuffer &) -> PrintBuffer & = delete;
+  auto operator=(PrintBuffer &&) -> PrintBuffer & = delete;
+
+  ~PrintBuffer() {
+    this->flush();
+    std::fflush(file);
+  }
+};
+
+[[nodiscard]] inline auto stdout_buffer() -> PrintBuffer & {
+  thread_local PrintBuffer out(stdout);
+  return out;
+}
+
+template <typename S, typename... Args>
+inline auto format_into(fmt::memory_buffer &buf, const S &format,
+                        const Args &...args) -> void {
+  fmt::format_to(fmt::appender(buf), format, args...);
+}
+
+// stderr stays unbuffered: this thread's pending stdout goes first to keep
+// ordering, then the message and its newline leave in one write. Panics
+// print through here too, see PrintBuffer for what other threads keep.
+template <typename S, typename... Args>
+inline auto write_stderr(const bool newline, const S &format,
+                         const Args &...args) -> void {
+  stdout_buffer().flush();
+  std::fflush(stdout);
+
+  auto buf = fmt::memory_buffer();
+  format_into(buf, format, args...);
+  if (newline) {
+    buf.push_back('\n');
+  }
+  std::fwrite(buf.data(), 1, buf.size(), stderr);
+}
+
+} // namespace impl
+
+// Writes out whatever this thread has buffered for stdout.
+inline auto flush() -> void {
+  impl::stdout_buffer().flush();
+  std::fflush(stdout);
+}
+
+template <typename... Args>
+inline auto print(const fmt::format_string<const Args &...> format,
+                  const Args &...args) -> void {
+  auto &out = impl::stdout_buffer();
+  impl::format_into(out.buf, format, args...);
+  out.maybe_flush();
+}
+
+template <traits::CompiledFormat S, typename... Args>
+inline auto print(const S &format, const Args &...args) -> void {
+  auto &out = impl::stdout_buffer();
+  impl::format_into(out.buf, format, args...);
+  out.maybe_flush();
+}
+
+template <typename... Args>
+inline auto println(const fmt::format_string<const Args &...> format,
+                    const Args &...args) -> void {
+  auto &out = impl::stdout_buffer();
+  impl::format_into(out.buf, format, args...);
+  out.buf.push_back('\n');
+  out.maybe_flush();
+}
+
+template <traits::CompiledFormat S, typename... Args>
+inline auto println(const S &format, const Args &...args) -> void {
+  auto &out = impl::stdout_buffer();
+  impl::format_into(out.buf, format, args...);
+  out.buf.push_back('\n');
+  out.maybe_flush();
+}
+
+template <typename... Args>
+inline auto eprint(const fmt::format_string<const Args &...> format,
+                   const Args &...args) -> void {
+  impl::write_stderr(false, format, args...);
 }
 
-template <typename T, typename... Args>
-inline auto eprint(const T format, const Args &...args) -> void {
-  fmt::print(stderr, format, args...);
+template <traits::CompiledFormat S, typename... Args>
+inline auto eprint(const S &format, const Args &...args) -> void {
+  impl::write_stderr(false, format, args...);
 }
 
-template <typename T, typename... Args>
-inline auto println(const T format, const Args &...args) -> void {
-  fmt::print(format, args...);
-  std::putc('\n', stdout);
+template <typename... Args>
+inline auto eprintln(const fmt::format_string<const Args &...> format,
+                     const Args &...args) -> void {
+  impl::write_stderr(true, format, args...);
 }
 
-template <typename T, typename... Args>
-inline auto eprintln(const T format, const Args &...args) -> void {
-  fmt::print(stderr, format, args...);
-  std::putc('\n', stderr);
+template <traits::CompiledFormat S, typename... Args>
+inline auto eprintln(const S &format, const Args &...args) -> void {
+  impl::write_stderr(true, format, args...);
 }
 
 inline auto center(std::string &str, const usize pad, const char symbol = ' ')
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <exl/traceback.hpp>
+#include <exl/types.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace exl {
+
+template <typename Sig> struct FnRef;
+
+// Non-owning reference to any callable: an object pointer plus a thunk. The
+// callable must outlive the FnRef, which makes it a good fit for parameters.
+template <typename R, typename... Args> struct FnRef<R(Args...)> {
+  using Self = FnRef<R(Args...)>;
+  using Thunk = R (*)(void *, Args...);
+
+  void *obj{};
+  Thunk thunk{};
+
+  constexpr auto operator()(Args... args) const -> R {
+    return thunk(obj, std::forward<Args>(args)...);
+  }
+
+  template <typename TF>
+  requires(!std::is_same_v<std::remove_cvref_t<TF>, Self> &&
+           std::is_invocable_r_v<R, TF &, Args...>)
+  constexpr FnRef(TF &&fn) noexcept // NOLINT
+      : obj{const_cast<void *>(                                   // NOLINT
+            static_cast<const void *>(std::addressof(fn)))},
+        thunk{[](void *_obj, Args... args) -> R {
+          return std::invoke(
+              *static_cast<std::remove_reference_t<TF> *>(_obj),
+              std::forward<Args>(args)...);
+        }} {}
+
+  constexpr FnRef(R (*fn)(Args...)) noexcept // NOLINT
+      : obj{reinterpret_cast<void *>(fn)},   // NOLINT
+        thunk{[](void *_obj, Args... args) -> R {
+          return reinterpret_cast<R (*)(Args...)>(_obj)( // NOLINT
+              std::forward<Args>(args)...);
+        }} {}
+};
+
+template <typename Sig, usize N = 32> struct InplaceFn;
+
+// Owning, move-only callable that keeps its target in N bytes of inline
+// storage. Targets that do not fit are rejected at compile time, so it never
+// allocates.
+template <typename R, typename... Args, usize N>
+struct InplaceFn<R(Args...), N> {
+  using Self = InplaceFn<R(Args...), N>;
+
+  struct VTable {
+    R (*call)(void *, Args...);
+    void (*move)(void *, void *);
+    void (*destroy)(void *);
+  };
+
+  template <typename TF>
+  static constexpr VTable VTABLE_FOR = {
+      [](void *obj, Args... args) -> R {
+        return std::invoke(*std::launder(static_cast<TF *>(obj)),
+                           std::forward<Args>(args)...);
+      },
+      [](void *dst, void *src) {
+        auto *fn = std::launder(static_cast<TF *>(src));
+        new (dst) TF(std::move(*fn));
+        fn->~TF();
+      },
+      [](void *obj) { std::launder(static_cast<TF *>(obj))->~TF(); },
+  };
+
+  alignas(std::max_align_t) std::byte storage[N]{}; // NOLINT
+  const VTable *vtable{};
+
+  [[nodiscard]] constexpr auto is_empty() const -> bool {
+    return vtable == nullptr;
+  }
+
+  [[nodiscard]] constexpr explicit operator bool() const {
+    return !this->is_empty();
+  }
+
+  auto operator()(Args... args) -> R {
+    if (this->is_empty()) {
+      panic("Called an empty InplaceFn");
+    }
+    return vtable->call(storage, std::forward<Args>(args)...);
+  }
+
+  auto reset() -> void {
+    if (vtable != nullptr) {
+      vtable->destroy(storage);
+      vtable = nullptr;
+    }
+  }
+
+  [[nodiscard]] constexpr InplaceFn() = default;
+
+  template <typename TF>
+  requires(!std::is_same_v<std::remove_cvref_t<TF>, Self> &&
+           std::is_invocable_r_v<R, std::decay_t<TF> &, Args...>)
+  InplaceFn(TF &&fn) // NOLINT
+      : vtable{&VTABLE_FOR<std::decay_t<TF>>} {
+    using Fn = std::decay_t<TF>;
+    static_assert(sizeof(Fn) <= N, "Callable does not fit in InplaceFn");
+    static_assert(alignof(Fn) <= alignof(std::max_align_t),
+                  "Callable is over-aligned for InplaceFn");
+    static_assert(std::is_nothrow_move_constructible_v<Fn>,
+                  "InplaceFn requires a nothrow movable callable");
+    new (storage) Fn(std::forward<TF>(fn));
+  }
+
+  InplaceFn(const InplaceFn &) = delete;
+  auto operator=(const InplaceFn &) -> InplaceFn & = delete;
+
+  InplaceFn(InplaceFn &&other) noexcept : vtable{other.vtable} {
+    if (vtable != nullptr) {
+      vtable->move(storage, other.storage);
+      other.vtable = nullptr;
+    }
+  }
+
+  auto operator=(InplaceFn &&other) noexcept -> InplaceFn & {
+    if (this != &other) {
+      this->reset();
+      vtable = other.vtable;
+      if (vtable != nullptr) {
+        vtable->move(storage, other.storage);
+        other.vtable = nullptr;
+      }
+    }
+    return *this;
+  }
+
+  ~InplaceFn() { this->reset(); }
+};
+
+} // namespace exl
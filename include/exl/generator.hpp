@@ -0,0 +1,282 @@
+#pragma once
+
+#include <exl/iter.hpp>
+#include <exl/traceback.hpp>
+#include <exl/types.hpp>
+
+#include <coroutine>
+#include <iterator>
+#include <new>
+#include <ranges>
+#include <utility>
+
+namespace exl {
+
+namespace impl {
+
+// Per-thread cache of coroutine frames, bucketed by size class so that a
+// generator created in a loop reuses the frame of the one before it.
+struct FramePool {
+  static constexpr usize GRANULE = 64;
+  static constexpr usize NUM_CLASSES = 16;
+  static constexpr usize MAX_CACHED = 64;
+
+  struct Node {
+    Node *next;
+  };
+
+  Node *heads[NUM_CLASSES]{}; // NOLINT
+  usize counts[NUM_CLASSES]{}; // NOLINT
+
+  [[nodiscard]] static constexpr auto size_class(const usize size) -> usize {
+    return (size + GRANULE - 1) / GRANULE - 1;
+  }
+
+  [[nodiscard]] auto alloc(const usize size) -> void * {
+    const auto cls = size_class(size);
+    if (cls >= NUM_CLASSES) {
+      return ::operator new(size);
+    }
+
+    if (auto *node = heads[cls]; node != nullptr) {
+      heads[cls] = node->next;
+      --counts[cls];
+      return node;
+    }
+    return ::operator new((cls + 1) * GRANULE);
+  }
+
+  auto free(void *ptr, const usize size) -> void {
+    const auto cls = size_class(size);
+    if (cls >= NUM_CLASSES || counts[cls] >= MAX_CACHED) {
+      ::operator delete(ptr);
+      return;
+    }
+
+    auto *node = static_cast<Node *>(ptr);
+    node->next = heads[cls];
+    heads[cls] = node;
+    ++counts[cls];
+  }
+
+  [[nodiscard]] static auto local() -> FramePool & {
+    thread_local FramePool pool{};
+    return pool;
+  }
+
+  FramePool() = default;
+  FramePool(const FramePool &) = delete;
+  FramePool(FramePool &&) = delete;
+  auto operator=(const FramePool &) -> FramePool & = delete;
+  auto operator=(FramePool &&) -> FramePool & = delete;
+
+  ~FramePool() {
+    for (auto *head : heads) {
+      while (head != nullptr) {
+        auto *next = head->next;
+        ::operator delete(head);
+        head = next;
+      }
+    }
+  }
+};
+
+} // namespace impl
+
+template <typename T> struct Generator;
+
+template <typename T> struct GeneratorIter;
+
+template <typename T> struct GeneratorPromise {
+  using Self = GeneratorPromise<T>;
+  using Handle = std::coroutine_handle<Self>;
+  using Val = std::remove_cvref_t<T>;
+  using Ptr = const Val *;
+  using Ref = const Val &;
+
+  Ptr value{};
+  Handle root{};
+  Handle leaf{};
+  Handle parent{};
+
+  struct YieldFrom {
+    Generator<T> gen;
+
+    [[nodiscard]] constexpr auto await_ready() const noexcept -> bool {
+      return !gen.handle;
+    }
+
+    auto await_suspend(Handle caller) noexcept -> std::coroutine_handle<> {
+      auto &nested = gen.handle.promise();
+      auto root = caller.promise().root;
+
+      nested.parent = caller;
+      nested.root = root;
+      root.promise().leaf = gen.handle;
+      return gen.handle;
+    }
+
+    constexpr auto await_resume() const noexcept -> void {}
+  };
+
+  struct FinalAwaiter {
+    [[nodiscard]] constexpr auto await_ready() const noexcept -> bool {
+      return false;
+    }
+
+    auto await_suspend(Handle self) noexcept -> std::coroutine_handle<> {
+      auto &promise = self.promise();
+      if (promise.parent) {
+        promise.root.promise().leaf = promise.parent;
+        return promise.parent;
+      }
+      return std::noop_coroutine();
+    }
+
+    constexpr auto await_resume() const noexcept -> void {}
+  };
+
+  [[nodiscard]] auto get_return_object() noexcept -> Generator<T> {
+    auto handle = Handle::from_promise(*this);
+    root = handle;
+    leaf = handle;
+    return Generator<T>(handle);
+  }
+
+  [[nodiscard]] constexpr auto initial_suspend() const noexcept
+      -> std::suspend_always {
+    return {};
+  }
+
+  [[nodiscard]] constexpr auto final_suspend() const noexcept -> FinalAwaiter {
+    return {};
+  }
+
+  auto yield_value(Ref val) noexcept -> std::suspend_always {
+    value = std::addressof(val);
+    return {};
+  }
+
+  auto yield_value(Generator<T> &&nested) noexcept -> YieldFrom {
+    return YieldFrom{std::move(nested)};
+  }
+
+  constexpr auto return_void() const noexcept -> void {}
+
+  auto unhandled_exception() -> void {
+    panic("Unhandled exception in Generator");
+  }
+
+  // Frames come from the thread-local pool instead of the global heap.
+  [[nodiscard]] static auto operator new(const usize size) -> void * {
+    return impl::FramePool::local().alloc(size);
+  }
+
+  static auto operator delete(void *ptr, const usize size) -> void {
+    impl::FramePool::local().free(ptr, size);
+  }
+
+  template <typename U> auto await_transform(U &&) = delete;
+};
+
+template <typename T> struct GeneratorIter {
+  using Self = GeneratorIter<T>;
+  using Handle = typename GeneratorPromise<T>::Handle;
+  using Val = typename GeneratorPromise<T>::Val;
+  using Ptr = typename GeneratorPromise<T>::Ptr;
+  using Ref = typename GeneratorPromise<T>::Ref;
+
+  using value_type = Val;
+  using difference_type = ssize;
+  using pointer = Ptr;
+  using reference = Ref;
+  using iterator_concept = std::input_iterator_tag;
+
+  Handle root{};
+
+  [[nodiscard]] auto as_ptr() const -> Ptr {
+    return root.promise().leaf.promise().value;
+  }
+  [[nodiscard]] auto as_ref() const -> Ref { return *this->as_ptr(); }
+
+  auto next() -> void { root.promise().leaf.resume(); }
+
+  [[nodiscard]] auto is_done() const -> bool { return !root || root.done(); }
+
+  [[nodiscard]] auto operator*() const -> Ref { return this->as_ref(); }
+  [[nodiscard]] auto operator->() const -> Ptr { return this->as_ptr(); }
+
+  auto operator++() -> Self & {
+    this->next();
+    return *this;
+  }
+  auto operator++(int) -> void { this->next(); }
+
+  [[nodiscard]] friend auto operator==(const Self &it,
+                                       std::default_sentinel_t /*unused*/)
+      -> bool {
+    return it.is_done();
+  }
+
+  [[nodiscard]] constexpr GeneratorIter() = default;
+  [[nodiscard]] constexpr explicit GeneratorIter(const Handle _root)
+      : root{_root} {}
+};
+
+template <typename T> struct Generator : std::ranges::view_base {
+  using Self = Generator<T>;
+  using promise_type = GeneratorPromise<T>;
+  using Handle = typename promise_type::Handle;
+
+  using It = GeneratorIter<T>;
+
+  Handle handle{};
+
+  [[nodiscard]] auto begin() -> It {
+    if (handle) {
+      handle.resume();
+    }
+    return It(handle);
+  }
+
+  [[nodiscard]] constexpr auto end() const noexcept
+      -> std::default_sentinel_t {
+    return std::default_sentinel;
+  }
+
+  [[nodiscard]] constexpr Generator() = default;
+  [[nodiscard]] constexpr explicit Generator(const Handle _handle)
+      : handle{_handle} {}
+
+  Generator(const Generator &) = delete;
+  auto operator=(const Generator &) -> Generator & = delete;
+
+  [[nodiscard]] constexpr Generator(Generator &&other) noexcept
+      : handle{std::exchange(other.handle, {})} {}
+
+  auto operator=(Generator &&other) noexcept -> Generator & {
+    if (this != &other) {
+      if (handle) {
+        handle.destroy();
+      }
+      handle = std::exchange(other.handle, {});
+    }
+    return *this;
+  }
+
+  ~Generator() {
+    if (handle) {
+      handle.destroy();
+    }
+  }
+};
+
+template <traits::Range R>
+auto generate(R range)
+    -> Generator<std::remove_cvref_t<decltype(*range.begin())>> {
+  for (auto &&elem : range) {
+    co_yield elem;
+  }
+}
+
+} // namespace exl
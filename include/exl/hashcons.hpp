@@ -0,0 +1,244 @@
+#pragma once
+
+#include <exl/pattern.hpp>
+#include <exl/reflection.hpp>
+#include <exl/types.hpp>
+
+#include <span>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace exl::impl {
+
+template <typename N> struct ConsEntry {
+  u64 hash;
+  u32 id;
+  u32 stamp; // generation of the last intern that produced this node
+  u32 mark;  // last collection that reached it
+  N node;
+};
+
+} // namespace exl::impl
+
+namespace exl {
+
+// Weak handle to a node interned in a HashCons: a single pointer, so it is
+// trivially copyable and visible to reflection::visit_members. Structurally
+// equal nodes of one table are the same node, so equality is a pointer
+// compare.
+template <typename N> struct Interned {
+  using Self = Interned<N>;
+
+  impl::ConsEntry<N> *entry{};
+
+  [[nodiscard]] auto operator*() const -> const N & { return entry->node; }
+
+  [[nodiscard]] auto operator->() const -> const N * { return &entry->node; }
+
+  // Unique among the nodes a table ever interned; never reused.
+  [[nodiscard]] auto id() const -> u32 { return entry->id; }
+
+  [[nodiscard]] friend auto operator==(const Self &lhs, const Self &rhs)
+      -> bool {
+    return lhs.entry == rhs.entry;
+  }
+};
+
+} // namespace exl
+
+namespace exl::traits {
+
+template <typename T> struct IsInterned : std::false_type {};
+
+template <typename N> struct IsInterned<Interned<N>> : std::true_type {};
+
+} // namespace exl::traits
+
+namespace exl {
+
+// Interning table for recursive Union trees. N is a node type in the shape
+// match_recursively walks, a struct with a `_data` Union. Its alternatives
+// are flat aggregates that refer to children through Interned<N> fields.
+// Nodes are interned bottom up, so identical subtrees share one node and
+// comparing children in the structural hash and equality is O(1).
+//
+// Handles do not keep nodes alive. collect(roots) is a generational sweep:
+// nodes reachable from `roots` survive, and so do nodes interned since the
+// previous collect, with everything they reach. The rest is freed and its
+// handles dangle.
+//
+// Not thread-safe.
+template <typename N> struct HashCons {
+  using Entry = impl::ConsEntry<N>;
+  using Ref = Interned<N>;
+
+  // Lookup key for a node that is not interned yet.
+  struct Probe {
+    u64 hash;
+    const N *node;
+  };
+
+  struct EntryHash {
+    using is_transparent = void;
+
+    [[nodiscard]] auto operator()(const Entry *entry) const -> usize {
+      return entry->hash;
+    }
+    [[nodiscard]] auto operator()(const Probe &probe) const -> usize {
+      return probe.hash;
+    }
+  };
+
+  struct EntryEq {
+    using is_transparent = void;
+
+    [[nodiscard]] auto operator()(const Entry *lhs, const Entry *rhs) const
+        -> bool {
+      return lhs == rhs;
+    }
+    [[nodiscard]] auto operator()(const Probe &lhs, const Entry *rhs) const
+        -> bool {
+      return lhs.hash == rhs->hash && equal_nodes(*lhs.node, rhs->node);
+    }
+    [[nodiscard]] auto operator()(const Entry *lhs, const Probe &rhs) const
+        -> bool {
+      return (*this)(rhs, lhs);
+    }
+  };
+
+  std::unordered_set<Entry *, EntryHash, EntryEq> entries;
+  u32 next_id{};
+  u32 generation{1};
+  usize hits{};
+
+  HashCons() = default;
+
+  HashCons(const HashCons &) = delete;
+  auto operator=(const HashCons &) -> HashCons & = delete;
+
+  ~HashCons() {
+    for (auto *entry : entries) {
+      delete entry; // NOLINT
+    }
+  }
+
+  [[nodiscard]] auto size() const -> usize { return entries.size(); }
+
+  [[nodiscard]] auto intern(N node) -> Ref {
+    const auto hash = hash_node(node);
+    const auto probe = Probe{hash, &node};
+    if (const auto it = entries.find(probe); it != entries.end()) {
+      ++hits;
+      (*it)->stamp = generation;
+      return {*it};
+    }
+    auto *entry = new Entry{hash, next_id++, generation, 0, // NOLINT
+                            std::move(node)};
+    entries.insert(entry);
+    return {entry};
+  }
+
+  template <typename Alt> [[nodiscard]] auto make(Alt alt) -> Ref {
+    return this->intern(N{std::move(alt)});
+  }
+
+  // Frees what neither `roots` nor this generation's nodes reach and
+  // returns how many nodes were freed.
+  auto collect(const std::span<const Ref> roots) -> usize {
+    auto stack = std::vector<Entry *>();
+    const auto reach = [this, &stack](Entry *entry) {
+      if (entry->mark != generation) {
+        entry->mark = generation;
+        stack.push_back(entry);
+      }
+    };
+    for (const auto &root : roots) {
+      reach(root.entry);
+    }
+    for (auto *entry : entries) {
+      if (entry->stamp == generation) {
+        reach(entry);
+      }
+    }
+    while (!stack.empty()) {
+      auto *entry = stack.back();
+      stack.pop_back();
+      std::visit(
+          [&reach](const auto &alt) {
+            reflection::visit_members(alt, [&reach](const auto &...fields) {
+              (reach_field(fields, reach), ...);
+            });
+          },
+          entry->node._data);
+    }
+
+    usize freed = 0;
+    for (auto it = entries.begin(); it != entries.end();) {
+      if ((*it)->mark == generation) {
+        ++it;
+        continue;
+      }
+      delete *it; // NOLINT
+      it = entries.erase(it);
+      ++freed;
+    }
+    ++generation;
+    return freed;
+  }
+
+  [[nodiscard]] static auto hash_node(const N &node) -> u64 {
+    const auto tag = static_cast<u64>(node._data.index());
+    return std::visit(
+        [tag](const auto &alt) {
+          return (reflection::hash_members(alt) ^ tag) * 0x9e3779b97f4a7c15ULL;
+        },
+        node._data);
+  }
+
+  [[nodiscard]] static auto equal_nodes(const N &lhs, const N &rhs) -> bool {
+    return std::visit(
+        [&rhs](const auto &alt) {
+          using Alt = std::remove_cvref_t<decltype(alt)>;
+          const auto *other = std::get_if<Alt>(&rhs._data);
+          return other != nullptr && reflection::equal_members(alt, *other);
+        },
+        lhs._data);
+  }
+
+private:
+  template <typename T, typename TF>
+  static auto reach_field(const T &field, TF &reach) -> void {
+    if constexpr (traits::IsInterned<T>::value) {
+      reach(field.entry);
+    }
+  }
+};
+
+// match_recursively for interned trees that evaluates every distinct node
+// once. The handlers take `recurse` and an alternative, as with
+// match_recursively, but recurse on Interned<N> children rather than nodes.
+template <typename TReturn, typename N>
+auto match_shared(const Interned<N> &root) -> decltype(auto) {
+  return [&root](auto &&...fs) -> TReturn {
+    auto memo = std::unordered_map<u32, TReturn>();
+    auto handlers = overload(std::forward<decltype(fs)>(fs)...);
+    auto visitor = ycombinator(
+        [&memo, &handlers](auto self, const Interned<N> &node) -> TReturn {
+          if (const auto it = memo.find(node.id()); it != memo.end()) {
+            return it->second;
+          }
+          auto out = std::visit(
+              [&](const auto &alt) -> TReturn { return handlers(self, alt); },
+              node->_data);
+          memo.emplace(node.id(), out);
+          return out;
+        });
+    return visitor(root);
+  };
+}
+
+} // namespace exl
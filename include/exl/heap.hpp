@@ -0,0 +1,430 @@
+#pragma once
+
+#include <exl/mem.hpp>
+#include <exl/types.hpp>
+#include <exl/vmem.hpp>
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#include <sys/mman.h>
+
+namespace exl::mem::impl {
+
+// Small sizes step by 16 bytes, then the step grows with the size, keeping
+// internal waste under 50% and usually under 12%. Blocks past the last
+// class are mapped directly, like glibc's default mmap threshold.
+inline constexpr std::array<u32, 36> CLASS_SIZES = {
+    16,    32,    48,    64,    80,    96,     112,    128,    256,
+    384,   512,   640,   768,   896,   1024,   2048,   3072,   4096,
+    5120,  6144,  7168,  8192,  12288, 16384,  20480,  24576,  28672,
+    32768, 40960, 49152, 57344, 65536, 81920, 98304, 114688, 131072};
+
+inline constexpr usize CLASSES = CLASS_SIZES.size();
+inline constexpr usize MAX_SMALL = CLASS_SIZES.back();
+inline constexpr u32 LARGE = CLASSES;
+
+// Small objects are carved out of SLAB aligned slabs, large ones get a
+// mapping of their own with the same layout, so the header of any block is
+// found by masking its address.
+inline constexpr usize SLAB = usize{1} << 20;
+inline constexpr usize SLAB_HEADER = CACHE_LINE;
+inline constexpr usize SLABS_PER_CHUNK = 16;
+
+struct SlabHeader {
+  u32 size_class;
+  usize bytes;
+};
+
+[[nodiscard]] constexpr auto size_class(const usize size) -> u32 {
+  if (size <= 128) {
+    return size == 0 ? 0 : static_cast<u32>((size - 1) / 16);
+  }
+  if (size <= 1024) {
+    return static_cast<u32>(8 + (size - 129) / 128);
+  }
+  if (size <= 8192) {
+    return static_cast<u32>(15 + (size - 1025) / 1024);
+  }
+  if (size <= 32768) {
+    return static_cast<u32>(22 + (size - 8193) / 4096);
+  }
+  if (size <= 65536) {
+    return static_cast<u32>(28 + (size - 32769) / 8192);
+  }
+  return static_cast<u32>(32 + (size - 65537) / 16384);
+}
+
+// Objects moved between a thread cache and the depot at once.
+[[nodiscard]] constexpr auto batch_size(const u32 cls) -> u32 {
+  return std::clamp<u32>((u32{64} << 10) / CLASS_SIZES[cls], 2, 64);
+}
+
+static_assert(size_class(MAX_SMALL) == CLASSES - 1);
+
+[[nodiscard]] inline auto header_of(const void *ptr) -> SlabHeader * {
+  return ptr::offset<SlabHeader>(reinterpret_cast<usize>(ptr) & // NOLINT
+                                 ~(SLAB - 1));
+}
+
+// Distance of `ptr` past the start of its block, non-zero only for
+// over-aligned allocations.
+[[nodiscard]] inline auto offset_in_block(const void *ptr,
+                                          const SlabHeader *header) -> u32 {
+  const auto offset = static_cast<u32>(
+      ptr::diff(ptr::cast<u8>(ptr), ptr::cast<u8>(header)) - SLAB_HEADER);
+  return offset % CLASS_SIZES[header->size_class];
+}
+
+// A free object. A batch is a list of them linked through `next`; its head
+// also carries the link to the next batch in the depot, with the batch
+// length in the top 16 bits.
+struct FreeNode {
+  FreeNode *next;
+  u64 link;
+};
+
+inline constexpr u64 PTR_MASK = (u64{1} << 48) - 1;
+
+[[nodiscard]] inline auto pack(const FreeNode *node, const u64 high) -> u64 {
+  return reinterpret_cast<u64>(node) | (high << 48); // NOLINT
+}
+
+[[nodiscard]] inline auto unpack(const u64 word) -> FreeNode * {
+  return ptr::offset<FreeNode>(word & PTR_MASK);
+}
+
+// Central store of free batches for one size class, a stack under a lock
+// like tcmalloc's transfer cache. Only whole batches pass through, so the
+// lock is taken once per batch_size() objects. A lock-free stack would
+// have to read the link of a head another thread may just have popped and
+// started writing, and to tag its top against ABA.
+struct alignas(CACHE_LINE) Depot {
+  std::mutex lock;
+  FreeNode *top{};
+  std::mutex grow;
+  u8 *cur{};
+  u8 *end{};
+
+  auto push(FreeNode *head, const u64 count) -> void {
+    const auto guard = std::lock_guard(lock);
+    head->link = pack(top, count);
+    top = head;
+  }
+
+  [[nodiscard]] auto pop(u32 &count) -> FreeNode * {
+    const auto guard = std::lock_guard(lock);
+    auto *head = top;
+    if (head == nullptr) {
+      return nullptr;
+    }
+    top = unpack(head->link);
+    count = static_cast<u32>(head->link >> 48);
+    return head;
+  }
+};
+
+struct SlabSource {
+  std::mutex lock;
+  u8 *cur{};
+  u8 *end{};
+
+  // Hands out slabs from chunks of SLABS_PER_CHUNK, so mapping cost and the
+  // number of mappings stay low.
+  [[nodiscard]] auto take() -> u8 * {
+    const auto guard = std::lock_guard(lock);
+    if (cur == end) {
+      cur = map_aligned(SLAB * SLABS_PER_CHUNK, SLAB, PROT_READ | PROT_WRITE);
+      if (cur == nullptr) {
+        end = nullptr;
+        return nullptr;
+      }
+      end = cur + SLAB * SLABS_PER_CHUNK;
+    }
+    return std::exchange(cur, cur + SLAB);
+  }
+};
+
+struct Central {
+  std::array<Depot, CLASSES> depots;
+  SlabSource slabs;
+};
+
+// Zero initialised and trivially destructible, so a thread_local costs no
+// guard on the fast path.
+struct ThreadCache {
+  struct List {
+    FreeNode *head;
+    u32 count;
+  };
+
+  std::array<List, CLASSES> lists;
+  bool registered;
+  bool dead;
+};
+
+// NOLINTBEGIN
+inline constinit Central CENTRAL{};
+inline constinit thread_local ThreadCache CACHE{};
+// NOLINTEND
+
+} // namespace exl::mem::impl
+
+namespace exl::mem {
+
+// Size-class allocator in the style of tcmalloc. Each thread keeps a free
+// list per class and trades whole batches with a lock-free central depot,
+// so the common alloc and free touch no shared cache line. A block may be
+// freed by any thread: it joins that thread's cache, and overflowing
+// caches hand batches back to the depot for the other threads. Blocks over
+// MAX_SMALL bytes are mapped directly.
+struct Heap {
+  [[nodiscard]] static auto alloc(const usize size) -> void * {
+    if (size > impl::MAX_SMALL) [[unlikely]] {
+      return alloc_large(size, impl::SLAB_HEADER);
+    }
+    const auto cls = impl::size_class(size);
+    auto &list = impl::CACHE.lists[cls];
+    if (list.head == nullptr) [[unlikely]] {
+      return refill(cls);
+    }
+    auto *node = list.head;
+    list.head = node->next;
+    --list.count;
+    return node;
+  }
+
+  // Blocks sit a whole number of class sizes past a cache line aligned slab
+  // header, so rounding the size up to a multiple of the alignment covers
+  // alignments up to a cache line. Past that, the block is padded by the
+  // alignment and an aligned address inside it handed out.
+  [[nodiscard]] static auto alloc(const usize size, const usize align)
+      -> void * {
+    if (align <= 16) {
+      return alloc(size);
+    }
+    if (align <= impl::SLAB_HEADER) {
+      return alloc(round_up(std::max(size, align), align));
+    }
+    if (size + align - 16 > impl::MAX_SMALL) {
+      return alloc_large(size, align);
+    }
+    auto *block = alloc(size + align - 16);
+    if (block == nullptr) {
+      return nullptr;
+    }
+    return ptr::offset<void>(
+        round_up(reinterpret_cast<usize>(block), align)); // NOLINT
+  }
+
+  static auto free(void *ptr) -> void {
+    if (ptr == nullptr) {
+      return;
+    }
+    const auto *header = impl::header_of(ptr);
+    if (header->size_class == impl::LARGE) [[unlikely]] {
+      munmap(impl::header_of(ptr), header->bytes);
+      return;
+    }
+    release(ptr::sub(ptr::cast<u8>(ptr), impl::offset_in_block(ptr, header)),
+            header->size_class);
+  }
+
+  // Skips the header lookup when the caller knows the size it asked for.
+  static auto free(void *ptr, const usize size) -> void {
+    if (ptr == nullptr) {
+      return;
+    }
+    if (size > impl::MAX_SMALL) [[unlikely]] {
+      free(ptr);
+      return;
+    }
+    release(ptr, impl::size_class(size));
+  }
+
+  static auto free(void *ptr, const usize size, const usize align) -> void {
+    if (align <= 16) {
+      free(ptr, size);
+    } else if (align <= impl::SLAB_HEADER) {
+      free(ptr, round_up(std::max(size, align), align));
+    } else {
+      free(ptr);
+    }
+  }
+
+  // Usable size from `ptr` to the end of its block, at least what was asked
+  // for.
+  [[nodiscard]] static auto size_of(const void *ptr) -> usize {
+    const auto *header = impl::header_of(ptr);
+    if (header->size_class == impl::LARGE) {
+      return header->bytes - (ptr::diff(ptr::cast<u8>(ptr),
+                                        ptr::cast<u8>(header)));
+    }
+    return impl::CLASS_SIZES[header->size_class] -
+           impl::offset_in_block(ptr, header);
+  }
+
+private:
+  static auto release(void *ptr, const u32 cls) -> void {
+    auto &cache = impl::CACHE;
+    auto *node = static_cast<impl::FreeNode *>(ptr);
+    if (cache.dead) [[unlikely]] {
+      node->next = nullptr;
+      impl::CENTRAL.depots[cls].push(node, 1);
+      return;
+    }
+    if (!cache.registered) [[unlikely]] {
+      attach();
+    }
+    auto &list = cache.lists[cls];
+    node->next = list.head;
+    list.head = node;
+    if (++list.count >= 2 * impl::batch_size(cls)) [[unlikely]] {
+      flush(list, cls, impl::batch_size(cls));
+    }
+  }
+
+  // Returns the first `count` objects of the list to the depot as a batch.
+  static auto flush(impl::ThreadCache::List &list, const u32 cls,
+                    const u32 count) -> void {
+    auto *head = list.head;
+    auto *last = head;
+    for (u32 i = 1; i < count; ++i) {
+      last = last->next;
+    }
+    list.head = last->next;
+    list.count -= count;
+    last->next = nullptr;
+    impl::CENTRAL.depots[cls].push(head, count);
+  }
+
+  // Flushes the thread's cache to the depot when the thread exits. Later
+  // frees on the thread, from other thread_local destructors, go straight
+  // to the depot.
+  struct CacheGuard {
+    CacheGuard() = default;
+    CacheGuard(const CacheGuard &) = delete;
+    auto operator=(const CacheGuard &) -> CacheGuard & = delete;
+
+    ~CacheGuard() {
+      auto &cache = impl::CACHE;
+      for (u32 cls = 0; cls < impl::CLASSES; ++cls) {
+        auto &list = cache.lists[cls];
+        if (list.count > 0) {
+          flush(list, cls, list.count);
+        }
+      }
+      cache.dead = true;
+    }
+  };
+
+  // Registers the exit flush on the thread's first alloc or free, whichever
+  // comes first: a thread that only frees still fills its cache.
+  [[gnu::noinline]] static auto attach() -> void {
+    auto &cache = impl::CACHE;
+    if (!cache.registered && !cache.dead) {
+      cache.registered = true;
+      static thread_local CacheGuard guard;
+    }
+  }
+
+  [[gnu::noinline]] static auto refill(const u32 cls) -> void * {
+    auto &cache = impl::CACHE;
+    attach();
+
+    auto &depot = impl::CENTRAL.depots[cls];
+    u32 count = 0;
+    auto *batch = depot.pop(count);
+    if (batch == nullptr) {
+      batch = carve(depot, cls, count);
+      if (batch == nullptr) {
+        return nullptr;
+      }
+    }
+
+    if (cache.dead) [[unlikely]] {
+      if (count > 1) {
+        depot.push(batch->next, count - 1);
+      }
+      return batch;
+    }
+    auto &list = cache.lists[cls];
+    list.head = batch->next;
+    list.count = count - 1;
+    return batch;
+  }
+
+  // Cuts a fresh batch from the class's current slab, taking new slabs as
+  // needed.
+  [[nodiscard]] static auto carve(impl::Depot &depot, const u32 cls,
+                                  u32 &count) -> impl::FreeNode * {
+    const auto size = impl::CLASS_SIZES[cls];
+    const auto guard = std::lock_guard(depot.grow);
+    impl::FreeNode *head = nullptr;
+    for (count = 0; count < impl::batch_size(cls); ++count) {
+      if (depot.cur + size > depot.end) {
+        auto *slab = impl::CENTRAL.slabs.take();
+        if (slab == nullptr) {
+          break;
+        }
+        new (slab) impl::SlabHeader{cls, impl::SLAB};
+        depot.cur = slab + impl::SLAB_HEADER;
+        depot.end = slab + impl::SLAB;
+      }
+      auto *node = ptr::cast<impl::FreeNode>(depot.cur);
+      node->next = head;
+      head = node;
+      depot.cur += size;
+    }
+    return head;
+  }
+
+  [[nodiscard]] static auto alloc_large(const usize size, const usize align)
+      -> void * {
+    const auto offset = std::max(align, impl::SLAB_HEADER);
+    if (offset >= impl::SLAB) {
+      return nullptr;
+    }
+    const auto bytes = round_up(size + offset, PAGE);
+    auto *base = impl::map_aligned(bytes, impl::SLAB, PROT_READ | PROT_WRITE);
+    if (base == nullptr) {
+      return nullptr;
+    }
+    new (base) impl::SlabHeader{impl::LARGE, bytes};
+    return base + offset;
+  }
+};
+
+// Standard allocator over Heap, for std and exl containers.
+template <typename T> struct HeapAllocator {
+  using value_type = T;
+
+  [[nodiscard]] auto allocate(const usize len) -> T * {
+    auto *ret = Heap::alloc(len * sizeof(T), alignof(T));
+    if (ret == nullptr) {
+      throw std::bad_alloc();
+    }
+    return static_cast<T *>(ret);
+  }
+
+  auto deallocate(T *ptr, const usize len) -> void {
+    Heap::free(ptr, len * sizeof(T), alignof(T));
+  }
+
+  [[nodiscard]] constexpr HeapAllocator() = default;
+
+  template <typename U>
+  [[nodiscard]] constexpr HeapAllocator( // NOLINT
+      const HeapAllocator<U> & /*other*/) {}
+
+  [[nodiscard]] friend constexpr auto operator==(const HeapAllocator &,
+                                                 const HeapAllocator &)
+      -> bool {
+    return true;
+  }
+};
+
+} // namespace exl::mem
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <exl/check.hpp>
 #include <exl/option.hpp>
 
+#include <compare>
+#include <iterator>
+#include <ranges>
+#include <utility>
+
 namespace exl::traits {
 
 template <typename T>
@@ -14,23 +20,34 @@ concept Range = requires(T ptr) {
 
 namespace exl {
 
-template <typename T> struct Iter {
-  using Self = Iter<T>;
+// Iterators carry no bounds, so their check policy only guards dereferencing
+// a null iterator. Slice hands out Unchecked iterators since begin/end bound
+// them already.
+template <typename T, traits::CheckPolicy P = check::Unchecked> struct Iter {
+  using Self = Iter<T, P>;
   using Val = T;
   using Ptr = T *;
   using Ref = T &;
 
-  using value_type = Val;
+  using value_type = std::remove_cv_t<Val>;
   using difference_type = ssize;
   using pointer = Ptr;
   using reference = Ref;
+  using iterator_category = std::random_access_iterator_tag;
+  using iterator_concept = std::contiguous_iterator_tag;
 
-  Ptr ptr;
+  Ptr ptr{};
 
-  [[nodiscard]] constexpr auto as_ptr(const usize offset = 0) const -> Ptr {
+  // Offsets are signed like difference_type, so it[-1] steps back.
+  [[nodiscard]] constexpr auto as_ptr(const ssize offset = 0) const -> Ptr {
     return ptr + offset;
   }
-  [[nodiscard]] constexpr auto as_ref(const usize offset = 0) const -> Ref {
+  [[nodiscard]] constexpr auto as_ref(const ssize offset = 0) const -> Ref {
+    if constexpr (P::enabled) {
+      if (ptr == nullptr) [[unlikely]] {
+        impl::panic_null();
+      }
+    }
     return *this->as_ptr(offset);
   }
 
@@ -45,11 +62,63 @@ template <typename T> struct Iter {
   [[nodiscard]] constexpr auto operator->() const -> Ptr {
     return this->as_ptr();
   }
-  constexpr auto operator++() -> void { this->next(); }
-  constexpr auto operator--() -> void { this->pref(); }
+  [[nodiscard]] constexpr auto operator[](const ssize offset) const -> Ref {
+    return this->as_ref(offset);
+  }
+
+  constexpr auto operator++() -> Self & {
+    this->next();
+    return *this;
+  }
+  constexpr auto operator--() -> Self & {
+    this->prev();
+    return *this;
+  }
+  constexpr auto operator++(int) -> Self {
+    auto ret = *this;
+    this->next();
+    return ret;
+  }
+  constexpr auto operator--(int) -> Self {
+    auto ret = *this;
+    this->prev();
+    return ret;
+  }
+
+  constexpr auto operator+=(const ssize offset) -> Self & {
+    ptr += offset;
+    return *this;
+  }
+  constexpr auto operator-=(const ssize offset) -> Self & {
+    ptr -= offset;
+    return *this;
+  }
 
+  [[nodiscard]] friend constexpr auto operator+(Self it, const ssize offset)
+      -> Self {
+    return it += offset;
+  }
+  [[nodiscard]] friend constexpr auto operator+(const ssize offset, Self it)
+      -> Self {
+    return it += offset;
+  }
+  [[nodiscard]] friend constexpr auto operator-(Self it, const ssize offset)
+      -> Self {
+    return it -= offset;
+  }
+  [[nodiscard]] friend constexpr auto operator-(const Self &rhs,
+                                                const Self &lhs) -> ssize {
+    return rhs.ptr - lhs.ptr;
+  }
+
+  [[nodiscard]] constexpr Iter() = default;
   [[nodiscard]] constexpr explicit Iter(const Ptr _ptr) : ptr{_ptr} {}
 
+  template <typename U, traits::CheckPolicy Q>
+  requires std::is_convertible_v<U *, Ptr>
+  [[nodiscard]] constexpr Iter(const Iter<U, Q> &other) // NOLINT
+      : ptr{other.ptr} {}
+
   [[nodiscard]] static constexpr inline auto from_unchecked(const Ptr _ptr)
       -> Self {
     return Iter(_ptr);
@@ -64,68 +133,95 @@ template <typename T> struct Iter {
   }
 };
 
-template <typename T> struct CIter {
-  using Self = CIter<T>;
-  using Val = T;
-  using Ptr = T *;
-  using Ref = T &;
+template <typename T, traits::CheckPolicy P = check::Unchecked>
+using CIter = Iter<const T, P>;
+
+// Counts an index from zero and derives the value from it, so a loop over a
+// Range has the same trip count shape as `for (i = 0; i < len; ++i)`.
+struct RangeIter {
+  using Self = RangeIter;
 
-  using value_type = Val;
+  using value_type = ssize;
   using difference_type = ssize;
-  using pointer = Ptr;
-  using reference = Ref;
+  using reference = ssize;
+  using iterator_category = std::input_iterator_tag;
+  using iterator_concept = std::random_access_iterator_tag;
 
-  Ptr ptr;
+  ssize first{};
+  ssize inc{1};
+  ssize index{};
 
-  [[nodiscard]] constexpr auto as_ptr(const usize offset = 0) const -> Ptr {
-    return ptr + offset;
+  constexpr auto next() -> void { ++index; }
+  constexpr auto prev() -> void { --index; }
+
+  [[nodiscard]] friend constexpr auto
+  operator==(const RangeIter &rhs, const RangeIter &lhs) // NOLINT
+      -> bool {
+    return rhs.index == lhs.index;
   }
-  [[nodiscard]] constexpr auto as_ref(const usize offset = 0) const -> Ref {
-    return *this->as_ptr(offset);
+  [[nodiscard]] friend constexpr auto
+  operator<=>(const RangeIter &rhs, const RangeIter &lhs) // NOLINT
+      -> std::strong_ordering {
+    return rhs.index <=> lhs.index;
   }
 
-  constexpr auto next() -> void { ++ptr; }
-  constexpr auto prev() -> void { --ptr; }
-
-  [[nodiscard]] friend constexpr auto operator<=>(const CIter &rhs, // NOLINT
-                                                  const CIter &lhs) = default;
-  [[nodiscard]] constexpr auto operator*() -> Ref { return this->as_ref(); }
-  [[nodiscard]] constexpr auto operator->() -> Ptr { return this->as_ptr(); }
-  constexpr auto operator++() -> void { this->next(); }
-  constexpr auto operator--() -> void { this->pref(); }
-
-  [[nodiscard]] constexpr explicit CIter(const Ptr _ptr) : ptr{_ptr} {}
-
-  [[nodiscard]] static constexpr auto from_unchecked(const Ptr _ptr) -> Self {
-    return CIter(_ptr);
+  [[nodiscard]] constexpr auto operator*() const -> ssize {
+    return first + index * inc;
   }
-
-  [[nodiscard]] static constexpr auto from(const Ptr _ptr) -> Option<Self> {
-    if (_ptr == nullptr) {
-      return {};
-    }
-    return {CIter(_ptr)};
+  [[nodiscard]] constexpr auto operator[](const ssize offset) const -> ssize {
+    return first + (index + offset) * inc;
   }
-};
-
-struct RangeIter {
-  using Self = RangeIter;
-
-  ssize count{};
-  ssize inc{1};
 
-  constexpr auto next() -> void { count += inc; }
+  constexpr auto operator++() -> Self & {
+    this->next();
+    return *this;
+  }
+  constexpr auto operator--() -> Self & {
+    this->prev();
+    return *this;
+  }
+  constexpr auto operator++(int) -> Self {
+    auto ret = *this;
+    this->next();
+    return ret;
+  }
+  constexpr auto operator--(int) -> Self {
+    auto ret = *this;
+    this->prev();
+    return ret;
+  }
 
-  [[nodiscard]] friend constexpr auto
-  operator<=>(const RangeIter &rhs, // NOLINT
-              const RangeIter &lhs) = default;
-  [[nodiscard]] constexpr auto operator*() const -> ssize { return count; }
+  constexpr auto operator+=(const ssize offset) -> Self & {
+    index += offset;
+    return *this;
+  }
+  constexpr auto operator-=(const ssize offset) -> Self & {
+    index -= offset;
+    return *this;
+  }
 
-  constexpr auto operator++() -> void { this->next(); }
+  [[nodiscard]] friend constexpr auto operator+(Self it, const ssize offset)
+      -> Self {
+    return it += offset;
+  }
+  [[nodiscard]] friend constexpr auto operator+(const ssize offset, Self it)
+      -> Self {
+    return it += offset;
+  }
+  [[nodiscard]] friend constexpr auto operator-(Self it, const ssize offset)
+      -> Self {
+    return it -= offset;
+  }
+  [[nodiscard]] friend constexpr auto operator-(const Self &rhs,
+                                                const Self &lhs) -> ssize {
+    return rhs.index - lhs.index;
+  }
 
-  [[nodiscard]] constexpr explicit RangeIter(const ssize _count,
-                                             const ssize _inc = 1)
-      : count{_count}, inc{_inc} {}
+  [[nodiscard]] constexpr RangeIter() = default;
+  [[nodiscard]] constexpr explicit RangeIter(const ssize _first,
+                                             const ssize _inc = 1,
+                                             const ssize _index = 0)
+      : first{_first}, inc{_inc}, index{_index} {}
 
   template <typename... Args>
   [[nodiscard]] static constexpr auto from_unchecked(Args &&...args) -> Self {
@@ -138,7 +234,9 @@ struct RangeIter {
   }
 };
 
-struct Range {
+// Inclusive range [first, last] stepping by inc. The trip count is computed
+// once on construction; a step that never reaches last yields an empty range.
+struct Range : std::ranges::view_interface<Range> {
   using Self = Range;
 
   using It = RangeIter;
@@ -146,21 +244,40 @@ struct Range {
   ssize first{};
   ssize last{};
   ssize inc{1};
+  ssize len{};
+
+  [[nodiscard]] static constexpr auto trip_count(const ssize _first,
+                                                 const ssize _last,
+                                                 const ssize _inc) -> ssize {
+    if (_inc > 0 && _last >= _first) {
+      return (_last - _first) / _inc + 1;
+    }
+    if (_inc < 0 && _first >= _last) {
+      return (_first - _last) / -_inc + 1;
+    }
+    return 0;
+  }
+
+  [[nodiscard]] constexpr auto size() const -> usize {
+    return static_cast<usize>(len);
+  }
 
   [[nodiscard]] constexpr auto begin() const -> RangeIter {
     return RangeIter::from_unchecked(first, inc);
   }
 
   [[nodiscard]] constexpr auto end() const -> RangeIter {
-    auto max = (inc > 0) ? last + 1 : last - 1;
-    return RangeIter::from_unchecked(max, inc);
+    return RangeIter::from_unchecked(first, inc, len);
   }
 
+  [[nodiscard]] constexpr Range() = default;
   [[nodiscard]] constexpr explicit Range(const ssize _first, const ssize _last,
                                          const ssize _inc = 1)
-      : first{_first}, last{_last}, inc{_inc} {}
+      : first{_first}, last{_last}, inc{_inc},
+        len{trip_count(_first, _last, _inc)} {}
 
-  [[nodiscard]] constexpr explicit Range(const ssize _last) : last{_last} {}
+  [[nodiscard]] constexpr explicit Range(const ssize _last)
+      : last{_last}, len{trip_count(0, _last, 1)} {}
 
   template <typename... Args>
   [[nodiscard]] static constexpr auto from_unchecked(Args &&...args) -> Self {
@@ -170,8 +287,55 @@ struct Range {
   [[nodiscard]] static constexpr auto
   from(const ssize _first, const ssize _last, const ssize _inc = 1)
       -> Option<Self> {
+    if (_inc == 0) {
+      return {};
+    }
     return {Self(_first, _last, _inc)};
   }
 };
 
+// Compile-time counterpart of Range whose for_each is fully unrolled; each
+// step receives its value as an std::integral_constant.
+template <ssize First, ssize Last, ssize Step = 1> struct StaticRange {
+  static_assert(Step != 0, "StaticRange step must be non-zero");
+
+  using Self = StaticRange<First, Last, Step>;
+
+  using It = RangeIter;
+
+  static constexpr ssize len = Range::trip_count(First, Last, Step);
+
+  [[nodiscard]] static constexpr auto size() -> usize {
+    return static_cast<usize>(len);
+  }
+
+  [[nodiscard]] static constexpr auto begin() -> RangeIter {
+    return RangeIter::from_unchecked(First, Step);
+  }
+
+  [[nodiscard]] static constexpr auto end() -> RangeIter {
+    return RangeIter::from_unchecked(First, Step, len);
+  }
+
+  template <typename TF> static constexpr auto for_each(TF &&fn) -> void {
+    [&fn]<ssize... Is>(std::integer_sequence<ssize, Is...>) {
+      (fn(std::integral_constant<ssize, First + Is * Step>{}), ...);
+    }(std::make_integer_sequence<ssize, len>{});
+  }
+};
+
+template <ssize First, ssize Last, ssize Step = 1, typename TF>
+constexpr auto static_for(TF &&fn) -> void {
+  StaticRange<First, Last, Step>::for_each(std::forward<TF>(fn));
+}
+
+static_assert(std::contiguous_iterator<Iter<u8>>);
+static_assert(std::contiguous_iterator<CIter<u8>>);
+static_assert(std::contiguous_iterator<Iter<u8, check::Checked>>);
+static_assert(std::random_access_iterator<RangeIter>);
+static_assert(std::ranges::random_access_range<Range>);
+static_assert(std::ranges::sized_range<Range>);
+static_assert(std::ranges::view<Range>);
+static_assert(std::ranges::random_access_range<StaticRange<0, 7, 2>>);
+
 } // namespace exl
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <exl/check.hpp>
 #include <exl/fmt.hpp>
 #include <exl/iter.hpp>
 #include <exl/option.hpp>
@@ -83,8 +84,13 @@ template <typename T> [[nodiscard]] auto addr(const std::string &str) -> T * {
 } // namespace exl::ptr
 
 namespace exl {
-template <typename T> struct Slice {
-  using Self = Slice<T>;
+
+static constexpr usize CACHE_LINE = 64;
+
+// P decides whether operator[] checks its bounds. get() always checks and
+// get_unchecked() never does, whatever the policy.
+template <typename T, traits::CheckPolicy P = check::Checked> struct Slice {
+  using Self = Slice<T, P>;
   using Val = T;
   using Ptr = T *;
   using Ref = T &;
@@ -103,7 +109,9 @@ template <typename T> struct Slice {
     return *this->as_ptr(offset);
   }
 
-  [[nodiscard]] constexpr auto size() const -> usize { return cap - 1; }
+  [[nodiscard]] constexpr auto data() const -> Ptr { return ptr; }
+
+  [[nodiscard]] constexpr auto size() const -> usize { return cap; }
 
   [[nodiscard]] constexpr auto begin() const -> It {
     return It::from_unchecked(ptr);
@@ -120,11 +128,23 @@ template <typename T> struct Slice {
     return CIt::from_unchecked(this->as_ptr(cap));
   }
 
-  [[nodiscard]] constexpr auto operator[](const usize offset) -> Ref {
+  [[nodiscard]] constexpr auto operator[](const usize offset) const -> Ref {
+    if constexpr (P::enabled) {
+      if (offset >= cap) [[unlikely]] {
+        impl::panic_bounds(cap, offset);
+      }
+    }
+    return this->as_ref(offset);
+  }
+
+  [[nodiscard]] constexpr auto get(const usize offset) const -> Option<Ref> {
     if (offset >= cap) {
-      panic(fmt::format("Tried to index slice of size {}, at offset {}", cap,
-                        offset));
+      return {};
     }
+    return {this->as_ref(offset)};
+  }
+
+  [[nodiscard]] constexpr auto get_unchecked(const usize offset) const -> Ref {
     return this->as_ref(offset);
   }
 
@@ -142,6 +162,11 @@ template <typename T> struct Slice {
   [[nodiscard]] constexpr explicit Slice(const Ptr _ptr, const usize _cap)
       : ptr{_ptr}, cap{_cap} {}
 
+  template <typename U, traits::CheckPolicy Q>
+  requires std::is_convertible_v<U *, Ptr>
+  [[nodiscard]] constexpr Slice(const Slice<U, Q> &other) // NOLINT
+      : ptr{other.ptr}, cap{other.cap} {}
+
   [[nodiscard]] static constexpr auto from_unchecked(const Ptr _ptr,
                                                      const usize _cap) -> Self {
     return Self(_ptr, _cap);
@@ -161,4 +186,8 @@ template <typename T> struct Slice {
   }
 };
 
+static_assert(std::ranges::contiguous_range<Slice<u8>>);
+static_assert(std::ranges::sized_range<Slice<u8>>);
+static_assert(std::ranges::contiguous_range<Slice<u8, check::Unchecked>>);
+
 } // namespace exl
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <exl/check.hpp>
+#include <exl/err.hpp>
 #include <exl/fmt.hpp>
+#include <exl/function.hpp>
 #include <exl/pattern.hpp>
 #include <exl/traceback.hpp>
 
@@ -20,11 +23,25 @@ template <typename T> struct Option : Union<T, None> {
 
   [[nodiscard]] constexpr auto is_none() const -> bool { return !is_some(); }
 
-  [[nodiscard]] constexpr auto unwrap() const -> T {
-    if (this->is_none()) {
-      panic("Bad unwrap of Optional");
+  template <traits::CheckPolicy P = check::Checked>
+  [[nodiscard]] constexpr auto unwrap() const & -> T {
+    if constexpr (P::enabled) {
+      if (this->is_none()) [[unlikely]] {
+        impl::panic_unwrap("Bad unwrap of Optional");
+      }
     }
-    return std::get<T>(*this);
+    return *std::get_if<T>(this);
+  }
+
+  // Moves the value out, so move-only types can be unwrapped too.
+  template <traits::CheckPolicy P = check::Checked>
+  [[nodiscard]] constexpr auto unwrap() && -> T {
+    if constexpr (P::enabled) {
+      if (this->is_none()) [[unlikely]] {
+        impl::panic_unwrap("Bad unwrap of Optional");
+      }
+    }
+    return std::move(*std::get_if<T>(this));
   }
 
   [[nodiscard]] constexpr auto unwrap_or(const T &data) -> T {
@@ -37,8 +54,7 @@ template <typename T> struct Option : Union<T, None> {
                         [](None _) { return T{}; });
   }
 
-  [[nodiscard]] constexpr auto unwrap_or_else(const std::function<T(void)> &fn)
-      -> T {
+  [[nodiscard]] constexpr auto unwrap_or_else(const FnRef<T(void)> fn) -> T {
     return match(*this)([](const T &ok) { return ok; },
                         [&fn](None _) { return fn(); });
   }
@@ -73,6 +89,53 @@ template <typename T> struct Option : Union<T, None> {
 
   [[nodiscard]] constexpr Option() : Self{None{}} {}
   [[nodiscard]] constexpr Option(const T &some) : Self{some} {}
+  [[nodiscard]] constexpr Option(T &&some) : Self{std::move(some)} {}
+  // NOLINTEND
+};
+
+// Borrowing Option, e.g. the result of Slice::get. Holds a reference_wrapper
+// so it still matches like any other Union.
+template <typename T>
+struct Option<T &> : Union<std::reference_wrapper<T>, None> {
+  using Self = Union<std::reference_wrapper<T>, None>;
+
+  [[nodiscard]] constexpr auto is_some() const -> bool {
+    return std::holds_alternative<std::reference_wrapper<T>>(*this);
+  }
+
+  [[nodiscard]] constexpr auto is_none() const -> bool { return !is_some(); }
+
+  template <traits::CheckPolicy P = check::Checked>
+  [[nodiscard]] constexpr auto unwrap() const -> T & {
+    if constexpr (P::enabled) {
+      if (this->is_none()) [[unlikely]] {
+        impl::panic_unwrap("Bad unwrap of Optional");
+      }
+    }
+    return std::get_if<std::reference_wrapper<T>>(this)->get();
+  }
+
+  [[nodiscard]] constexpr auto unwrap_or(T &data) const -> T & {
+    if (this->is_none()) {
+      return data;
+    }
+    return std::get<std::reference_wrapper<T>>(*this).get();
+  }
+
+  [[nodiscard]] constexpr auto expect(std::string_view msg) const -> T & {
+    if (this->is_none()) [[unlikely]] {
+      panic(msg);
+    }
+    return std::get<std::reference_wrapper<T>>(*this).get();
+  }
+
+  [[nodiscard]] constexpr auto contains(const T &data) const -> bool {
+    return this->is_some() && this->unwrap() == data;
+  }
+
+  // NOLINTBEGIN
+  [[nodiscard]] constexpr Option() : Self{None{}} {}
+  [[nodiscard]] constexpr Option(T &some) : Self{std::ref(some)} {}
   // NOLINTEND
 };
 
@@ -95,18 +158,21 @@ template <typename T, typename E> struct Result : Union<T, E> {
     return {};
   }
 
-  [[nodiscard]] constexpr auto err() const -> Option<T> {
+  [[nodiscard]] constexpr auto err() const -> Option<E> {
     if (this->is_err()) {
       return {std::get<E>(*this)};
     }
     return {};
   }
 
+  template <traits::CheckPolicy P = check::Checked>
   [[nodiscard]] constexpr auto unwrap() const -> T {
-    if (this->is_err()) {
-      panic("Bad unwrap of Result");
+    if constexpr (P::enabled) {
+      if (this->is_err()) [[unlikely]] {
+        impl::panic_unwrap("Bad unwrap of Result");
+      }
     }
-    return std::get<T>(*this);
+    return *std::get_if<T>(this);
   }
 
   [[nodiscard]] constexpr auto unwrap_or(const T &data) const -> T {
@@ -119,8 +185,8 @@ template <typename T, typename E> struct Result : Union<T, E> {
                         [](const E &err) { return T{}; });
   }
 
-  [[nodiscard]] constexpr auto
-  unwrap_or_else(const std::function<T(void)> &fn) const -> T {
+  [[nodiscard]] constexpr auto unwrap_or_else(const FnRef<T(void)> fn) const
+      -> T {
     return match(*this)([](const T &ok) { return ok; },
                         [&fn](const E &err) { return fn(); });
   }
@@ -132,9 +198,29 @@ template <typename T, typename E> struct Result : Union<T, E> {
     return std::get<T>(*this);
   }
 
+  // Attaches a context frame to an error, leaving Ok values untouched.
+  [[nodiscard]] constexpr auto context(const std::string_view msg) const
+      -> Result<T, ContextFor<E>> {
+    if (this->is_ok()) {
+      return {std::get<T>(*this)};
+    }
+    return {trace::propagate(ContextFor<E>(std::get<E>(*this)).with(msg))};
+  }
+
   // NOLINTBEGIN
   [[nodiscard]] constexpr Result(const T &ok) : Self{ok} {}
-  [[nodiscard]] constexpr Result(const E &err) : Self{err} {}
+  // A new error, which starts a new error return trace. Errors passed on
+  // come in through trace::propagate, as EXL_TRY does, and keep theirs.
+  // Always inlined, at -O0 too, so that the origin trace::begin() records
+  // is the function creating the error rather than this constructor.
+  [[nodiscard, gnu::always_inline]] constexpr Result(const E &err)
+      : Self{err} {
+    if (!std::is_constant_evaluated()) {
+      EXL_TRACE_BEGIN();
+    }
+  }
+  [[nodiscard]] constexpr Result(trace::Propagated<E> err)
+      : Self{std::move(err.err)} {}
   // NOLINTEND
 };
 
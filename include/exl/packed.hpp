@@ -0,0 +1,527 @@
+#pragma once
+
+#include <exl/check.hpp>
+#include <exl/iter.hpp>
+#include <exl/mem.hpp>
+#include <exl/option.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define EXL_PACKED_X86 1
+#include <immintrin.h>
+#endif
+
+namespace exl::impl {
+
+[[nodiscard]] inline auto load_u64(const u8 *src) -> u64 {
+  u64 ret{};
+  std::memcpy(&ret, src, sizeof(ret));
+  return ret;
+}
+
+inline auto store_u64(u8 *dst, const u64 val) -> void {
+  std::memcpy(dst, &val, sizeof(val));
+}
+
+[[nodiscard]] inline auto load_u32(const u8 *src) -> u32 {
+  u32 ret{};
+  std::memcpy(&ret, src, sizeof(ret));
+  return ret;
+}
+
+// StreamVByte decoding of `count` deltas: the 2 bit byte lengths come from
+// `ctrl`, the deltas from `src`, and their running sum from `prev` on is
+// written to `out`. The kernels load past the last delta, so streams keep
+// 16 bytes of slack.
+namespace scalar {
+
+inline auto delta_decode(const u8 *ctrl, const u8 *src, const usize count,
+                         u32 prev, u32 *out) -> void {
+  static constexpr u32 MASKS[4] = {0xff, 0xffff, 0xffffff, 0xffffffff};
+
+  usize i = 0;
+  // One control byte describes four deltas; unrolling over it lets the
+  // loads of a group issue before the running sum needs them.
+  for (; i + 4 <= count; i += 4) {
+    const auto lens = ctrl[i / 4];
+    const auto d0 = load_u32(src) & MASKS[lens & 3];
+    src += (lens & 3) + 1;
+    const auto d1 = load_u32(src) & MASKS[(lens >> 2) & 3];
+    src += ((lens >> 2) & 3) + 1;
+    const auto d2 = load_u32(src) & MASKS[(lens >> 4) & 3];
+    src += ((lens >> 4) & 3) + 1;
+    const auto d3 = load_u32(src) & MASKS[lens >> 6];
+    src += (lens >> 6) + 1;
+    out[i] = prev += d0;
+    out[i + 1] = prev += d1;
+    out[i + 2] = prev += d2;
+    out[i + 3] = prev += d3;
+  }
+  for (; i < count; ++i) {
+    const auto width = (ctrl[i / 4] >> (i % 4 * 2)) & 3;
+    prev += load_u32(src) & MASKS[width];
+    src += width + 1;
+    out[i] = prev;
+  }
+}
+
+} // namespace scalar
+
+#ifdef EXL_PACKED_X86
+// The StreamVByte kernel of Lemire, Kurz and Rupp: a control byte indexes a
+// pshufb mask that widens its four deltas to u32 lanes in one shuffle, and
+// two shifted adds turn them into a prefix sum.
+namespace ssse3 {
+
+struct DeltaShuffles {
+  std::array<std::array<u8, 16>, 256> masks{};
+  std::array<u8, 256> lens{};
+};
+
+inline constexpr auto DELTA_SHUFFLES = [] {
+  auto ret = DeltaShuffles();
+  for (usize ctrl = 0; ctrl < 256; ++ctrl) {
+    u8 at = 0;
+    for (usize lane = 0; lane < 4; ++lane) {
+      const auto width = ((ctrl >> (lane * 2)) & 3) + 1;
+      for (usize b = 0; b < 4; ++b) {
+        ret.masks[ctrl][lane * 4 + b] = b < width ? at++ : 0x80;
+      }
+    }
+    ret.lens[ctrl] = at;
+  }
+  return ret;
+}();
+
+[[gnu::target("ssse3")]] inline auto load(const u8 *src) -> __m128i {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(src)); // NOLINT
+}
+
+[[gnu::target("ssse3")]] inline auto
+delta_decode(const u8 *ctrl, const u8 *src, const usize count, u32 prev,
+             u32 *out) -> void {
+  auto sum = _mm_set1_epi32(static_cast<int>(prev));
+  usize i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const auto lens = ctrl[i / 4];
+    const auto *mask = DELTA_SHUFFLES.masks[lens].data();
+    auto v = _mm_shuffle_epi8(load(src), load(mask));
+    src += DELTA_SHUFFLES.lens[lens];
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 4));
+    v = _mm_add_epi32(v, _mm_slli_si128(v, 8));
+    sum = _mm_add_epi32(v, sum);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), sum); // NOLINT
+    sum = _mm_shuffle_epi32(sum, 0xff);
+  }
+  prev = static_cast<u32>(_mm_cvtsi128_si32(sum));
+  scalar::delta_decode(ctrl + i / 4, src, count - i, prev, out + i);
+}
+
+} // namespace ssse3
+#endif
+
+[[nodiscard]] inline auto has_ssse3() -> bool {
+#ifdef EXL_PACKED_X86
+  static const auto ret = __builtin_cpu_supports("ssse3") != 0;
+  return ret;
+#else
+  return false;
+#endif
+}
+
+// Random access iterator over anything with a `size()` and an indexed
+// `load()`, counting an index the way RangeIter does.
+template <typename C> struct IndexIter {
+  using Self = IndexIter<C>;
+
+  using value_type = u32;
+  using difference_type = ssize;
+  using reference = u32;
+  using iterator_category = std::input_iterator_tag;
+  using iterator_concept = std::random_access_iterator_tag;
+
+  const C *container{};
+  ssize index{};
+
+  constexpr auto next() -> void { ++index; }
+  constexpr auto prev() -> void { --index; }
+
+  [[nodiscard]] friend constexpr auto operator==(const IndexIter &rhs, // NOLINT
+                                                 const IndexIter &lhs)
+      -> bool {
+    return rhs.index == lhs.index;
+  }
+  [[nodiscard]] friend constexpr auto
+  operator<=>(const IndexIter &rhs, const IndexIter &lhs) // NOLINT
+      -> std::strong_ordering {
+    return rhs.index <=> lhs.index;
+  }
+
+  [[nodiscard]] auto operator*() const -> u32 {
+    return container->load(static_cast<usize>(index));
+  }
+  [[nodiscard]] auto operator[](const ssize offset) const -> u32 {
+    return container->load(static_cast<usize>(index + offset));
+  }
+
+  constexpr auto operator++() -> Self & {
+    this->next();
+    return *this;
+  }
+  constexpr auto operator--() -> Self & {
+    this->prev();
+    return *this;
+  }
+  constexpr auto operator++(int) -> Self {
+    auto ret = *this;
+    this->next();
+    return ret;
+  }
+  constexpr auto operator--(int) -> Self {
+    auto ret = *this;
+    this->prev();
+    return ret;
+  }
+
+  constexpr auto operator+=(const ssize offset) -> Self & {
+    index += offset;
+    return *this;
+  }
+  constexpr auto operator-=(const ssize offset) -> Self & {
+    index -= offset;
+    return *this;
+  }
+
+  [[nodiscard]] friend constexpr auto operator+(Self it, const ssize offset)
+      -> Self {
+    return it += offset;
+  }
+  [[nodiscard]] friend constexpr auto operator+(const ssize offset, Self it)
+      -> Self {
+    return it += offset;
+  }
+  [[nodiscard]] friend constexpr auto operator-(Self it, const ssize offset)
+      -> Self {
+    return it -= offset;
+  }
+  [[nodiscard]] friend constexpr auto operator-(const Self &rhs,
+                                                const Self &lhs) -> ssize {
+    return rhs.index - lhs.index;
+  }
+
+  [[nodiscard]] constexpr IndexIter() = default;
+  [[nodiscard]] constexpr explicit IndexIter(const C *_container,
+                                             const ssize _index)
+      : container{_container}, index{_index} {}
+};
+
+} // namespace exl::impl
+
+namespace exl {
+
+// Fixed width array of Bits-bit unsigned integers. Element i lives at bit
+// i * Bits, so any element is one unaligned 8 byte load and a shift away;
+// the storage keeps 8 bytes of slack so that load never runs off the end.
+// Values wider than Bits are truncated.
+template <usize Bits> struct PackedArray {
+  static_assert(Bits > 0 && Bits <= 32, "PackedArray holds 1 to 32 bits");
+
+  using Self = PackedArray<Bits>;
+  using It = impl::IndexIter<Self>;
+
+  static constexpr u32 MASK = Bits == 32 ? ~u32{0} : (u32{1} << Bits) - 1;
+  // A block of 64 elements fills exactly Bits words, which lets the bulk
+  // kernels work on whole words with shifts known at compile time.
+  static constexpr usize BLOCK = 64;
+
+  std::vector<u8> storage;
+  usize len{};
+
+  [[nodiscard]] constexpr auto size() const -> usize { return len; }
+  [[nodiscard]] constexpr auto is_empty() const -> bool { return len == 0; }
+  [[nodiscard]] auto bytes() const -> usize { return storage.size(); }
+
+  [[nodiscard]] auto begin() const -> It { return It(this, 0); }
+  [[nodiscard]] auto end() const -> It {
+    return It(this, static_cast<ssize>(len));
+  }
+
+  [[nodiscard]] auto load(const usize offset) const -> u32 {
+    const auto bit = offset * Bits;
+    return static_cast<u32>(
+               impl::load_u64(storage.data() + bit / 8) >> (bit % 8)) &
+           MASK;
+  }
+
+  auto store(const usize offset, const u32 val) -> void {
+    const auto bit = offset * Bits;
+    auto *dst = storage.data() + bit / 8;
+    auto word = impl::load_u64(dst);
+    word &= ~(u64{MASK} << (bit % 8));
+    word |= u64{val & MASK} << (bit % 8);
+    impl::store_u64(dst, word);
+  }
+
+  [[nodiscard]] auto operator[](const usize offset) const -> u32 {
+    if (offset >= len) [[unlikely]] {
+      impl::panic_bounds(len, offset);
+    }
+    return this->load(offset);
+  }
+
+  [[nodiscard]] auto get(const usize offset) const -> Option<u32> {
+    if (offset >= len) {
+      return {};
+    }
+    return {this->load(offset)};
+  }
+
+  auto set(const usize offset, const u32 val) -> void {
+    if (offset >= len) [[unlikely]] {
+      impl::panic_bounds(len, offset);
+    }
+    this->store(offset, val);
+  }
+
+  auto resize(const usize _len) -> void {
+    len = _len;
+    storage.resize((len * Bits + 7) / 8 + sizeof(u64));
+  }
+
+  auto push(const u32 val) -> void {
+    this->resize(len + 1);
+    this->store(len - 1, val);
+  }
+
+  static auto pack_block(const u32 *src, u8 *dst) -> void {
+    u64 words[Bits]{}; // NOLINT
+    static_for<0, BLOCK - 1>([&](auto i) {
+      constexpr usize bit = i * Bits;
+      constexpr usize word = bit / 64;
+      constexpr usize shift = bit % 64;
+      const auto val = u64{src[i] & MASK};
+      words[word] |= val << shift;
+      if constexpr (shift + Bits > 64) {
+        words[word + 1] |= val >> (64 - shift);
+      }
+    });
+    std::memcpy(dst, words, sizeof(words));
+  }
+
+  static auto unpack_block(const u8 *src, u32 *dst) -> void {
+    u64 words[Bits]; // NOLINT
+    std::memcpy(words, src, sizeof(words));
+    static_for<0, BLOCK - 1>([&](auto i) {
+      constexpr usize bit = i * Bits;
+      constexpr usize word = bit / 64;
+      constexpr usize shift = bit % 64;
+      auto val = words[word] >> shift;
+      if constexpr (shift + Bits > 64) {
+        val |= words[word + 1] << (64 - shift);
+      }
+      dst[i] = static_cast<u32>(val) & MASK;
+    });
+  }
+
+  // Decodes elements [start, start + out.cap) into `out`, clamped to the
+  // array, and returns how many were written.
+  auto unpack(const Slice<u32> out, const usize start = 0) const -> usize {
+    const auto count = start < len ? std::min(out.cap, len - start) : 0;
+    usize i = 0;
+    for (; i < count && (start + i) % BLOCK != 0; ++i) {
+      out.as_ref(i) = this->load(start + i);
+    }
+    for (; i + BLOCK <= count; i += BLOCK) {
+      unpack_block(storage.data() + (start + i) / 8 * Bits, out.as_ptr(i));
+    }
+    for (; i < count; ++i) {
+      out.as_ref(i) = this->load(start + i);
+    }
+    return count;
+  }
+
+  [[nodiscard]] PackedArray() = default;
+
+  [[nodiscard]] static auto pack(const Slice<const u32> values) -> Self {
+    auto ret = Self();
+    ret.resize(values.cap);
+    usize i = 0;
+    for (; i + BLOCK <= values.cap; i += BLOCK) {
+      pack_block(values.as_ptr(i), ret.storage.data() + i / 8 * Bits);
+    }
+    for (; i < values.cap; ++i) {
+      ret.store(i, values.as_ref(i));
+    }
+    return ret;
+  }
+};
+
+// Sequence of u32 stored as deltas from the previous value in the StreamVByte
+// layout: per block of 128 values a control stream of 2 bit byte lengths
+// followed by the 1 to 4 byte deltas. Each block records its first value and
+// offset, so random access decodes at most one block.
+struct DeltaSeq {
+  using Self = DeltaSeq;
+
+  static constexpr usize BLOCK = 128;
+  static constexpr usize CONTROL = BLOCK / 4;
+
+  struct Block {
+    u32 base;
+    u32 offset;
+  };
+
+  // Sequential iterator decoding one block at a time.
+  struct BlockIter {
+    using Self = BlockIter;
+
+    using value_type = u32;
+    using difference_type = ssize;
+    using reference = u32;
+    using iterator_category = std::input_iterator_tag;
+    using iterator_concept = std::forward_iterator_tag;
+
+    const DeltaSeq *seq{};
+    usize index{};
+    u32 buf[BLOCK]{}; // NOLINT
+
+    [[nodiscard]] friend auto operator==(const BlockIter &rhs, // NOLINT
+                                         const BlockIter &lhs) -> bool {
+      return rhs.index == lhs.index;
+    }
+
+    [[nodiscard]] auto operator*() const -> u32 { return buf[index % BLOCK]; }
+
+    auto operator++() -> Self & {
+      if (++index % BLOCK == 0 && index < seq->len) {
+        seq->decode_block(index / BLOCK, buf);
+      }
+      return *this;
+    }
+    auto operator++(int) -> Self {
+      auto ret = *this;
+      ++*this;
+      return ret;
+    }
+
+    [[nodiscard]] BlockIter() = default;
+    [[nodiscard]] explicit BlockIter(const DeltaSeq *_seq, const usize _index)
+        : seq{_seq}, index{_index} {
+      if (index < seq->len) {
+        seq->decode_block(index / BLOCK, buf);
+      }
+    }
+  };
+
+  using It = BlockIter;
+
+  std::vector<Block> blocks;
+  std::vector<u8> data;
+  usize len{};
+
+  [[nodiscard]] constexpr auto size() const -> usize { return len; }
+  [[nodiscard]] constexpr auto is_empty() const -> bool { return len == 0; }
+
+  [[nodiscard]] auto bytes() const -> usize {
+    return data.size() + blocks.size() * sizeof(Block);
+  }
+
+  [[nodiscard]] auto begin() const -> It { return It(this, 0); }
+  [[nodiscard]] auto end() const -> It { return It(this, len); }
+
+  [[nodiscard]] auto block_len(const usize block) const -> usize {
+    return std::min(BLOCK, len - block * BLOCK);
+  }
+
+  // Decodes one block into `out`, which must hold block_len(block) values.
+  auto decode_block(const usize block, u32 *out) const -> usize {
+    const auto count = this->block_len(block);
+    const auto *ctrl = data.data() + blocks[block].offset;
+    const auto *src = ctrl + (count + 3) / 4;
+#ifdef EXL_PACKED_X86
+    if (impl::has_ssse3()) {
+      impl::ssse3::delta_decode(ctrl, src, count, blocks[block].base, out);
+      return count;
+    }
+#endif
+    impl::scalar::delta_decode(ctrl, src, count, blocks[block].base, out);
+    return count;
+  }
+
+  [[nodiscard]] auto load(const usize offset) const -> u32 {
+    u32 buf[BLOCK]; // NOLINT
+    this->decode_block(offset / BLOCK, buf);
+    return buf[offset % BLOCK];
+  }
+
+  [[nodiscard]] auto get(const usize offset) const -> Option<u32> {
+    if (offset >= len) {
+      return {};
+    }
+    return {this->load(offset)};
+  }
+
+  // Decodes from the start into `out`, returning how many values were
+  // written.
+  auto decode(const Slice<u32> out) const -> usize {
+    const auto count = std::min(out.cap, len);
+    usize i = 0;
+    for (; i + BLOCK <= count; i += BLOCK) {
+      this->decode_block(i / BLOCK, out.as_ptr(i));
+    }
+    if (i < count) {
+      u32 buf[BLOCK]; // NOLINT
+      this->decode_block(i / BLOCK, buf);
+      std::copy(buf, buf + (count - i), out.as_ptr(i));
+    }
+    return count;
+  }
+
+  [[nodiscard]] DeltaSeq() = default;
+
+  [[nodiscard]] static auto encode(const Slice<const u32> values) -> Self {
+    auto ret = Self();
+    ret.len = values.cap;
+    ret.data.reserve(values.cap + values.cap / 4 + 16);
+
+    u32 prev = 0;
+    for (usize start = 0; start < values.cap; start += BLOCK) {
+      const auto count = std::min(BLOCK, values.cap - start);
+      const auto ctrl = ret.data.size();
+      if (ctrl > std::numeric_limits<u32>::max()) [[unlikely]] {
+        panic("DeltaSeq holds at most 4 GiB of packed data");
+      }
+      ret.blocks.push_back({prev, static_cast<u32>(ctrl)});
+      ret.data.resize(ctrl + (count + 3) / 4);
+
+      for (usize i = 0; i < count; ++i) {
+        const auto val = values.as_ref(start + i);
+        const auto delta = val - prev;
+        prev = val;
+
+        const auto width =
+            static_cast<usize>(std::bit_width(delta | 1) - 1) / 8;
+        ret.data[ctrl + i / 4] |= static_cast<u8>(width << (i % 4 * 2));
+        for (usize b = 0; b <= width; ++b) {
+          ret.data.push_back(static_cast<u8>(delta >> (8 * b)));
+        }
+      }
+    }
+    // Slack so the 16 byte loads of the last deltas stay in bounds.
+    ret.data.resize(ret.data.size() + 16);
+    return ret;
+  }
+};
+
+static_assert(std::random_access_iterator<PackedArray<7>::It>);
+static_assert(std::forward_iterator<DeltaSeq::It>);
+
+} // namespace exl
@@ -0,0 +1,557 @@
+#pragma once
+
+#include <exl/fmt.hpp>
+#include <exl/mem.hpp>
+#include <exl/option.hpp>
+#include <exl/types.hpp>
+
+#include <bit>
+#include <charconv>
+#include <concepts>
+#include <cstring>
+#include <limits>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace exl::traits {
+
+template <typename T>
+concept Integer = std::integral<T> && !std::same_as<T, bool> &&
+                  !std::same_as<T, char>;
+
+template <typename T>
+concept Float = std::floating_point<T>;
+
+template <typename T>
+concept Number = Integer<T> || Float<T>;
+
+} // namespace exl::traits
+
+namespace exl {
+
+struct ParseError {
+  enum class Kind : u8 { NoDigits, OutOfRange };
+
+  Kind kind{};
+  // The byte where a digit was expected, or the end of the number that
+  // does not fit.
+  usize offset{};
+
+  template <typename OutputIt> auto format_to(OutputIt out) const -> OutputIt {
+    return fmt::format_to(out, "{} at offset {}",
+                          kind == Kind::NoDigits ? "Expected a number"
+                                                 : "Number out of range",
+                          offset);
+  }
+};
+
+} // namespace exl
+
+namespace exl::impl {
+
+[[nodiscard]] inline auto load_digits8(const u8 *src) -> u64 {
+  u64 ret{};
+  std::memcpy(&ret, src, sizeof(ret));
+  return ret;
+}
+
+[[nodiscard]] constexpr auto is_digit(const u8 byte) -> bool {
+  return static_cast<u8>(byte - '0') < 10;
+}
+
+// Bytes of the little endian chunk that are ASCII digits come out as zero.
+// Carries only cross a byte after a non digit, so the first non-zero byte
+// is always the first non digit.
+[[nodiscard]] constexpr auto non_digits(const u64 chunk) -> u64 {
+  return ((chunk & 0xf0f0f0f0f0f0f0f0ULL) |
+          (((chunk + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) >> 4)) ^
+         0x3333333333333333ULL;
+}
+
+// Number of leading ASCII digits in the chunk, from 0 to 8.
+[[nodiscard]] constexpr auto count_digits8(const u64 chunk) -> usize {
+  const auto mask = non_digits(chunk);
+  return mask == 0 ? 8 : static_cast<usize>(__builtin_ctzll(mask)) / 8;
+}
+
+// Turns eight ASCII digits into their value with three multiplies, folding
+// neighbouring digits, then pairs, then quads.
+[[nodiscard]] constexpr auto parse_eight_digits(u64 chunk) -> u32 {
+  chunk -= 0x3030303030303030ULL;
+  chunk = (chunk * 10) + (chunk >> 8);
+  chunk = (((chunk & 0x000000ff000000ffULL) * (100 + (1000000ULL << 32))) +
+           (((chunk >> 16) & 0x000000ff000000ffULL) *
+            (1 + (10000ULL << 32)))) >>
+          32;
+  return static_cast<u32>(chunk);
+}
+
+// Value of the first `count` (1 to 7) digits of the chunk: they are moved to
+// the top and the freed bytes filled with '0'.
+[[nodiscard]] constexpr auto parse_digits8(const u64 chunk, const usize count)
+    -> u32 {
+  return parse_eight_digits((chunk << (8 * (8 - count))) |
+                            (0x3030303030303030ULL >> (8 * count)));
+}
+
+inline constexpr u64 POW10_U64[9] = { // NOLINT
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+struct DigitRun {
+  u64 value;
+  usize end;
+  bool overflow;
+};
+
+// Slow path for runs of 20 digits or more: skips leading zeros, then checks
+// every step.
+[[nodiscard]] inline auto parse_digits_checked(const u8 *src, const usize len,
+                                               usize at) -> DigitRun {
+  while (at < len && src[at] == '0') {
+    ++at;
+  }
+  u64 value = 0;
+  auto overflow = false;
+  for (; at < len && is_digit(src[at]); ++at) {
+    overflow |= __builtin_mul_overflow(value, 10, &value);
+    overflow |= __builtin_add_overflow(value, src[at] - '0', &value);
+  }
+  return {value, at, overflow};
+}
+
+// Eight digits per step while the buffer allows, the final partial chunk in
+// one step too, so a run costs no per digit branches.
+[[nodiscard]] inline auto parse_digits(const u8 *src, const usize len,
+                                       const usize start) -> DigitRun {
+  auto at = start;
+  u64 value = 0;
+  while (at + 8 <= len) {
+    const auto chunk = load_digits8(src + at);
+    const auto count = count_digits8(chunk);
+    if (count == 8) {
+      value = value * 100000000 + parse_eight_digits(chunk);
+      at += 8;
+      continue;
+    }
+    if (count > 0) {
+      value = value * POW10_U64[count] + parse_digits8(chunk, count);
+      at += count;
+    }
+    break;
+  }
+  if (at + 8 > len) {
+    for (; at < len && is_digit(src[at]); ++at) {
+      value = value * 10 + (src[at] - '0');
+    }
+  }
+
+  // Up to 19 digits always fit in a u64.
+  if (at - start > 19) [[unlikely]] {
+    return parse_digits_checked(src, len, start);
+  }
+  return {value, at, false};
+}
+
+template <traits::Integer T>
+[[nodiscard]] auto parse_integer(const u8 *src, const usize len)
+    -> Result<std::pair<T, usize>, ParseError> {
+  using U = std::make_unsigned_t<T>;
+
+  usize at = 0;
+  auto negative = false;
+  if constexpr (std::is_signed_v<T>) {
+    if (len > 0 && src[0] == '-') {
+      negative = true;
+      at = 1;
+    }
+  }
+
+  const auto run = parse_digits(src, len, at);
+  if (run.end == at) {
+    return {ParseError{ParseError::Kind::NoDigits, at}};
+  }
+
+  const auto limit = static_cast<u64>(std::numeric_limits<T>::max()) +
+                     static_cast<u64>(negative);
+  if (run.overflow || run.value > limit) {
+    return {ParseError{ParseError::Kind::OutOfRange, run.end}};
+  }
+  const auto magnitude = static_cast<U>(run.value);
+  return {std::pair{static_cast<T>(negative ? U{0} - magnitude : magnitude),
+                    run.end}};
+}
+
+// Layout of the IEEE binary formats, plus the bounds of the Clinger fast
+// path: when the decimal mantissa and the power of ten are both exact in T,
+// one multiply or divide is correctly rounded.
+template <traits::Float T> struct FloatFormat;
+
+template <> struct FloatFormat<d32> {
+  using Bits = u32;
+  static constexpr u64 MAX_MANTISSA = u64{1} << 24;
+  static constexpr s64 MAX_EXPONENT = 10;
+  static constexpr s32 MANTISSA_BITS = 23;
+  static constexpr s32 MIN_EXPONENT = -127;
+  static constexpr s32 INFINITE_POWER = 0xff;
+  static constexpr s64 MIN_ROUND_EVEN = -17;
+  static constexpr s64 MAX_ROUND_EVEN = 10;
+};
+
+template <> struct FloatFormat<d64> {
+  using Bits = u64;
+  static constexpr u64 MAX_MANTISSA = u64{1} << 53;
+  static constexpr s64 MAX_EXPONENT = 22;
+  static constexpr s32 MANTISSA_BITS = 52;
+  static constexpr s32 MIN_EXPONENT = -1023;
+  static constexpr s32 INFINITE_POWER = 0x7ff;
+  static constexpr s64 MIN_ROUND_EVEN = -4;
+  static constexpr s64 MAX_ROUND_EVEN = 23;
+};
+
+template <traits::Float T>
+[[nodiscard]] constexpr auto exact_pow10(const s64 exponent) -> T {
+  T ret = 1;
+  for (s64 i = 0; i < exponent; ++i) {
+    ret *= 10;
+  }
+  return ret;
+}
+
+template <traits::Float T>
+inline constexpr T POW10[23] = { // NOLINT
+    exact_pow10<T>(0),  exact_pow10<T>(1),  exact_pow10<T>(2),
+    exact_pow10<T>(3),  exact_pow10<T>(4),  exact_pow10<T>(5),
+    exact_pow10<T>(6),  exact_pow10<T>(7),  exact_pow10<T>(8),
+    exact_pow10<T>(9),  exact_pow10<T>(10), exact_pow10<T>(11),
+    exact_pow10<T>(12), exact_pow10<T>(13), exact_pow10<T>(14),
+    exact_pow10<T>(15), exact_pow10<T>(16), exact_pow10<T>(17),
+    exact_pow10<T>(18), exact_pow10<T>(19), exact_pow10<T>(20),
+    exact_pow10<T>(21), exact_pow10<T>(22)};
+
+// 5^q for q in [-POW5_RANGE, POW5_RANGE], normalised to 128 bits with the
+// top bit set: truncated for q >= 0, reciprocals rounded up for q < 0.
+// Literals in source rarely leave this range, the rest use from_chars.
+inline constexpr s64 POW5_RANGE = 64;
+
+inline constexpr u64 POW5_128[2 * POW5_RANGE + 1][2] = { // NOLINT
+    {0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL},
+    {0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL},
+    {0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL},
+    {0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL},
+    {0xcdb02555653131b6ULL, 0x3792f412cb06794dULL},
+    {0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL},
+    {0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL},
+    {0xc8de047564d20a8bULL, 0xf245825a5a445275ULL},
+    {0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL},
+    {0x9ced737bb6c4183dULL, 0x55464dd69685606bULL},
+    {0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL},
+    {0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL},
+    {0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL},
+    {0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL},
+    {0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL},
+    {0x95a8637627989aadULL, 0xdde7001379a44aa8ULL},
+    {0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL},
+    {0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL},
+    {0x9226712162ab070dULL, 0xcab3961304ca70e8ULL},
+    {0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL},
+    {0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL},
+    {0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL},
+    {0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL},
+    {0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL},
+    {0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL},
+    {0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL},
+    {0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL},
+    {0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL},
+    {0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL},
+    {0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL},
+    {0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL},
+    {0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL},
+    {0xcfb11ead453994baULL, 0x67de18eda5814af2ULL},
+    {0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL},
+    {0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL},
+    {0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL},
+    {0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL},
+    {0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL},
+    {0xc612062576589ddaULL, 0x95364afe032a819eULL},
+    {0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL},
+    {0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL},
+    {0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL},
+    {0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL},
+    {0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL},
+    {0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL},
+    {0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL},
+    {0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL},
+    {0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL},
+    {0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL},
+    {0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL},
+    {0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL},
+    {0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL},
+    {0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL},
+    {0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL},
+    {0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL},
+    {0x89705f4136b4a597ULL, 0x31680a88f8953031ULL},
+    {0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL},
+    {0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL},
+    {0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL},
+    {0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL},
+    {0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL},
+    {0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL},
+    {0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL},
+    {0xccccccccccccccccULL, 0xcccccccccccccccdULL},
+    {0x8000000000000000ULL, 0x0000000000000000ULL},
+    {0xa000000000000000ULL, 0x0000000000000000ULL},
+    {0xc800000000000000ULL, 0x0000000000000000ULL},
+    {0xfa00000000000000ULL, 0x0000000000000000ULL},
+    {0x9c40000000000000ULL, 0x0000000000000000ULL},
+    {0xc350000000000000ULL, 0x0000000000000000ULL},
+    {0xf424000000000000ULL, 0x0000000000000000ULL},
+    {0x9896800000000000ULL, 0x0000000000000000ULL},
+    {0xbebc200000000000ULL, 0x0000000000000000ULL},
+    {0xee6b280000000000ULL, 0x0000000000000000ULL},
+    {0x9502f90000000000ULL, 0x0000000000000000ULL},
+    {0xba43b74000000000ULL, 0x0000000000000000ULL},
+    {0xe8d4a51000000000ULL, 0x0000000000000000ULL},
+    {0x9184e72a00000000ULL, 0x0000000000000000ULL},
+    {0xb5e620f480000000ULL, 0x0000000000000000ULL},
+    {0xe35fa931a0000000ULL, 0x0000000000000000ULL},
+    {0x8e1bc9bf04000000ULL, 0x0000000000000000ULL},
+    {0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL},
+    {0xde0b6b3a76400000ULL, 0x0000000000000000ULL},
+    {0x8ac7230489e80000ULL, 0x0000000000000000ULL},
+    {0xad78ebc5ac620000ULL, 0x0000000000000000ULL},
+    {0xd8d726b7177a8000ULL, 0x0000000000000000ULL},
+    {0x878678326eac9000ULL, 0x0000000000000000ULL},
+    {0xa968163f0a57b400ULL, 0x0000000000000000ULL},
+    {0xd3c21bcecceda100ULL, 0x0000000000000000ULL},
+    {0x84595161401484a0ULL, 0x0000000000000000ULL},
+    {0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL},
+    {0xcecb8f27f4200f3aULL, 0x0000000000000000ULL},
+    {0x813f3978f8940984ULL, 0x4000000000000000ULL},
+    {0xa18f07d736b90be5ULL, 0x5000000000000000ULL},
+    {0xc9f2c9cd04674edeULL, 0xa400000000000000ULL},
+    {0xfc6f7c4045812296ULL, 0x4d00000000000000ULL},
+    {0x9dc5ada82b70b59dULL, 0xf020000000000000ULL},
+    {0xc5371912364ce305ULL, 0x6c28000000000000ULL},
+    {0xf684df56c3e01bc6ULL, 0xc732000000000000ULL},
+    {0x9a130b963a6c115cULL, 0x3c7f400000000000ULL},
+    {0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL},
+    {0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL},
+    {0x96769950b50d88f4ULL, 0x1314448000000000ULL},
+    {0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL},
+    {0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL},
+    {0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL},
+    {0xb7abc627050305adULL, 0xf14a3d9e40000000ULL},
+    {0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL},
+    {0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL},
+    {0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL},
+    {0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL},
+    {0x8c213d9da502de45ULL, 0x4526f422cc340000ULL},
+    {0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL},
+    {0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL},
+    {0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL},
+    {0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL},
+    {0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL},
+    {0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL},
+    {0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL},
+    {0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL},
+    {0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL},
+    {0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL},
+    {0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL},
+    {0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL},
+    {0x9f4f2726179a2245ULL, 0x01d762422c946590ULL},
+    {0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL},
+    {0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL},
+    {0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL},
+    {0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL},
+};
+
+// Eisel-Lemire: multiplies the normalised mantissa by the 128 bit power of
+// five and reads the rounded result off the top bits. Returns None in the
+// rare cases the truncated product cannot decide the rounding, or when the
+// result is subnormal or infinite, which from_chars then handles.
+template <traits::Float T>
+[[nodiscard]] auto eisel_lemire(const u64 mantissa, const s64 q,
+                                const bool negative) -> Option<T> {
+  using Format = FloatFormat<T>;
+  using Bits = typename Format::Bits;
+  static constexpr s32 PRECISION = Format::MANTISSA_BITS + 3;
+
+  const auto lz = __builtin_clzll(mantissa);
+  const auto w = mantissa << lz;
+  const auto &pow5 = POW5_128[q + POW5_RANGE];
+
+  auto first = static_cast<unsigned __int128>(w) * pow5[0];
+  auto high = static_cast<u64>(first >> 64);
+  auto low = static_cast<u64>(first);
+  static constexpr u64 PRECISION_MASK = ~u64{0} >> PRECISION;
+  if ((high & PRECISION_MASK) == PRECISION_MASK) {
+    const auto second = static_cast<unsigned __int128>(w) * pow5[1];
+    const auto carry = static_cast<u64>(second >> 64);
+    low += carry;
+    high += static_cast<u64>(low < carry);
+    if (low == ~u64{0} && (q < -27 || q > 55)) {
+      return {};
+    }
+  }
+
+  const auto upper = static_cast<s32>(high >> 63);
+  const auto shift = upper + 64 - PRECISION;
+  auto bits = high >> shift;
+  auto power2 = static_cast<s32>(((152170 + 65536) * q) >> 16) + 63 + upper -
+                lz - Format::MIN_EXPONENT;
+  if (power2 <= 0) {
+    return {};
+  }
+
+  // An exact halfway product rounds to even rather than up.
+  if (low <= 1 && q >= Format::MIN_ROUND_EVEN && q <= Format::MAX_ROUND_EVEN &&
+      (bits & 3) == 1 && (bits << shift) == high) {
+    bits &= ~u64{1};
+  }
+  bits += bits & 1;
+  bits >>= 1;
+  if (bits >= (u64{2} << Format::MANTISSA_BITS)) {
+    bits = u64{1} << Format::MANTISSA_BITS;
+    ++power2;
+  }
+  if (power2 >= Format::INFINITE_POWER) {
+    return {};
+  }
+
+  bits &= ~(u64{1} << Format::MANTISSA_BITS);
+  bits |= static_cast<u64>(power2) << Format::MANTISSA_BITS;
+  bits |= static_cast<u64>(negative) << (sizeof(T) * 8 - 1);
+  return {std::bit_cast<T>(static_cast<Bits>(bits))};
+}
+
+// Scans [-]digits[.digits][(e|E)[+|-]digits], keeping up to 19 significant
+// digits. Short, exactly representable literals take the Clinger fast path,
+// most others Eisel-Lemire. Whatever is left goes to std::from_chars, so
+// every result is correctly rounded.
+template <traits::Float T>
+[[nodiscard]] auto parse_float(const u8 *src, const usize len)
+    -> Result<std::pair<T, usize>, ParseError> {
+  static constexpr usize MAX_DIGITS = 19;
+
+  usize at = 0;
+  const auto negative = len > 0 && src[0] == '-';
+  at += static_cast<usize>(negative);
+
+  u64 mantissa = 0;
+  usize digits = 0;
+  s64 exponent = 0;
+  auto truncated = false;
+
+  const auto start = at;
+  while (at + 8 <= len && digits + 8 <= MAX_DIGITS &&
+         non_digits(load_digits8(src + at)) == 0) {
+    mantissa =
+        mantissa * 100000000 + parse_eight_digits(load_digits8(src + at));
+    digits += 8;
+    at += 8;
+  }
+  for (; at < len && is_digit(src[at]); ++at) {
+    if (digits < MAX_DIGITS) {
+      mantissa = mantissa * 10 + (src[at] - '0');
+      digits += static_cast<usize>(mantissa != 0);
+    } else {
+      truncated |= src[at] != '0';
+      ++exponent;
+    }
+  }
+  auto seen = at != start;
+
+  if (at < len && src[at] == '.') {
+    const auto frac = ++at;
+    for (; at < len && is_digit(src[at]); ++at) {
+      if (digits < MAX_DIGITS) {
+        mantissa = mantissa * 10 + (src[at] - '0');
+        digits += static_cast<usize>(mantissa != 0);
+        --exponent;
+      } else {
+        truncated |= src[at] != '0';
+      }
+    }
+    seen |= at != frac;
+  }
+  if (!seen) {
+    return {ParseError{ParseError::Kind::NoDigits, start}};
+  }
+
+  if (at < len && (src[at] == 'e' || src[at] == 'E')) {
+    auto exp_at = at + 1;
+    const auto exp_negative = exp_at < len && src[exp_at] == '-';
+    exp_at += static_cast<usize>(
+        exp_at < len && (src[exp_at] == '-' || src[exp_at] == '+'));
+    if (exp_at < len && is_digit(src[exp_at])) {
+      s64 value = 0;
+      for (; exp_at < len && is_digit(src[exp_at]); ++exp_at) {
+        value = std::min<s64>(value * 10 + (src[exp_at] - '0'), 1 << 20);
+      }
+      exponent += exp_negative ? -value : value;
+      at = exp_at;
+    }
+  }
+
+  if constexpr (requires { FloatFormat<T>::MAX_MANTISSA; }) {
+    using Format = FloatFormat<T>;
+    if (mantissa == 0 && !truncated) {
+      return {std::pair{negative ? -T{0} : T{0}, at}};
+    }
+    if (!truncated && exponent >= -POW5_RANGE && exponent <= POW5_RANGE) {
+      if (mantissa <= Format::MAX_MANTISSA &&
+          exponent >= -Format::MAX_EXPONENT &&
+          exponent <= Format::MAX_EXPONENT) {
+        auto value = static_cast<T>(mantissa);
+        value = exponent < 0 ? value / POW10<T>[-exponent]
+                             : value * POW10<T>[exponent];
+        return {std::pair{negative ? -value : value, at}};
+      }
+      if (const auto value = eisel_lemire<T>(mantissa, exponent, negative);
+          value.is_some()) {
+        return {std::pair{value.unwrap(), at}};
+      }
+    }
+  }
+
+  T value{};
+  const auto *first = ptr::cast<const char>(src);
+  const auto res = std::from_chars(first, first + at, value);
+  if (res.ec == std::errc::result_out_of_range) {
+    return {ParseError{ParseError::Kind::OutOfRange, at}};
+  }
+  return {std::pair{value, static_cast<usize>(res.ptr - first)}};
+}
+
+} // namespace exl::impl
+
+namespace exl {
+
+// Parses the number at the start of `bytes`, returning it along with the
+// count of bytes it spans. Like std::from_chars the only sign accepted is a
+// leading '-', for signed and floating point types.
+template <traits::Number T>
+[[nodiscard]] auto parse(const Slice<const u8> bytes)
+    -> Result<std::pair<T, usize>, ParseError> {
+  if constexpr (traits::Integer<T>) {
+    return impl::parse_integer<T>(bytes.as_ptr(), bytes.cap);
+  } else {
+    return impl::parse_float<T>(bytes.as_ptr(), bytes.cap);
+  }
+}
+
+// Writes `val` into `out`, floats in their shortest form that parses back
+// to the same value, returning the length or None if it does not fit.
+template <traits::Number T>
+[[nodiscard]] auto write_num(const Slice<u8> out, const T val)
+    -> Option<usize> {
+  auto *first = ptr::cast<char>(out.as_ptr());
+  const auto res = std::to_chars(first, first + out.cap, val);
+  if (res.ec != std::errc{}) {
+    return {};
+  }
+  return {static_cast<usize>(res.ptr - first)};
+}
+
+} // namespace exl
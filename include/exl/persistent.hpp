@@ -0,0 +1,540 @@
+#pragma once
+
+#include <exl/heap.hpp>
+#include <exl/option.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <functional>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace exl::impl {
+
+// Node of a compressed hash-array-mapped trie (CHAMP). Each level consumes
+// five bits of the hash: `datamap` marks the fragments stored inline as
+// entries, `nodemap` those that continue in a child. Entries and child
+// pointers trail the header, each in bitmap order. Keys whose 64 hash bits
+// all collide end in a collision node, a flat list of entries.
+//
+// Nodes are reference counted and shared between versions. An operation
+// may edit a node in place only when it is `unique`: its count is one and
+// so are those of every node above it.
+template <typename K, typename V> struct HamtNode {
+  using Self = HamtNode<K, V>;
+
+  struct Entry {
+    K key;
+    V val;
+  };
+
+  static constexpr u32 BITS = 5;
+  static constexpr u32 MASK = (1U << BITS) - 1;
+  static constexpr usize ENTRIES = (sizeof(Self) + alignof(Entry) - 1) /
+                                   alignof(Entry) * alignof(Entry);
+  static constexpr usize ALIGN = std::max(alignof(Self), alignof(Entry));
+
+  std::atomic<u32> refs{1};
+  u32 datamap{};
+  u32 nodemap{};
+  u32 data_len{};
+  u32 node_len{};
+  bool collision{};
+  u64 hash{}; // shared hash of a collision node
+
+  [[nodiscard]] static constexpr auto children_offset(const u32 data_len)
+      -> usize {
+    const auto end = ENTRIES + data_len * sizeof(Entry);
+    return (end + alignof(Self *) - 1) / alignof(Self *) * alignof(Self *);
+  }
+
+  [[nodiscard]] static constexpr auto bytes(const u32 data_len,
+                                            const u32 node_len) -> usize {
+    return children_offset(data_len) + node_len * sizeof(Self *);
+  }
+
+  [[nodiscard]] static constexpr auto fragment(const u64 hash,
+                                               const u32 shift) -> u32 {
+    return static_cast<u32>(hash >> shift) & MASK;
+  }
+
+  [[nodiscard]] static constexpr auto index(const u32 map, const u32 bit)
+      -> u32 {
+    return static_cast<u32>(std::popcount(map & (bit - 1)));
+  }
+
+  // Storage comes from mem::Heap's size classes, which recycle the many
+  // small, similarly sized nodes a trie churns through.
+  [[nodiscard]] static auto make(const u32 data_len, const u32 node_len)
+      -> Self * {
+    auto *mem = mem::Heap::alloc(bytes(data_len, node_len), ALIGN);
+    auto *node = new (mem) Self();
+    node->data_len = data_len;
+    node->node_len = node_len;
+    return node;
+  }
+
+  [[nodiscard]] auto entries() -> Entry * {
+    return std::launder(reinterpret_cast<Entry *>( // NOLINT
+        reinterpret_cast<u8 *>(this) + ENTRIES));  // NOLINT
+  }
+
+  [[nodiscard]] auto entries() const -> const Entry * {
+    return std::launder(reinterpret_cast<const Entry *>( // NOLINT
+        reinterpret_cast<const u8 *>(this) + ENTRIES));  // NOLINT
+  }
+
+  [[nodiscard]] auto children() const -> Self ** {
+    return reinterpret_cast<Self **>(                            // NOLINT
+        const_cast<u8 *>(reinterpret_cast<const u8 *>(this)) + // NOLINT
+        children_offset(data_len));
+  }
+
+  [[nodiscard]] auto is_singleton() const -> bool {
+    return data_len == 1 && node_len == 0;
+  }
+
+  [[nodiscard]] auto is_unique() const -> bool {
+    return refs.load(std::memory_order_acquire) == 1;
+  }
+
+  auto retain() -> Self * {
+    refs.fetch_add(1, std::memory_order_relaxed);
+    return this;
+  }
+
+  static auto release(Self *node) -> void {
+    if (node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      for (u32 i = 0; i < node->node_len; ++i) {
+        release(node->children()[i]);
+      }
+      node->destroy();
+    }
+  }
+
+  // Frees the node without touching its children, whose references have
+  // been handed elsewhere.
+  auto destroy() -> void {
+    std::destroy_n(this->entries(), data_len);
+    const auto size = bytes(data_len, node_len);
+    this->~Self();
+    mem::Heap::free(this, size, ALIGN);
+  }
+
+  // Moves entries out of a unique node and copies them out of a shared
+  // one.
+  static auto transfer(Entry &src, Entry *dst, const bool unique) -> void {
+    if (unique) {
+      new (dst) Entry{std::move(src.key), std::move(src.val)};
+    } else {
+      new (dst) Entry{src.key, src.val};
+    }
+  }
+
+  // Builds a node from `node` with entry slot `skip` (if any) left out,
+  // `add` inserted as entry slot `at`, and child slots handled alike. The
+  // old node is consumed when unique: its entries are moved and its child
+  // references taken over, except for the skipped child, which the caller
+  // settles. Otherwise children are retained.
+  struct Edit {
+    u32 datamap;
+    u32 nodemap;
+    u32 data_len;
+    u32 node_len;
+    u32 skip_entry = ~0U;
+    u32 add_entry_at = ~0U;
+    Entry *add_entry = nullptr;
+    u32 skip_child = ~0U;
+    u32 add_child_at = ~0U;
+    Self *add_child = nullptr;
+  };
+
+  static auto rebuild(Self *node, const bool unique, const Edit &edit)
+      -> Self * {
+    auto *out = make(edit.data_len, edit.node_len);
+    out->datamap = edit.datamap;
+    out->nodemap = edit.nodemap;
+    out->collision = node->collision;
+    out->hash = node->hash;
+    auto *dst = out->entries();
+    for (u32 i = 0, o = 0; o < edit.data_len; ++o) {
+      if (o == edit.add_entry_at) {
+        new (dst + o) Entry{std::move(*edit.add_entry)};
+        continue;
+      }
+      if (i == edit.skip_entry) {
+        ++i;
+      }
+      transfer(node->entries()[i++], dst + o, unique);
+    }
+    auto **kids = out->children();
+    for (u32 i = 0, o = 0; o < edit.node_len; ++o) {
+      if (o == edit.add_child_at) {
+        kids[o] = edit.add_child;
+        continue;
+      }
+      if (i == edit.skip_child) {
+        ++i;
+      }
+      auto *child = node->children()[i++];
+      kids[o] = unique ? child : child->retain();
+    }
+    if (unique) {
+      node->destroy();
+    }
+    return out;
+  }
+
+  static auto clone(Self *node) -> Self * {
+    return rebuild(node, false,
+                   {node->datamap, node->nodemap, node->data_len,
+                    node->node_len});
+  }
+
+  // Trie holding just the two entries, which differ in key but may share
+  // the hash fragments from `shift` on.
+  static auto pair(Entry &&lhs, const u64 lhs_hash, Entry &&rhs,
+                   const u64 rhs_hash, const u32 shift) -> Self * {
+    if (shift >= 64) {
+      auto *node = make(2, 0);
+      node->collision = true;
+      node->hash = lhs_hash;
+      new (node->entries()) Entry{std::move(lhs)};
+      new (node->entries() + 1) Entry{std::move(rhs)};
+      return node;
+    }
+    const auto lhs_frag = fragment(lhs_hash, shift);
+    const auto rhs_frag = fragment(rhs_hash, shift);
+    if (lhs_frag == rhs_frag) {
+      auto *node = make(0, 1);
+      node->nodemap = 1U << lhs_frag;
+      node->children()[0] =
+          pair(std::move(lhs), lhs_hash, std::move(rhs), rhs_hash,
+               shift + BITS);
+      return node;
+    }
+    auto *node = make(2, 0);
+    node->datamap = (1U << lhs_frag) | (1U << rhs_frag);
+    const bool lhs_first = lhs_frag < rhs_frag;
+    new (node->entries()) Entry{std::move(lhs_first ? lhs : rhs)};
+    new (node->entries() + 1) Entry{std::move(lhs_first ? rhs : lhs)};
+    return node;
+  }
+
+  // Installs `fresh` in child slot `at` of `node`, which now replaces the
+  // node's old child there.
+  static auto replace_child(Self *node, const bool unique, const u32 at,
+                            Self *fresh, const bool child_unique) -> Self * {
+    auto *old = node->children()[at];
+    auto *out = unique ? node : clone(node);
+    out->children()[at] = fresh;
+    if (!child_unique) {
+      // The old child is still shared and lost the reference held here or
+      // taken by clone().
+      release(old);
+    }
+    return out;
+  }
+
+  // Returns the node to use in place of `node`. A unique node is consumed;
+  // a shared one is left as it was.
+  template <typename H>
+  static auto insert(Self *node, const bool unique, Entry &&entry,
+                     const u64 hash, const u32 shift, const H &hasher,
+                     bool &added) -> Self * {
+    if (node->collision) {
+      for (u32 i = 0; i < node->data_len; ++i) {
+        if (node->entries()[i].key == entry.key) {
+          auto *out = unique ? node : clone(node);
+          out->entries()[i].val = std::move(entry.val);
+          return out;
+        }
+      }
+      added = true;
+      return rebuild(node, unique,
+                     {0, 0, node->data_len + 1, 0, ~0U, node->data_len,
+                      &entry});
+    }
+
+    const auto bit = 1U << fragment(hash, shift);
+    if ((node->datamap & bit) != 0) {
+      const auto at = index(node->datamap, bit);
+      auto &slot = node->entries()[at];
+      if (slot.key == entry.key) {
+        auto *out = unique ? node : clone(node);
+        out->entries()[at].val = std::move(entry.val);
+        return out;
+      }
+      added = true;
+      auto moved = Entry{unique ? Entry{std::move(slot.key),
+                                        std::move(slot.val)}
+                                : Entry{slot.key, slot.val}};
+      const auto moved_hash = static_cast<u64>(hasher(moved.key));
+      auto *sub = pair(std::move(moved), moved_hash, std::move(entry), hash,
+                       shift + BITS);
+      return rebuild(node, unique,
+                     {node->datamap & ~bit, node->nodemap | bit,
+                      node->data_len - 1, node->node_len + 1, at, ~0U,
+                      nullptr, ~0U, index(node->nodemap | bit, bit), sub});
+    }
+    if ((node->nodemap & bit) != 0) {
+      const auto at = index(node->nodemap, bit);
+      auto *child = node->children()[at];
+      const bool child_unique = unique && child->is_unique();
+      auto *fresh = insert(child, child_unique, std::move(entry), hash,
+                           shift + BITS, hasher, added);
+      return replace_child(node, unique, at, fresh, child_unique);
+    }
+    added = true;
+    return rebuild(node, unique,
+                   {node->datamap | bit, node->nodemap, node->data_len + 1,
+                    node->node_len, ~0U, index(node->datamap | bit, bit),
+                    &entry});
+  }
+
+  // Like insert(). Leaves `node` untouched and returns it when the key is
+  // missing. A child left with a single entry is pulled up into its
+  // parent, so every trie holds its keys as high as they can go.
+  static auto erase(Self *node, const bool unique, const K &key,
+                    const u64 hash, const u32 shift, bool &removed)
+      -> Self * {
+    if (node->collision) {
+      for (u32 i = 0; i < node->data_len; ++i) {
+        if (node->entries()[i].key == key) {
+          removed = true;
+          return rebuild(node, unique, {0, 0, node->data_len - 1, 0, i});
+        }
+      }
+      return node;
+    }
+
+    const auto bit = 1U << fragment(hash, shift);
+    if ((node->datamap & bit) != 0) {
+      const auto at = index(node->datamap, bit);
+      if (!(node->entries()[at].key == key)) {
+        return node;
+      }
+      removed = true;
+      return rebuild(node, unique,
+                     {node->datamap & ~bit, node->nodemap,
+                      node->data_len - 1, node->node_len, at});
+    }
+    if ((node->nodemap & bit) == 0) {
+      return node;
+    }
+    const auto at = index(node->nodemap, bit);
+    auto *child = node->children()[at];
+    const bool child_unique = unique && child->is_unique();
+    auto *fresh = erase(child, child_unique, key, hash, shift + BITS, removed);
+    if (!removed) {
+      return node;
+    }
+    if (!fresh->is_singleton()) {
+      return replace_child(node, unique, at, fresh, child_unique);
+    }
+
+    // `fresh` was just built, so its entry can move.
+    auto pulled = Entry{std::move(fresh->entries()[0].key),
+                        std::move(fresh->entries()[0].val)};
+    fresh->destroy();
+    if (unique && !child_unique) {
+      release(child);
+    }
+    return rebuild(node, unique,
+                   {node->datamap | bit, node->nodemap & ~bit,
+                    node->data_len + 1, node->node_len - 1, ~0U,
+                    index(node->datamap | bit, bit), &pulled, at});
+  }
+
+  [[nodiscard]] auto find(const K &key, const u64 hash) const
+      -> const Entry * {
+    const auto *node = this;
+    for (u32 shift = 0;; shift += BITS) {
+      if (node->collision) {
+        for (u32 i = 0; i < node->data_len; ++i) {
+          if (node->entries()[i].key == key) {
+            return node->entries() + i;
+          }
+        }
+        return nullptr;
+      }
+      const auto bit = 1U << fragment(hash, shift);
+      if ((node->datamap & bit) != 0) {
+        const auto *entry = node->entries() + index(node->datamap, bit);
+        return entry->key == key ? entry : nullptr;
+      }
+      if ((node->nodemap & bit) == 0) {
+        return nullptr;
+      }
+      node = node->children()[index(node->nodemap, bit)];
+    }
+  }
+
+  template <typename TF> auto for_each(TF &fn) const -> void {
+    for (u32 i = 0; i < data_len; ++i) {
+      fn(this->entries()[i].key, this->entries()[i].val);
+    }
+    for (u32 i = 0; i < node_len; ++i) {
+      this->children()[i]->for_each(fn);
+    }
+  }
+};
+
+} // namespace exl::impl
+
+namespace exl {
+
+template <typename K, typename V, typename Hash> struct TransientMap;
+
+// Immutable hash map with structural sharing. set() and erase() return a
+// new version that shares all untouched nodes with the old one, copying
+// only the O(log32 n) nodes on the path to the key, and copying a map is
+// a reference count bump. Versions may be read from several threads.
+//
+// For bulk building use transient(): it edits nodes it owns in place and
+// hands a map back with persistent().
+template <typename K, typename V, typename Hash = std::hash<K>>
+struct PersistentMap {
+  using Self = PersistentMap<K, V, Hash>;
+  using Node = impl::HamtNode<K, V>;
+  using Entry = typename Node::Entry;
+  using Key = K;
+  using Val = V;
+
+  Node *root;
+  usize len{};
+
+  PersistentMap() : root{Node::make(0, 0)} {}
+
+  PersistentMap(const Self &other)
+      : root{other.root->retain()}, len{other.len} {}
+
+  PersistentMap(Self &&other) noexcept
+      : root{std::exchange(other.root, Node::make(0, 0))},
+        len{std::exchange(other.len, 0)} {}
+
+  auto operator=(const Self &other) -> Self & {
+    if (this != &other) {
+      Node::release(std::exchange(root, other.root->retain()));
+      len = other.len;
+    }
+    return *this;
+  }
+
+  auto operator=(Self &&other) noexcept -> Self & {
+    std::swap(root, other.root);
+    std::swap(len, other.len);
+    return *this;
+  }
+
+  ~PersistentMap() { Node::release(root); }
+
+  [[nodiscard]] auto size() const -> usize { return len; }
+
+  [[nodiscard]] auto is_empty() const -> bool { return len == 0; }
+
+  [[nodiscard]] auto get(const K &key) const -> Option<const V &> {
+    const auto *entry = root->find(key, Self::hash(key));
+    if (entry == nullptr) {
+      return {};
+    }
+    return {entry->val};
+  }
+
+  [[nodiscard]] auto contains(const K &key) const -> bool {
+    return root->find(key, Self::hash(key)) != nullptr;
+  }
+
+  [[nodiscard]] auto set(K key, V val) const -> Self {
+    auto out = Self(*this);
+    out.set_mut(std::move(key), std::move(val), false);
+    return out;
+  }
+
+  [[nodiscard]] auto erase(const K &key) const -> Self {
+    auto out = Self(*this);
+    out.erase_mut(key, false);
+    return out;
+  }
+
+  [[nodiscard]] auto transient() const -> TransientMap<K, V, Hash> {
+    return TransientMap<K, V, Hash>(*this);
+  }
+
+  // Calls fn(key, val) for every entry, in hash order.
+  template <typename TF> auto for_each(TF &&fn) const -> void {
+    root->for_each(fn);
+  }
+
+private:
+  friend TransientMap<K, V, Hash>;
+
+  [[nodiscard]] static auto hash(const K &key) -> u64 {
+    return static_cast<u64>(Hash{}(key));
+  }
+
+  // `own` allows editing the nodes this map holds alone in place.
+  auto set_mut(K key, V val, const bool own) -> bool {
+    const auto hashed = Self::hash(key);
+    const bool unique = own && root->is_unique();
+    bool added = false;
+    auto *fresh =
+        Node::insert(root, unique, Entry{std::move(key), std::move(val)},
+                     hashed, 0, Hash{}, added);
+    if (!unique) {
+      Node::release(root);
+    }
+    root = fresh;
+    len += added ? 1 : 0;
+    return added;
+  }
+
+  auto erase_mut(const K &key, const bool own) -> bool {
+    const bool unique = own && root->is_unique();
+    bool removed = false;
+    auto *fresh = Node::erase(root, unique, key, Self::hash(key), 0, removed);
+    if (!removed) {
+      return false;
+    }
+    if (!unique) {
+      Node::release(root);
+    }
+    root = fresh;
+    --len;
+    return true;
+  }
+};
+
+// Mutable builder over a PersistentMap. The first edit of a shared node
+// copies it as usual, but the copy belongs to the transient alone, so later
+// edits reuse it instead of copying again.
+template <typename K, typename V, typename Hash = std::hash<K>>
+struct TransientMap {
+  using Self = TransientMap<K, V, Hash>;
+  using Map = PersistentMap<K, V, Hash>;
+
+  Map map;
+
+  explicit TransientMap(Map _map) : map{std::move(_map)} {}
+
+  [[nodiscard]] auto size() const -> usize { return map.size(); }
+
+  [[nodiscard]] auto get(const K &key) const -> Option<const V &> {
+    return map.get(key);
+  }
+
+  // Returns true if the key was new.
+  auto set(K key, V val) -> bool {
+    return map.set_mut(std::move(key), std::move(val), true);
+  }
+
+  // Returns true if the key was present.
+  auto erase(const K &key) -> bool { return map.erase_mut(key, true); }
+
+  [[nodiscard]] auto persistent() && -> Map { return std::move(map); }
+};
+
+} // namespace exl
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <exl/function.hpp>
+#include <exl/mem.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace exl {
+
+// Fixed set of worker threads for fork-join loops. run() hands out task
+// indices through one atomic counter; the calling thread takes tasks too, so
+// a pool of one thread is the caller alone and spawns nothing.
+//
+// Tasks must not call run() on the pool that runs them.
+struct ThreadPool {
+  // Points at run()'s argument, which outlives the job.
+  struct Job {
+    const FnRef<void(usize)> *task;
+    usize count;
+  };
+
+  std::vector<std::thread> workers;
+  std::mutex run_lock;
+
+  std::mutex lock;
+  std::condition_variable wake;
+  std::condition_variable done;
+  Job job{};
+  u64 generation{};
+  usize active{};
+  bool stopping{};
+
+  alignas(CACHE_LINE) std::atomic<usize> next{};
+
+  explicit ThreadPool(const usize _threads) {
+    for (usize i = 1; i < std::max<usize>(_threads, 1); ++i) {
+      workers.emplace_back([this] { this->work(); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+
+  ~ThreadPool() {
+    {
+      const auto guard = std::lock_guard(lock);
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers) {
+      worker.join();
+    }
+  }
+
+  // Pool sized to the machine, created on first use.
+  [[nodiscard]] static auto global() -> ThreadPool & {
+    static auto pool = ThreadPool(std::thread::hardware_concurrency());
+    return pool;
+  }
+
+  [[nodiscard]] auto size() const -> usize { return workers.size() + 1; }
+
+  // Calls task(i) for every i in [0, count) and returns once all are done.
+  auto run(const usize count, const FnRef<void(usize)> task) -> void {
+    if (count == 0) {
+      return;
+    }
+    if (workers.empty() || count == 1) {
+      for (usize i = 0; i < count; ++i) {
+        task(i);
+      }
+      return;
+    }
+    const auto serial = std::lock_guard(run_lock);
+    {
+      const auto guard = std::lock_guard(lock);
+      job = {&task, count};
+      next.store(0, std::memory_order_relaxed);
+      active = workers.size();
+      ++generation;
+    }
+    wake.notify_all();
+    this->drain(job);
+    auto guard = std::unique_lock(lock);
+    done.wait(guard, [this] { return active == 0; });
+  }
+
+private:
+  auto drain(const Job &current) -> void {
+    for (;;) {
+      const auto at = next.fetch_add(1, std::memory_order_relaxed);
+      if (at >= current.count) {
+        return;
+      }
+      (*current.task)(at);
+    }
+  }
+
+  auto work() -> void {
+    u64 seen = 0;
+    for (;;) {
+      auto current = Job{};
+      {
+        auto guard = std::unique_lock(lock);
+        wake.wait(guard, [&] { return stopping || generation != seen; });
+        if (stopping) {
+          return;
+        }
+        seen = generation;
+        current = job;
+      }
+      this->drain(current);
+      {
+        const auto guard = std::lock_guard(lock);
+        if (--active != 0) {
+          continue;
+        }
+      }
+      done.notify_one();
+    }
+  }
+};
+
+} // namespace exl
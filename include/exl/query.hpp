@@ -0,0 +1,217 @@
+#pragma once
+
+#include <exl/check.hpp>
+#include <exl/option.hpp>
+#include <exl/reflection.hpp>
+#include <exl/types.hpp>
+
+#include <concepts>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace exl::query::impl {
+
+// A memoized cell: an input or the result of a derived query for one key.
+// `refresh` brings a derived cell up to date and is null for inputs, which
+// change only when set.
+struct Node {
+  using Refresh = void (*)(void *, Node &);
+
+  u64 changed_at{};
+  u64 verified_at{};
+  std::vector<Node *> deps;
+  Refresh refresh{};
+  void *owner{};
+  bool running{};
+};
+
+} // namespace exl::query::impl
+
+namespace exl::query {
+
+// Revision counter shared by the inputs and queries built on it, plus the
+// stack of running queries that reads are recorded against.
+struct Database {
+  u64 revision{1};
+  std::vector<impl::Node *> running;
+
+  [[nodiscard]] auto current() const -> u64 { return revision; }
+
+  // Makes `node` a dependency of the innermost running query.
+  auto read(impl::Node &node) -> void {
+    if (running.empty()) {
+      return;
+    }
+    auto &deps = running.back()->deps;
+    if (deps.empty() || deps.back() != &node) {
+      deps.push_back(&node);
+    }
+  }
+
+  // Whether `node` changed after `revision`, refreshing it first if derived.
+  [[nodiscard]] auto changed_after(impl::Node &node, const u64 revision)
+      -> bool {
+    if (node.refresh != nullptr) {
+      node.refresh(node.owner, node);
+    }
+    return node.changed_at > revision;
+  }
+};
+
+// Base values that queries read. Setting one starts a new revision unless
+// the value is equal to the current one.
+template <typename K, typename V> struct Input {
+  using Key = K;
+  using Val = V;
+
+  struct Entry : impl::Node {
+    std::optional<V> value;
+  };
+
+  Database *db;
+  std::unordered_map<K, Entry, reflection::MemberHash, reflection::MemberEq>
+      entries;
+
+  explicit Input(Database &_db) : db{&_db} {}
+
+  Input(const Input &) = delete;
+  auto operator=(const Input &) -> Input & = delete;
+
+  // Recorded as a dependency even when unset, so that setting it later
+  // invalidates the reader.
+  [[nodiscard]] auto get(const K &key) -> Option<const V &> {
+    auto &entry = entries[key];
+    db->read(entry);
+    if (!entry.value) {
+      return {};
+    }
+    return {*entry.value};
+  }
+
+  auto set(const K &key, V value) -> void {
+    if (!db->running.empty()) [[unlikely]] {
+      panic("Inputs cannot change while a query runs");
+    }
+    auto &entry = entries[key];
+    if constexpr (std::equality_comparable<V>) {
+      if (entry.value && *entry.value == value) {
+        return;
+      }
+    }
+    entry.value = std::move(value);
+    entry.changed_at = ++db->revision;
+  }
+};
+
+// A memoized function from K to Result<T, E>; errors are cached like any
+// other result. `fn(query, key)` computes a value and may call get() on
+// this query or on any other query or input: every such read becomes a
+// dependency edge.
+//
+// A cached result is reused after inputs change if none of its
+// dependencies changed since it was last verified (green). Otherwise it is
+// recomputed (red), and if the new result equals the old one its change
+// revision is kept, so queries that depend on it stay green.
+//
+// Results stay valid until the next Input::set.
+template <typename K, typename T, typename E, typename Fn> struct Derived {
+  using Key = K;
+  using Out = Result<T, E>;
+
+  struct Entry : impl::Node {
+    std::optional<Out> value;
+    const K *key{};
+  };
+
+  Database *db;
+  Fn fn;
+  std::unordered_map<K, Entry, reflection::MemberHash, reflection::MemberEq>
+      entries;
+  usize executions{};
+
+  explicit Derived(Database &_db, Fn _fn) : db{&_db}, fn{std::move(_fn)} {}
+
+  Derived(const Derived &) = delete;
+  auto operator=(const Derived &) -> Derived & = delete;
+
+  [[nodiscard]] auto database() const -> Database & { return *db; }
+
+  [[nodiscard]] auto get(const K &key) -> const Out & {
+    auto [it, fresh] = entries.try_emplace(key);
+    auto &entry = it->second;
+    if (fresh) {
+      entry.refresh = &Derived::refresh_node;
+      entry.owner = this;
+      entry.key = &it->first;
+    }
+    this->refresh(entry);
+    db->read(entry);
+    return *entry.value;
+  }
+
+private:
+  static auto refresh_node(void *owner, impl::Node &node) -> void {
+    static_cast<Derived *>(owner)->refresh(static_cast<Entry &>(node));
+  }
+
+  auto refresh(Entry &entry) -> void {
+    const auto now = db->current();
+    if (entry.value && entry.verified_at == now) {
+      return;
+    }
+    if (entry.running) [[unlikely]] {
+      panic("Query depends on itself");
+    }
+    if (entry.value && !this->deps_changed(entry)) {
+      entry.verified_at = now;
+      return;
+    }
+    this->execute(entry);
+  }
+
+  [[nodiscard]] auto deps_changed(Entry &entry) -> bool {
+    entry.running = true;
+    const auto since = entry.verified_at;
+    auto changed = false;
+    for (auto *dep : entry.deps) {
+      if (db->changed_after(*dep, since)) {
+        changed = true;
+        break;
+      }
+    }
+    entry.running = false;
+    return changed;
+  }
+
+  auto execute(Entry &entry) -> void {
+    ++executions;
+    entry.deps.clear();
+    entry.running = true;
+    db->running.push_back(&entry);
+    auto out = fn(*this, *entry.key);
+    db->running.pop_back();
+    entry.running = false;
+
+    const auto now = db->current();
+    auto same = false;
+    if constexpr (std::equality_comparable<Out>) {
+      same = entry.value && *entry.value == out;
+    }
+    if (!same) {
+      entry.value.emplace(std::move(out));
+      entry.changed_at = now;
+    }
+    entry.verified_at = now;
+  }
+};
+
+// Declares a query. T and E are spelled out since fn usually calls back
+// into the query it defines.
+template <typename K, typename T, typename E, typename Fn>
+[[nodiscard]] auto derived(Database &db, Fn fn) -> Derived<K, T, E, Fn> {
+  return Derived<K, T, E, Fn>(db, std::move(fn));
+}
+
+} // namespace exl::query
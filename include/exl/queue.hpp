@@ -0,0 +1,266 @@
+#pragma once
+
+#include <exl/mem.hpp>
+#include <exl/option.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <new>
+
+namespace exl {
+
+// Single producer, single consumer ring. Each side keeps a cached copy of the
+// other side's index and only reloads it when the ring looks full or empty.
+template <typename T, usize N> struct SpscQueue {
+  static_assert(N > 0 && std::has_single_bit(N),
+                "SpscQueue capacity must be a power of two");
+
+  using Self = SpscQueue<T, N>;
+  using Val = T;
+  using Ptr = T *;
+  using Ref = T &;
+
+  static constexpr usize MASK = N - 1;
+
+  alignas(CACHE_LINE) std::atomic<usize> head{};
+  usize tail_cache{};
+
+  alignas(CACHE_LINE) std::atomic<usize> tail{};
+  usize head_cache{};
+
+  alignas(CACHE_LINE) alignas(T) std::byte storage[N * sizeof(T)]; // NOLINT
+
+  [[nodiscard]] auto slot(const usize pos) -> Ptr {
+    return std::launder(ptr::cast<T>(storage) + (pos & MASK));
+  }
+
+  [[nodiscard]] static constexpr auto capacity() -> usize { return N; }
+
+  [[nodiscard]] auto size() const -> usize {
+    return tail.load(std::memory_order_acquire) -
+           head.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] auto is_empty() const -> bool { return this->size() == 0; }
+
+  // Returns the value back to the caller if the ring is full.
+  [[nodiscard]] auto try_push(T val) -> Option<T> {
+    const auto pos = tail.load(std::memory_order_relaxed);
+    if (pos - head_cache == N) {
+      head_cache = head.load(std::memory_order_acquire);
+      if (pos - head_cache == N) {
+        return {std::move(val)};
+      }
+    }
+
+    new (this->slot(pos)) T(std::move(val));
+    tail.store(pos + 1, std::memory_order_release);
+    return {};
+  }
+
+  [[nodiscard]] auto try_pop() -> Option<T> {
+    const auto pos = head.load(std::memory_order_relaxed);
+    if (pos == tail_cache) {
+      tail_cache = tail.load(std::memory_order_acquire);
+      if (pos == tail_cache) {
+        return {};
+      }
+    }
+
+    auto *elem = this->slot(pos);
+    auto ret = Option<T>(std::move(*elem));
+    elem->~T();
+    head.store(pos + 1, std::memory_order_release);
+    return ret;
+  }
+
+  // Moves as many items as fit, publishing them with a single store.
+  [[nodiscard]] auto push_batch(const Slice<T> items) -> usize {
+    const auto pos = tail.load(std::memory_order_relaxed);
+    if (N - (pos - head_cache) < items.cap) {
+      head_cache = head.load(std::memory_order_acquire);
+    }
+
+    const auto len = std::min(items.cap, N - (pos - head_cache));
+    for (usize i = 0; i < len; ++i) {
+      new (this->slot(pos + i)) T(std::move(items.as_ref(i)));
+    }
+    tail.store(pos + len, std::memory_order_release);
+    return len;
+  }
+
+  [[nodiscard]] auto pop_batch(const Slice<T> out) -> usize {
+    const auto pos = head.load(std::memory_order_relaxed);
+    if (tail_cache - pos < out.cap) {
+      tail_cache = tail.load(std::memory_order_acquire);
+    }
+
+    const auto len = std::min(out.cap, tail_cache - pos);
+    for (usize i = 0; i < len; ++i) {
+      auto *elem = this->slot(pos + i);
+      out.as_ref(i) = std::move(*elem);
+      elem->~T();
+    }
+    head.store(pos + len, std::memory_order_release);
+    return len;
+  }
+
+  [[nodiscard]] SpscQueue() = default;
+
+  SpscQueue(const SpscQueue &) = delete;
+  SpscQueue(SpscQueue &&) = delete;
+  auto operator=(const SpscQueue &) -> SpscQueue & = delete;
+  auto operator=(SpscQueue &&) -> SpscQueue & = delete;
+
+  ~SpscQueue() {
+    const auto last = tail.load(std::memory_order_relaxed);
+    for (auto pos = head.load(std::memory_order_relaxed); pos != last; ++pos) {
+      this->slot(pos)->~T();
+    }
+  }
+};
+
+// Bounded multi producer, multi consumer ring after Dmitry Vyukov's design.
+// Every cell carries a sequence number telling which lap of the ring may
+// write or read it next, so producers and consumers only contend on their
+// own position counter.
+template <typename T> struct MpmcQueue {
+  using Self = MpmcQueue<T>;
+  using Val = T;
+  using Ptr = T *;
+  using Ref = T &;
+
+  struct Cell {
+    std::atomic<usize> seq;
+    alignas(T) std::byte data[sizeof(T)]; // NOLINT
+
+    [[nodiscard]] auto as_ptr() -> Ptr {
+      return std::launder(ptr::cast<T>(data));
+    }
+  };
+
+  Cell *cells{};
+  usize mask{};
+
+  alignas(CACHE_LINE) std::atomic<usize> enqueue_pos{};
+  alignas(CACHE_LINE) std::atomic<usize> dequeue_pos{};
+
+  [[nodiscard]] auto capacity() const -> usize { return mask + 1; }
+
+  [[nodiscard]] auto size() const -> usize {
+    return enqueue_pos.load(std::memory_order_acquire) -
+           dequeue_pos.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] auto is_empty() const -> bool { return this->size() == 0; }
+
+  // Returns the value back to the caller if the ring is full.
+  [[nodiscard]] auto try_push(T val) -> Option<T> {
+    auto pos = enqueue_pos.load(std::memory_order_relaxed);
+    auto len = this->claim(enqueue_pos, pos, 0, 1);
+    if (len == 0) {
+      return {std::move(val)};
+    }
+
+    auto &cell = cells[pos & mask];
+    new (cell.as_ptr()) T(std::move(val));
+    cell.seq.store(pos + 1, std::memory_order_release);
+    return {};
+  }
+
+  [[nodiscard]] auto try_pop() -> Option<T> {
+    auto pos = dequeue_pos.load(std::memory_order_relaxed);
+    auto len = this->claim(dequeue_pos, pos, 1, 1);
+    if (len == 0) {
+      return {};
+    }
+
+    auto &cell = cells[pos & mask];
+    auto ret = Option<T>(std::move(*cell.as_ptr()));
+    cell.as_ptr()->~T();
+    cell.seq.store(pos + mask + 1, std::memory_order_release);
+    return ret;
+  }
+
+  // Claims a run of consecutive cells with one CAS and fills as many as are
+  // ready, returning how many items were moved.
+  [[nodiscard]] auto push_batch(const Slice<T> items) -> usize {
+    auto pos = enqueue_pos.load(std::memory_order_relaxed);
+    auto len = this->claim(enqueue_pos, pos, 0, items.cap);
+
+    for (usize i = 0; i < len; ++i) {
+      auto &cell = cells[(pos + i) & mask];
+      new (cell.as_ptr()) T(std::move(items.as_ref(i)));
+      cell.seq.store(pos + i + 1, std::memory_order_release);
+    }
+    return len;
+  }
+
+  [[nodiscard]] auto pop_batch(const Slice<T> out) -> usize {
+    auto pos = dequeue_pos.load(std::memory_order_relaxed);
+    auto len = this->claim(dequeue_pos, pos, 1, out.cap);
+
+    for (usize i = 0; i < len; ++i) {
+      auto &cell = cells[(pos + i) & mask];
+      out.as_ref(i) = std::move(*cell.as_ptr());
+      cell.as_ptr()->~T();
+      cell.seq.store(pos + i + mask + 1, std::memory_order_release);
+    }
+    return len;
+  }
+
+  [[nodiscard]] explicit MpmcQueue(const usize _capacity)
+      : cells{new Cell[std::bit_ceil(std::max<usize>(_capacity, 2))]},
+        mask{std::bit_ceil(std::max<usize>(_capacity, 2)) - 1} {
+    for (usize i = 0; i <= mask; ++i) {
+      cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpmcQueue(const MpmcQueue &) = delete;
+  MpmcQueue(MpmcQueue &&) = delete;
+  auto operator=(const MpmcQueue &) -> MpmcQueue & = delete;
+  auto operator=(MpmcQueue &&) -> MpmcQueue & = delete;
+
+  ~MpmcQueue() {
+    while (this->try_pop().is_some()) {
+    }
+    delete[] cells;
+  }
+
+  // A cell at `pos` is ready when its sequence equals `pos + lap`, where lap
+  // is 0 for producers and 1 for consumers. Counts the ready run starting at
+  // `pos`, then advances the shared counter over it.
+  [[nodiscard]] auto claim(std::atomic<usize> &counter, usize &pos,
+                           const usize lap, const usize max) -> usize {
+    while (max > 0) {
+      usize len = 0;
+      while (len < max) {
+        const auto seq =
+            cells[(pos + len) & mask].seq.load(std::memory_order_acquire);
+        if (seq != pos + len + lap) {
+          if (len == 0 && static_cast<ssize>(seq - (pos + lap)) < 0) {
+            return 0;
+          }
+          break;
+        }
+        ++len;
+      }
+
+      if (len == 0) {
+        pos = counter.load(std::memory_order_relaxed);
+        continue;
+      }
+
+      if (counter.compare_exchange_weak(pos, pos + len,
+                                        std::memory_order_relaxed)) {
+        return len;
+      }
+    }
+    return 0;
+  }
+};
+
+} // namespace exl
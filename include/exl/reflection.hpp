@@ -10,6 +10,12 @@
 
 #include <exl/types.hpp>
 
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <functional>
+#include <ranges>
+
 namespace exl::reflection {
 
 template <typename T>
@@ -374,4 +380,123 @@ constexpr auto visit_members(auto &&object, auto &&visitor) -> decltype(auto) {
 }
 // NOLINTEND
 
+namespace impl {
+// Converts only to aggregate classes of more than one field, std::array
+// included, the members that unique_fields_v miscounts. One-field wrappers
+// are fine.
+template <typename U>
+concept NestedAggregate =
+    std::is_class_v<U> && Aggregate<U> && (num_aggregate_fields_v<U> > 1);
+
+struct NestedProbe {
+  template <NestedAggregate U> constexpr operator U &() const noexcept;
+  template <NestedAggregate U> constexpr operator U &&() const noexcept;
+};
+
+template <Aggregate T, typename Indices> struct nested_after;
+
+template <Aggregate T, usize... Indices>
+struct nested_after<T, std::index_sequence<Indices...>>
+    : std::bool_constant<requires {
+        T{std::declval<IndexedUniversal<Indices>>()...,
+          std::declval<NestedProbe>()};
+      }> {};
+
+template <Aggregate T, typename Indices> struct has_nested_aggregate;
+
+template <Aggregate T, usize... Counts>
+struct has_nested_aggregate<T, std::index_sequence<Counts...>>
+    : std::bool_constant<(
+          nested_after<T, std::make_index_sequence<Counts>>::value || ...)> {
+};
+} // namespace impl
+
+// Aggregates whose fields visit_members can count: no member is itself an
+// aggregate or std::array of several fields. C arrays are fine.
+template <typename T>
+concept FlatAggregate =
+    Aggregate<T> && !std::is_array_v<T> &&
+    !impl::has_nested_aggregate<
+        T, std::make_index_sequence<num_aggregate_fields_v<T>>>::value;
+
+template <typename T>
+concept StdHashable = requires(const T &object) {
+  { std::hash<T>{}(object) } -> std::convertible_to<usize>;
+};
+
+// Hashes with std::hash where T has it, and otherwise element by element
+// for ranges and field by field for flat aggregates, folding FxHash style.
+// A type whose operator== ignores some of its fields must specialize
+// std::hash to match.
+template <typename T>
+[[nodiscard]] constexpr auto hash_members(const T &object) -> u64 {
+  const auto fold = [](u64 hash, const u64 next) {
+    return (std::rotl(hash, 5) ^ next) * 0x517cc1b727220a95ULL;
+  };
+  if constexpr (StdHashable<T>) {
+    return static_cast<u64>(std::hash<T>{}(object));
+  } else if constexpr (std::ranges::range<T>) {
+    u64 hash = 0;
+    for (const auto &elem : object) {
+      hash = fold(hash, hash_members(elem));
+    }
+    return hash;
+  } else if constexpr (FlatAggregate<T>) {
+    return visit_members(object, [&fold](const auto &...fields) {
+      u64 hash = 0;
+      ((hash = fold(hash, hash_members(fields))), ...);
+      return hash;
+    });
+  } else {
+    static_assert(Aggregate<T>,
+                  "hash_members needs std::hash or an aggregate");
+    static_assert(FlatAggregate<T>,
+                  "hash_members cannot count past aggregate or std::array "
+                  "members; give the type std::hash");
+    return u64{};
+  }
+}
+
+// Compares with operator== where T has it, and otherwise element by
+// element for arrays and field by field for flat aggregates.
+template <typename T>
+[[nodiscard]] constexpr auto equal_members(const T &lhs, const T &rhs)
+    -> bool {
+  if constexpr (std::is_array_v<T>) {
+    return std::ranges::equal(lhs, rhs, [](const auto &a, const auto &b) {
+      return equal_members(a, b);
+    });
+  } else if constexpr (std::equality_comparable<T>) {
+    return lhs == rhs;
+  } else if constexpr (FlatAggregate<T>) {
+    return visit_members(lhs, [&rhs](const auto &...lhs_fields) {
+      return visit_members(rhs, [&](const auto &...rhs_fields) {
+        return (equal_members(lhs_fields, rhs_fields) && ...);
+      });
+    });
+  } else {
+    static_assert(Aggregate<T>,
+                  "equal_members needs operator== or an aggregate");
+    static_assert(FlatAggregate<T>,
+                  "equal_members cannot count past aggregate or std::array "
+                  "members; give the type operator==");
+    return false;
+  }
+}
+
+struct MemberHash {
+  template <typename T>
+  [[nodiscard]] constexpr auto operator()(const T &object) const -> usize {
+    return hash_members(object);
+  }
+};
+
+struct MemberEq {
+  template <typename T>
+  [[nodiscard]] constexpr auto operator()(const T &lhs, const T &rhs) const
+      -> bool {
+    return equal_members(lhs, rhs);
+  }
+};
+
 } // namespace exl::reflection
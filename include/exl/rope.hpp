@@ -0,0 +1,687 @@
+#pragma once
+
+#include <exl/bytes.hpp>
+#include <exl/check.hpp>
+#include <exl/mem.hpp>
+#include <exl/option.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace exl::impl {
+
+// What a subtree of a rope holds: bytes, newlines and UTF-8 code points.
+// Code points are counted by their lead bytes, so the counts add up across
+// any split, even one inside a character.
+struct RopeSummary {
+  usize bytes{};
+  usize lines{};
+  usize chars{};
+
+  // Eight bytes at a time: each byte lane of an accumulator counts the
+  // hits in its column, and the lanes are folded before they overflow.
+  [[nodiscard]] static auto of(const Slice<const u8> text) -> RopeSummary {
+    constexpr u64 HIGH = 0x8080808080808080ULL;
+    constexpr u64 LOW7 = 0x7f7f7f7f7f7f7f7fULL;
+    constexpr u64 NEWLINES = 0x0a0a0a0a0a0a0a0aULL;
+    constexpr usize FOLD = 255 * 8;
+    const auto fold = [](const u64 lanes) -> usize {
+      const auto pairs = (lanes & 0x00ff00ff00ff00ffULL) +
+                         ((lanes >> 8) & 0x00ff00ff00ff00ffULL);
+      return (pairs * 0x0001000100010001ULL) >> 48;
+    };
+    const auto *src = text.data();
+    const auto len = text.size();
+    usize lines = 0;
+    usize tails = 0;
+    usize at = 0;
+    while (len - at >= 8) {
+      const auto stop = at + std::min(FOLD, (len - at) & ~usize{7});
+      u64 newline_lanes = 0;
+      u64 tail_lanes = 0;
+      for (; at < stop; at += 8) {
+        u64 word{};
+        std::memcpy(&word, src + at, sizeof(word));
+        const auto diff = word ^ NEWLINES;
+        newline_lanes += (~(((diff & LOW7) + LOW7) | diff) & HIGH) >> 7;
+        tail_lanes += (word & ~(word << 1) & HIGH) >> 7;
+      }
+      lines += fold(newline_lanes);
+      tails += fold(tail_lanes);
+    }
+    for (; at < len; ++at) {
+      lines += src[at] == '\n' ? 1 : 0;
+      tails += (src[at] & 0xc0) == 0x80 ? 1 : 0;
+    }
+    return {len, lines, len - tails};
+  }
+
+  auto operator+=(const RopeSummary &other) -> RopeSummary & {
+    bytes += other.bytes;
+    lines += other.lines;
+    chars += other.chars;
+    return *this;
+  }
+
+  [[nodiscard]] auto operator-(const RopeSummary &other) const
+      -> RopeSummary {
+    return {bytes - other.bytes, lines - other.lines, chars - other.chars};
+  }
+};
+
+struct RopeNode;
+
+// Counted reference to an immutable rope node. Null is the empty rope.
+struct RopeRef {
+  RopeNode *ptr{};
+
+  RopeRef() = default;
+  explicit RopeRef(RopeNode *_ptr) : ptr{_ptr} {}
+  RopeRef(const RopeRef &other);
+  RopeRef(RopeRef &&other) noexcept : ptr{std::exchange(other.ptr, nullptr)} {}
+  auto operator=(RopeRef other) noexcept -> RopeRef & {
+    std::swap(ptr, other.ptr);
+    return *this;
+  }
+  ~RopeRef();
+
+  [[nodiscard]] auto operator->() const -> RopeNode * { return ptr; }
+  [[nodiscard]] explicit operator bool() const { return ptr != nullptr; }
+};
+
+// B-tree node. Leaves hold one chunk of text; internal nodes hold up to
+// MAX_CHILDREN subtrees of equal height together with their summaries, so
+// offset, line and character lookups descend without touching the
+// children they skip.
+struct RopeNode {
+  static constexpr usize MIN_LEAF = 512;
+  static constexpr usize MAX_LEAF = 1024;
+  static constexpr u32 MIN_CHILDREN = 4;
+  static constexpr u32 MAX_CHILDREN = 8;
+
+  std::atomic<u32> refs{1};
+  u32 height{};
+  u32 len{};
+  RopeSummary sum;
+  Bytes text;
+  std::array<RopeRef, MAX_CHILDREN> children;
+  std::array<RopeSummary, MAX_CHILDREN> sums;
+
+  [[nodiscard]] auto is_leaf() const -> bool { return height == 0; }
+
+  [[nodiscard]] auto kids() const -> std::span<const RopeRef> {
+    return {children.data(), len};
+  }
+
+  // Whether the node can sit in a tree without being merged first.
+  [[nodiscard]] auto is_ok_child() const -> bool {
+    return this->is_leaf() ? text.size() >= MIN_LEAF : len >= MIN_CHILDREN;
+  }
+
+  [[nodiscard]] static auto leaf(Bytes text, const RopeSummary &sum)
+      -> RopeRef {
+    auto *node = new RopeNode(); // NOLINT
+    node->sum = sum;
+    node->text = std::move(text);
+    return RopeRef(node);
+  }
+
+  [[nodiscard]] static auto leaf(Bytes text) -> RopeRef {
+    const auto sum = RopeSummary::of(text.as_slice());
+    return leaf(std::move(text), sum);
+  }
+
+  [[nodiscard]] static auto branch(const std::span<const RopeRef> kids)
+      -> RopeRef {
+    auto *node = new RopeNode(); // NOLINT
+    node->height = kids[0]->height + 1;
+    node->len = static_cast<u32>(kids.size());
+    for (usize i = 0; i < kids.size(); ++i) {
+      node->children[i] = kids[i];
+      node->sums[i] = kids[i]->sum;
+      node->sum += kids[i]->sum;
+    }
+    return RopeRef(node);
+  }
+
+  // One node for a run of siblings; a single sibling stands for itself.
+  [[nodiscard]] static auto group(const std::span<const RopeRef> kids)
+      -> RopeRef {
+    if (kids.empty()) {
+      return {};
+    }
+    return kids.size() == 1 ? kids[0] : branch(kids);
+  }
+
+  // Stacks levels of evenly filled parents over nodes of equal height.
+  [[nodiscard]] static auto from_nodes(std::vector<RopeRef> level)
+      -> RopeRef {
+    if (level.empty()) {
+      return {};
+    }
+    while (level.size() > 1) {
+      const auto parents = (level.size() + MAX_CHILDREN - 1) / MAX_CHILDREN;
+      auto next = std::vector<RopeRef>();
+      next.reserve(parents);
+      usize at = 0;
+      for (usize i = 0; i < parents; ++i) {
+        const auto take = (level.size() - at) / (parents - i);
+        next.push_back(branch({level.data() + at, take}));
+        at += take;
+      }
+      level = std::move(next);
+    }
+    return std::move(level[0]);
+  }
+
+  // Cuts `text` into evenly sized leaves that share its allocation.
+  [[nodiscard]] static auto build(const Bytes &text) -> RopeRef {
+    if (text.is_empty()) {
+      return {};
+    }
+    const auto count = (text.size() + MAX_LEAF - 1) / MAX_LEAF;
+    auto leaves = std::vector<RopeRef>();
+    leaves.reserve(count);
+    usize at = 0;
+    for (usize i = 0; i < count; ++i) {
+      const auto take = (text.size() - at) / (count - i);
+      leaves.push_back(leaf(text.slice(at, at + take).unwrap()));
+      at += take;
+    }
+    return from_nodes(std::move(leaves));
+  }
+
+  [[nodiscard]] static auto merge_nodes(const std::span<const RopeRef> lhs,
+                                        const std::span<const RopeRef> rhs)
+      -> RopeRef {
+    auto all = std::array<RopeRef, 2 * MAX_CHILDREN>{};
+    std::copy(lhs.begin(), lhs.end(), all.begin());
+    std::copy(rhs.begin(), rhs.end(), all.begin() + lhs.size());
+    const auto total = lhs.size() + rhs.size();
+    if (total <= MAX_CHILDREN) {
+      return branch({all.data(), total});
+    }
+    const auto half = total / 2;
+    const auto pair = std::array{branch({all.data(), half}),
+                                 branch({all.data() + half, total - half})};
+    return branch(pair);
+  }
+
+  [[nodiscard]] static auto merge_leaves(const RopeRef &lhs,
+                                         const RopeRef &rhs) -> RopeRef {
+    if (lhs->is_ok_child() && rhs->is_ok_child()) {
+      return branch(std::array{lhs, rhs});
+    }
+    auto joined = BytesMut::with_capacity(lhs->sum.bytes + rhs->sum.bytes);
+    joined.append(lhs->text.as_slice());
+    joined.append(rhs->text.as_slice());
+    return build(joined.freeze());
+  }
+
+  // Joins two trees in O(|height difference|): the lower one is merged
+  // into the near edge of the higher one. Follows the concatenation of
+  // xi-editor's rope.
+  [[nodiscard]] static auto concat(const RopeRef &lhs, const RopeRef &rhs)
+      -> RopeRef {
+    if (!lhs) {
+      return rhs;
+    }
+    if (!rhs) {
+      return lhs;
+    }
+    const auto lhs_height = lhs->height;
+    const auto rhs_height = rhs->height;
+    if (lhs_height < rhs_height) {
+      const auto kids = rhs->kids();
+      if (lhs_height + 1 == rhs_height && lhs->is_ok_child()) {
+        return merge_nodes({&lhs, 1}, kids);
+      }
+      const auto joined = concat(lhs, kids[0]);
+      if (joined->height + 1 == rhs_height) {
+        return merge_nodes({&joined, 1}, kids.subspan(1));
+      }
+      return merge_nodes(joined->kids(), kids.subspan(1));
+    }
+    if (lhs_height > rhs_height) {
+      const auto kids = lhs->kids();
+      if (rhs_height + 1 == lhs_height && rhs->is_ok_child()) {
+        return merge_nodes(kids, {&rhs, 1});
+      }
+      const auto joined = concat(kids.back(), rhs);
+      if (joined->height + 1 == lhs_height) {
+        return merge_nodes(kids.first(kids.size() - 1), {&joined, 1});
+      }
+      return merge_nodes(kids.first(kids.size() - 1), joined->kids());
+    }
+    if (lhs->is_ok_child() && rhs->is_ok_child()) {
+      return branch(std::array{lhs, rhs});
+    }
+    if (lhs_height == 0) {
+      return merge_leaves(lhs, rhs);
+    }
+    return merge_nodes(lhs->kids(), rhs->kids());
+  }
+
+  // Small edits that stay inside one leaf rewrite just that leaf and copy
+  // the path above it. Null when the edit crosses leaves or would take the
+  // leaf out of its size bounds; any size is fine for a lone root leaf.
+  [[nodiscard]] static auto patch(const RopeRef &node, const usize start,
+                                  const usize end, const std::string_view text,
+                                  const bool root) -> RopeRef {
+    if (node->is_leaf()) {
+      const auto &old = node->text;
+      const auto len = old.size() - (end - start) + text.size();
+      if (len > MAX_LEAF || len == 0 || (len < MIN_LEAF && !root)) {
+        return {};
+      }
+      const auto part = [&](const usize from, const usize to) {
+        return Slice<const u8>(old.data() + from, to - from);
+      };
+      const auto added = Slice<const u8>(ptr::cast<const u8>(text.data()),
+                                         text.size());
+      auto joined = BytesMut::with_capacity(len);
+      joined.append(part(0, start));
+      joined.append(added);
+      joined.append(part(end, old.size()));
+      auto sum = node->sum - RopeSummary::of(part(start, end));
+      sum += RopeSummary::of(added);
+      return leaf(joined.freeze(), sum);
+    }
+    usize base = 0;
+    u32 at = 0;
+    while (at + 1 < node->len && start >= base + node->sums[at].bytes) {
+      base += node->sums[at++].bytes;
+    }
+    if (end > base + node->sums[at].bytes) {
+      return {};
+    }
+    auto child = patch(node->children[at], start - base, end - base, text,
+                       false);
+    if (!child) {
+      return {};
+    }
+    auto kids = std::array<RopeRef, MAX_CHILDREN>{};
+    std::copy(node->kids().begin(), node->kids().end(), kids.begin());
+    kids[at] = std::move(child);
+    return branch({kids.data(), node->len});
+  }
+
+  // Both halves share every node off the path to `offset`.
+  [[nodiscard]] static auto split(const RopeRef &node, const usize offset)
+      -> std::pair<RopeRef, RopeRef> {
+    if (!node || offset == 0) {
+      return {{}, node};
+    }
+    if (offset >= node->sum.bytes) {
+      return {node, {}};
+    }
+    if (node->is_leaf()) {
+      // Only the shorter side is scanned; the other is what remains.
+      const auto &text = node->text;
+      auto head = text.slice(0, offset).unwrap();
+      auto tail = text.slice(offset, text.size()).unwrap();
+      if (offset <= text.size() / 2) {
+        const auto sum = RopeSummary::of(head.as_slice());
+        return {leaf(std::move(head), sum),
+                leaf(std::move(tail), node->sum - sum)};
+      }
+      const auto sum = RopeSummary::of(tail.as_slice());
+      return {leaf(std::move(head), node->sum - sum),
+              leaf(std::move(tail), sum)};
+    }
+    const auto kids = node->kids();
+    usize base = 0;
+    usize at = 0;
+    while (offset >= base + node->sums[at].bytes) {
+      base += node->sums[at++].bytes;
+    }
+    auto [lhs, rhs] = split(kids[at], offset - base);
+    return {concat(group(kids.first(at)), lhs),
+            concat(rhs, group(kids.subspan(at + 1)))};
+  }
+};
+
+inline RopeRef::RopeRef(const RopeRef &other) : ptr{other.ptr} {
+  if (ptr != nullptr) {
+    ptr->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+inline RopeRef::~RopeRef() {
+  if (ptr != nullptr &&
+      ptr->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete ptr; // NOLINT
+  }
+}
+
+} // namespace exl::impl
+
+namespace exl {
+
+// What an edit did to a rope, in byte offsets: [start, old_end) of the old
+// text became [start, new_end) of the new one.
+struct RopeDelta {
+  usize start;
+  usize old_end;
+  usize new_end;
+
+  // Where an offset into the old text ends up; offsets inside the replaced
+  // range move to its end.
+  [[nodiscard]] constexpr auto map(const usize offset) const -> usize {
+    if (offset < start) {
+      return offset;
+    }
+    if (offset < old_end) {
+      return new_end;
+    }
+    return offset - old_end + new_end;
+  }
+};
+
+// Chunks of a rope overlapping a byte range, each clipped to it, in order.
+struct RopeChunks {
+  static constexpr usize MAX_DEPTH = 32;
+
+  struct Iter {
+    using Self = Iter;
+    using Val = Slice<const u8>;
+
+    using value_type = Val;
+    using difference_type = ssize;
+
+    std::array<std::pair<const impl::RopeNode *, u32>, MAX_DEPTH> path{};
+    u32 depth{};
+    const impl::RopeNode *leaf{};
+    usize leaf_start{};
+    usize from{};
+    usize to{};
+
+    [[nodiscard]] auto operator*() const -> Val {
+      const auto head = std::max(from, leaf_start) - leaf_start;
+      const auto tail = std::min(to, leaf_start + leaf->sum.bytes) - leaf_start;
+      return Val(leaf->text.data() + head, tail - head);
+    }
+
+    auto operator++() -> Self & {
+      leaf_start += leaf->sum.bytes;
+      leaf = nullptr;
+      while (depth > 0) {
+        auto &[node, at] = path[depth - 1];
+        if (++at < node->len) {
+          this->descend(node->children[at].ptr);
+          return *this;
+        }
+        --depth;
+      }
+      return *this;
+    }
+
+    auto operator++(int) -> Self {
+      auto prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    [[nodiscard]] friend auto operator==(const Self &iter,
+                                         std::default_sentinel_t) -> bool {
+      return iter.leaf == nullptr || iter.leaf_start >= iter.to;
+    }
+
+    // Walks down the leftmost edge of `node`.
+    auto descend(const impl::RopeNode *node) -> void {
+      while (!node->is_leaf()) {
+        path[depth++] = {node, 0};
+        node = node->children[0].ptr;
+      }
+      leaf = node;
+    }
+  };
+
+  const impl::RopeNode *root{};
+  usize from{};
+  usize to{};
+
+  [[nodiscard]] auto begin() const -> Iter {
+    auto iter = Iter{};
+    iter.from = from;
+    iter.to = to;
+    if (root == nullptr || from >= to) {
+      return iter;
+    }
+    const auto *node = root;
+    usize base = 0;
+    while (!node->is_leaf()) {
+      u32 at = 0;
+      while (at + 1 < node->len && from >= base + node->sums[at].bytes) {
+        base += node->sums[at++].bytes;
+      }
+      iter.path[iter.depth++] = {node, at};
+      node = node->children[at].ptr;
+    }
+    iter.leaf = node;
+    iter.leaf_start = base;
+    return iter;
+  }
+
+  [[nodiscard]] auto end() const -> std::default_sentinel_t { return {}; }
+};
+
+// Text buffer for editors: a balanced B-tree of shared byte chunks.
+// Inserts, erases, slices and line or character lookups are O(log n), and
+// copying a rope shares every node, so snapshots are free. Edits return a
+// RopeDelta that relex_range() widens to the lines a lexer must rescan.
+//
+// Offsets are in bytes. Character positions count UTF-8 code points.
+struct Rope {
+  using Self = Rope;
+  using Node = impl::RopeNode;
+
+  impl::RopeRef root;
+
+  Rope() = default;
+
+  explicit Rope(const std::string_view text)
+      : root{Node::build(Bytes::copy_from(text))} {}
+
+  // Builds the rope over `text` without copying it.
+  [[nodiscard]] static auto from_bytes(const Bytes &text) -> Self {
+    auto rope = Self();
+    rope.root = Node::build(text);
+    return rope;
+  }
+
+  [[nodiscard]] auto size() const -> usize {
+    return root ? root->sum.bytes : 0;
+  }
+
+  [[nodiscard]] auto is_empty() const -> bool { return this->size() == 0; }
+
+  // Number of lines, counting the one after the last newline.
+  [[nodiscard]] auto lines() const -> usize {
+    return (root ? root->sum.lines : 0) + 1;
+  }
+
+  [[nodiscard]] auto chars() const -> usize {
+    return root ? root->sum.chars : 0;
+  }
+
+  [[nodiscard]] auto height() const -> usize {
+    return root ? root->height + 1 : 0;
+  }
+
+  [[nodiscard]] auto chunks(const usize start, const usize end) const
+      -> RopeChunks {
+    return {root.ptr, start, std::min(end, this->size())};
+  }
+
+  [[nodiscard]] auto chunks() const -> RopeChunks {
+    return this->chunks(0, this->size());
+  }
+
+  [[nodiscard]] auto slice(const usize start, const usize end) const -> Self {
+    this->check(end);
+    auto out = Self();
+    if (start < end) {
+      out.root = Node::split(Node::split(root, end).first, start).second;
+      out.normalize();
+    }
+    return out;
+  }
+
+  auto replace(const usize start, const usize end, const std::string_view text)
+      -> RopeDelta {
+    this->check(end);
+    if (start > end) [[unlikely]] {
+      exl::impl::panic_bounds(end, start);
+    }
+    if (root) {
+      if (auto patched = Node::patch(root, start, end, text, true)) {
+        root = std::move(patched);
+        return {start, end, start + text.size()};
+      }
+    }
+    auto [head, rest] = Node::split(root, start);
+    auto tail = Node::split(rest, end - start).second;
+    if (!text.empty()) {
+      head = Node::concat(head, Node::build(Bytes::copy_from(text)));
+    }
+    root = Node::concat(head, tail);
+    this->normalize();
+    return {start, end, start + text.size()};
+  }
+
+  auto insert(const usize offset, const std::string_view text) -> RopeDelta {
+    return this->replace(offset, offset, text);
+  }
+
+  auto erase(const usize start, const usize end) -> RopeDelta {
+    return this->replace(start, end, {});
+  }
+
+  // Byte offset where line `line` starts, counting from zero.
+  [[nodiscard]] auto line_start(usize line) const -> Option<usize> {
+    if (line == 0) {
+      return {usize{0}};
+    }
+    if (line >= this->lines()) {
+      return {};
+    }
+    const auto *node = root.ptr;
+    usize base = 0;
+    while (!node->is_leaf()) {
+      u32 at = 0;
+      while (line > node->sums[at].lines) {
+        line -= node->sums[at].lines;
+        base += node->sums[at++].bytes;
+      }
+      node = node->children[at].ptr;
+    }
+    const auto *const data = node->text.data();
+    const auto *at = data;
+    for (;; ++at) {
+      at = static_cast<const u8 *>(
+          std::memchr(at, '\n', node->text.size() - (at - data)));
+      if (--line == 0) {
+        return {base + static_cast<usize>(at - data) + 1};
+      }
+    }
+  }
+
+  // Line holding the byte at `offset`.
+  [[nodiscard]] auto line_of(const usize offset) const -> usize {
+    return this->prefix(offset).lines;
+  }
+
+  // Byte offset of code point `index`, or the size for index == chars().
+  [[nodiscard]] auto char_to_offset(usize index) const -> Option<usize> {
+    if (index >= this->chars()) {
+      return index == this->chars() ? Option<usize>(this->size())
+                                    : Option<usize>();
+    }
+    const auto *node = root.ptr;
+    usize base = 0;
+    while (!node->is_leaf()) {
+      u32 at = 0;
+      while (index >= node->sums[at].chars) {
+        index -= node->sums[at].chars;
+        base += node->sums[at++].bytes;
+      }
+      node = node->children[at].ptr;
+    }
+    const auto text = node->text.as_slice();
+    for (usize i = 0;; ++i) {
+      if ((text.get_unchecked(i) & 0xc0) != 0x80 && index-- == 0) {
+        return {base + i};
+      }
+    }
+  }
+
+  [[nodiscard]] auto offset_to_char(const usize offset) const -> usize {
+    return this->prefix(offset).chars;
+  }
+
+  // Byte range of the whole lines the edit touched in the new text, which
+  // is what a line-based lexer has to rescan.
+  [[nodiscard]] auto relex_range(const RopeDelta &delta) const
+      -> std::pair<usize, usize> {
+    const auto first = this->line_start(this->line_of(delta.start)).unwrap();
+    const auto last_line = this->line_of(std::min(delta.new_end, this->size()));
+    const auto next = this->line_start(last_line + 1);
+    return {first, next.is_some() ? next.unwrap() : this->size()};
+  }
+
+  [[nodiscard]] auto to_string() const -> std::string {
+    auto out = std::string();
+    out.reserve(this->size());
+    for (const auto chunk : this->chunks()) {
+      out.append(ptr::cast<char>(chunk.data()), chunk.size());
+    }
+    return out;
+  }
+
+private:
+  auto check(const usize offset) const -> void {
+    if (offset > this->size()) [[unlikely]] {
+      exl::impl::panic_bounds(this->size(), offset);
+    }
+  }
+
+  // Summary of the text before `offset`: whole subtrees left of the path,
+  // then a scan of the leaf it ends in.
+  [[nodiscard]] auto prefix(usize offset) const -> impl::RopeSummary {
+    this->check(offset);
+    auto sum = impl::RopeSummary{};
+    if (offset == 0) {
+      return sum;
+    }
+    const auto *node = root.ptr;
+    while (!node->is_leaf()) {
+      u32 at = 0;
+      while (at + 1 < node->len && offset >= node->sums[at].bytes) {
+        offset -= node->sums[at].bytes;
+        sum += node->sums[at++];
+      }
+      node = node->children[at].ptr;
+    }
+    sum += impl::RopeSummary::of(Slice<const u8>(node->text.data(), offset));
+    return sum;
+  }
+
+  // A root with one child is replaced by the child.
+  auto normalize() -> void {
+    while (root && !root->is_leaf() && root->len == 1) {
+      root = impl::RopeRef(root->children[0]);
+    }
+  }
+};
+
+} // namespace exl
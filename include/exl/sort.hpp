@@ -0,0 +1,726 @@
+#pragma once
+
+#include <exl/mem.hpp>
+#include <exl/parse.hpp>
+#include <exl/pool.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+namespace exl::sort::impl {
+
+template <typename T, typename Proj>
+using KeyOf = std::remove_cvref_t<std::invoke_result_t<Proj &, T &>>;
+
+// Unsigned integer whose order matches the key's: signed integers get their
+// sign bit flipped, floats all bits when negative and the sign bit when not.
+// NaNs sort past the infinities of their sign.
+template <traits::Number K>
+[[nodiscard]] constexpr auto radix_key(const K key) {
+  if constexpr (traits::Integer<K>) {
+    using U = std::make_unsigned_t<K>;
+    if constexpr (std::is_signed_v<K>) {
+      return static_cast<U>(static_cast<U>(key) ^
+                            (U{1} << (sizeof(U) * 8 - 1)));
+    } else {
+      return key;
+    }
+  } else {
+    using U = std::conditional_t<sizeof(K) == 4, u32, u64>;
+    const auto bits = std::bit_cast<U>(key);
+    constexpr auto SIGN = U{1} << (sizeof(U) * 8 - 1);
+    return (bits & SIGN) != 0 ? static_cast<U>(~bits) : (bits | SIGN);
+  }
+}
+
+template <typename T, typename Proj>
+using RadixOf = decltype(radix_key(std::declval<KeyOf<T, Proj>>()));
+
+// Bose-Nelson sorting networks, generated at compile time. Their
+// comparators are branch free for scalar keys, which beats insertion sort
+// on the tiny ranges quicksort leaves behind.
+struct NetworkBuilder {
+  std::array<std::pair<u8, u8>, 128> pairs{};
+  usize len{};
+
+  constexpr auto add(const usize i, const usize j) -> void {
+    pairs[len++] = {static_cast<u8>(i), static_cast<u8>(j)};
+  }
+
+  // Merges the sorted runs [i, i + x) and [j, j + y).
+  constexpr auto merge(const usize i, const usize x, const usize j,
+                       const usize y) -> void {
+    if (x == 1 && y == 1) {
+      this->add(i, j);
+    } else if (x == 1 && y == 2) {
+      this->add(i, j + 1);
+      this->add(i, j);
+    } else if (x == 2 && y == 1) {
+      this->add(i, j);
+      this->add(i + 1, j);
+    } else {
+      const auto a = x / 2;
+      const auto b = (x & 1) != 0 ? y / 2 : (y + 1) / 2;
+      this->merge(i, a, j, b);
+      this->merge(i + a, x - a, j + b, y - b);
+      this->merge(i + a, x - a, j, b);
+    }
+  }
+
+  constexpr auto sort(const usize i, const usize m) -> void {
+    if (m > 1) {
+      const auto a = m / 2;
+      this->sort(i, a);
+      this->sort(i + a, m - a);
+      this->merge(i, a, i + a, m - a);
+    }
+  }
+};
+
+template <usize N>
+constexpr usize NETWORK_SIZE = [] {
+  auto builder = NetworkBuilder();
+  builder.sort(0, N);
+  return builder.len;
+}();
+
+template <usize N>
+constexpr auto NETWORK = [] {
+  auto builder = NetworkBuilder();
+  builder.sort(0, N);
+  auto pairs = std::array<std::pair<u8, u8>, NETWORK_SIZE<N>>{};
+  std::copy_n(builder.pairs.begin(), pairs.size(), pairs.begin());
+  return pairs;
+}();
+
+static constexpr usize NETWORK_MAX = 16;
+static constexpr usize INSERTION_THRESHOLD = 24;
+static constexpr usize NINTHER_THRESHOLD = 128;
+static constexpr usize PARTIAL_INSERTION_LIMIT = 8;
+static constexpr usize BLOCK = 64;
+
+// Networks copy elements on every comparator, so only small trivially
+// copyable ones take them.
+template <typename T>
+constexpr bool USE_NETWORK =
+    std::is_trivially_copyable_v<T> && sizeof(T) <= 16;
+
+template <typename T, typename Less>
+constexpr auto compare_exchange(T &lhs, T &rhs, Less &less) -> void {
+  const bool swap = less(rhs, lhs);
+  const T lo = swap ? rhs : lhs;
+  const T hi = swap ? lhs : rhs;
+  lhs = lo;
+  rhs = hi;
+}
+
+template <usize N, typename T, typename Less>
+auto network_sort(T *first, Less &less) -> void {
+  [&]<usize... I>(std::index_sequence<I...>) {
+    (compare_exchange(first[NETWORK<N>[I].first], first[NETWORK<N>[I].second],
+                      less),
+     ...);
+  }(std::make_index_sequence<NETWORK_SIZE<N>>{});
+}
+
+template <typename T, typename Less>
+auto small_sort(T *first, const usize len, Less &less) -> void {
+  [&]<usize... N>(std::index_sequence<N...>) {
+    ((len == N ? network_sort<N>(first, less) : void()), ...);
+  }(std::make_index_sequence<NETWORK_MAX + 1>{});
+}
+
+template <typename T, typename Less>
+auto insertion_sort(T *begin, T *end, Less &less) -> void {
+  if (begin == end) {
+    return;
+  }
+  for (auto *cur = begin + 1; cur != end; ++cur) {
+    auto *sift = cur;
+    auto *sift_1 = cur - 1;
+    if (less(*sift, *sift_1)) {
+      auto tmp = std::move(*sift);
+      do {
+        *sift-- = std::move(*sift_1);
+      } while (sift != begin && less(tmp, *--sift_1));
+      *sift = std::move(tmp);
+    }
+  }
+}
+
+// Requires *(begin - 1) to be no greater than any element of the range.
+template <typename T, typename Less>
+auto unguarded_insertion_sort(T *begin, T *end, Less &less) -> void {
+  if (begin == end) {
+    return;
+  }
+  for (auto *cur = begin + 1; cur != end; ++cur) {
+    auto *sift = cur;
+    auto *sift_1 = cur - 1;
+    if (less(*sift, *sift_1)) {
+      auto tmp = std::move(*sift);
+      do {
+        *sift-- = std::move(*sift_1);
+      } while (less(tmp, *--sift_1));
+      *sift = std::move(tmp);
+    }
+  }
+}
+
+// Insertion sort that gives up after moving PARTIAL_INSERTION_LIMIT
+// elements. Returns whether the range ended up sorted.
+template <typename T, typename Less>
+auto partial_insertion_sort(T *begin, T *end, Less &less) -> bool {
+  if (begin == end) {
+    return true;
+  }
+  usize moved = 0;
+  for (auto *cur = begin + 1; cur != end; ++cur) {
+    auto *sift = cur;
+    auto *sift_1 = cur - 1;
+    if (less(*sift, *sift_1)) {
+      auto tmp = std::move(*sift);
+      do {
+        *sift-- = std::move(*sift_1);
+      } while (sift != begin && less(tmp, *--sift_1));
+      *sift = std::move(tmp);
+      moved += static_cast<usize>(cur - sift);
+    }
+    if (moved > PARTIAL_INSERTION_LIMIT) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T, typename Less>
+auto sort2(T *lhs, T *rhs, Less &less) -> void {
+  if (less(*rhs, *lhs)) {
+    std::iter_swap(lhs, rhs);
+  }
+}
+
+template <typename T, typename Less>
+auto sort3(T *a, T *b, T *c, Less &less) -> void {
+  sort2(a, b, less);
+  sort2(b, c, less);
+  sort2(a, b, less);
+}
+
+// Moves elements equal to the pivot at *begin to the left part; used when
+// the pivot equals the element before the range, so everything left of the
+// returned position is done.
+template <typename T, typename Less>
+auto partition_left(T *begin, T *end, Less &less) -> T * {
+  auto pivot = std::move(*begin);
+  auto *first = begin;
+  auto *last = end;
+  while (less(pivot, *--last)) {
+  }
+  if (last + 1 == end) {
+    while (first < last && !less(pivot, *++first)) {
+    }
+  } else {
+    while (!less(pivot, *++first)) {
+    }
+  }
+  while (first < last) {
+    std::iter_swap(first, last);
+    while (less(pivot, *--last)) {
+    }
+    while (!less(pivot, *++first)) {
+    }
+  }
+  auto *pivot_pos = last;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return pivot_pos;
+}
+
+// Partitions around *begin into [< pivot] pivot [>= pivot]. Also reports
+// whether no element had to move.
+template <typename T, typename Less>
+auto partition_right(T *begin, T *end, Less &less) -> std::pair<T *, bool> {
+  auto pivot = std::move(*begin);
+  auto *first = begin;
+  auto *last = end;
+  while (less(*++first, pivot)) {
+  }
+  if (first - 1 == begin) {
+    while (first < last && !less(*--last, pivot)) {
+    }
+  } else {
+    while (!less(*--last, pivot)) {
+    }
+  }
+  const bool already_partitioned = first >= last;
+  while (first < last) {
+    std::iter_swap(first, last);
+    while (less(*++first, pivot)) {
+    }
+    while (!less(*--last, pivot)) {
+    }
+  }
+  auto *pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return {pivot_pos, already_partitioned};
+}
+
+template <typename T>
+auto swap_offsets(T *first, T *last, const u8 *offsets_l, const u8 *offsets_r,
+                  const usize num, const bool use_swaps) -> void {
+  if (use_swaps) {
+    // Equal counts need a real swap so that the element order pairs up.
+    for (usize i = 0; i < num; ++i) {
+      std::iter_swap(first + offsets_l[i], last - offsets_r[i]);
+    }
+  } else if (num > 0) {
+    auto *lhs = first + offsets_l[0];
+    auto *rhs = last - offsets_r[0];
+    auto tmp = std::move(*lhs);
+    *lhs = std::move(*rhs);
+    for (usize i = 1; i < num; ++i) {
+      lhs = first + offsets_l[i];
+      *rhs = std::move(*lhs);
+      rhs = last - offsets_r[i];
+      *lhs = std::move(*rhs);
+    }
+    *rhs = std::move(tmp);
+  }
+}
+
+// partition_right with the comparisons of each BLOCK recorded as offsets
+// instead of branched on (BlockQuicksort), for cheap comparisons.
+template <typename T, typename Less>
+auto partition_right_branchless(T *begin, T *end, Less &less)
+    -> std::pair<T *, bool> {
+  auto pivot = std::move(*begin);
+  auto *first = begin;
+  auto *last = end;
+  while (less(*++first, pivot)) {
+  }
+  if (first - 1 == begin) {
+    while (first < last && !less(*--last, pivot)) {
+    }
+  } else {
+    while (!less(*--last, pivot)) {
+    }
+  }
+  const bool already_partitioned = first >= last;
+  if (!already_partitioned) {
+    std::iter_swap(first, last);
+    ++first;
+
+    alignas(CACHE_LINE) u8 offsets_l[BLOCK]; // NOLINT
+    alignas(CACHE_LINE) u8 offsets_r[BLOCK]; // NOLINT
+    auto *offsets_l_base = first;
+    auto *offsets_r_base = last;
+    usize num_l = 0;
+    usize num_r = 0;
+    usize start_l = 0;
+    usize start_r = 0;
+    while (first < last) {
+      const auto num_unknown = static_cast<usize>(last - first);
+      const auto left_split =
+          num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+      const auto right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+      for (usize i = 0; i < std::min(left_split, BLOCK);) {
+        offsets_l[num_l] = static_cast<u8>(i++);
+        num_l += !less(*first, pivot);
+        ++first;
+      }
+      for (usize i = 0; i < std::min(right_split, BLOCK);) {
+        offsets_r[num_r] = static_cast<u8>(++i);
+        num_r += less(*--last, pivot);
+      }
+
+      const auto num = std::min(num_l, num_r);
+      swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l,
+                   offsets_r + start_r, num, num_l == num_r);
+      num_l -= num;
+      num_r -= num;
+      start_l += num;
+      start_r += num;
+      if (num_l == 0) {
+        start_l = 0;
+        offsets_l_base = first;
+      }
+      if (num_r == 0) {
+        start_r = 0;
+        offsets_r_base = last;
+      }
+    }
+
+    // One side may still hold misplaced elements; move them past the
+    // other.
+    if (num_l != 0) {
+      while (num_l-- != 0) {
+        std::iter_swap(offsets_l_base + offsets_l[start_l + num_l], --last);
+      }
+      first = last;
+    }
+    if (num_r != 0) {
+      while (num_r-- != 0) {
+        std::iter_swap(offsets_r_base - offsets_r[start_r + num_r], first);
+        ++first;
+      }
+      last = first;
+    }
+  }
+  auto *pivot_pos = first - 1;
+  *begin = std::move(*pivot_pos);
+  *pivot_pos = std::move(pivot);
+  return {pivot_pos, already_partitioned};
+}
+
+// Scrambles a few elements of an unbalanced partition so that adversarial
+// patterns do not keep producing bad pivots.
+template <typename T>
+auto break_patterns(T *begin, T *pivot_pos, T *end) -> void {
+  const auto l_size = static_cast<usize>(pivot_pos - begin);
+  const auto r_size = static_cast<usize>(end - (pivot_pos + 1));
+  if (l_size >= INSERTION_THRESHOLD) {
+    std::iter_swap(begin, begin + l_size / 4);
+    std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+    if (l_size > NINTHER_THRESHOLD) {
+      std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+      std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+      std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+      std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+    }
+  }
+  if (r_size >= INSERTION_THRESHOLD) {
+    std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+    std::iter_swap(end - 1, end - r_size / 4);
+    if (r_size > NINTHER_THRESHOLD) {
+      std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+      std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+      std::iter_swap(end - 2, end - (1 + r_size / 4));
+      std::iter_swap(end - 3, end - (2 + r_size / 4));
+    }
+  }
+}
+
+// Pattern-defeating quicksort. `leftmost` is false when the element before
+// begin is a lower bound for the range, which lets insertion sort skip its
+// bounds check and lets equal runs be split off with partition_left.
+template <bool BRANCHLESS, typename T, typename Less>
+auto pdq_loop(T *begin, T *end, Less &less, usize bad_allowed,
+              bool leftmost = true) -> void {
+  for (;;) {
+    const auto size = static_cast<usize>(end - begin);
+    if (size < INSERTION_THRESHOLD) {
+      if (USE_NETWORK<T> && size <= NETWORK_MAX) {
+        small_sort(begin, size, less);
+      } else if (leftmost) {
+        insertion_sort(begin, end, less);
+      } else {
+        unguarded_insertion_sort(begin, end, less);
+      }
+      return;
+    }
+
+    const auto s2 = size / 2;
+    if (size > NINTHER_THRESHOLD) {
+      sort3(begin, begin + s2, end - 1, less);
+      sort3(begin + 1, begin + (s2 - 1), end - 2, less);
+      sort3(begin + 2, begin + (s2 + 1), end - 3, less);
+      sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), less);
+      std::iter_swap(begin, begin + s2);
+    } else {
+      sort3(begin + s2, begin, end - 1, less);
+    }
+
+    if (!leftmost && !less(*(begin - 1), *begin)) {
+      begin = partition_left(begin, end, less) + 1;
+      continue;
+    }
+
+    const auto [pivot_pos, already_partitioned] =
+        BRANCHLESS ? partition_right_branchless(begin, end, less)
+                   : partition_right(begin, end, less);
+    const auto l_size = static_cast<usize>(pivot_pos - begin);
+    const auto r_size = static_cast<usize>(end - (pivot_pos + 1));
+    if (l_size < size / 8 || r_size < size / 8) {
+      if (--bad_allowed == 0) {
+        std::make_heap(begin, end, less);
+        std::sort_heap(begin, end, less);
+        return;
+      }
+      break_patterns(begin, pivot_pos, end);
+    } else if (already_partitioned &&
+               partial_insertion_sort(begin, pivot_pos, less) &&
+               partial_insertion_sort(pivot_pos + 1, end, less)) {
+      return;
+    }
+
+    pdq_loop<BRANCHLESS>(begin, pivot_pos, less, bad_allowed, leftmost);
+    begin = pivot_pos + 1;
+    leftmost = false;
+  }
+}
+
+template <typename Cmp>
+constexpr bool IS_DEFAULT_ORDER = std::is_same_v<Cmp, std::ranges::less> ||
+                                  std::is_same_v<Cmp, std::ranges::greater> ||
+                                  std::is_same_v<Cmp, std::less<>> ||
+                                  std::is_same_v<Cmp, std::greater<>>;
+
+template <typename T, typename Cmp, typename Proj>
+auto pdq(T *begin, T *end, Cmp &cmp, Proj &proj) -> void {
+  if (begin == end) {
+    return;
+  }
+  auto less = [&cmp, &proj](const T &lhs, const T &rhs) -> bool {
+    return std::invoke(cmp, std::invoke(proj, lhs), std::invoke(proj, rhs));
+  };
+  constexpr bool BRANCHLESS =
+      IS_DEFAULT_ORDER<Cmp> && std::is_arithmetic_v<KeyOf<const T, Proj>>;
+  const auto size = static_cast<usize>(end - begin);
+  pdq_loop<BRANCHLESS>(begin, end, less, std::bit_width(size));
+}
+
+static constexpr usize RADIX_MIN = 256;
+
+// One counting pass builds every digit's histogram; digits on which all
+// keys agree are skipped.
+template <typename T, typename Proj>
+auto radix_lsd(T *data, T *buf, const usize len, Proj &proj) -> void {
+  using U = RadixOf<T, Proj>;
+  constexpr usize DIGITS = sizeof(U);
+  auto counts = std::array<std::array<usize, 256>, DIGITS>{};
+  for (usize i = 0; i < len; ++i) {
+    const auto key = radix_key(std::invoke(proj, data[i]));
+    for (usize d = 0; d < DIGITS; ++d) {
+      ++counts[d][(key >> (d * 8)) & 0xff];
+    }
+  }
+
+  const auto first_key = radix_key(std::invoke(proj, data[0]));
+  auto *src = data;
+  auto *dst = buf;
+  for (usize d = 0; d < DIGITS; ++d) {
+    auto &count = counts[d];
+    if (count[(first_key >> (d * 8)) & 0xff] == len) {
+      continue;
+    }
+    usize sum = 0;
+    for (auto &slot : count) {
+      sum += std::exchange(slot, sum);
+    }
+    for (usize i = 0; i < len; ++i) {
+      const auto digit = (radix_key(std::invoke(proj, src[i])) >> (d * 8)) &
+                         0xff;
+      dst[count[digit]++] = std::move(src[i]);
+    }
+    std::swap(src, dst);
+  }
+  if (src != data) {
+    std::move(src, src + len, data);
+  }
+}
+
+// American flag sort: buckets by one byte from the top, permuting in place
+// through cycle leaders, then recurses into each bucket.
+template <typename T, typename Proj>
+auto radix_msd(T *data, const usize len, const usize digit, Proj &proj)
+    -> void {
+  using U = RadixOf<T, Proj>;
+  constexpr usize DIGITS = sizeof(U);
+  if (len < RADIX_MIN || digit == DIGITS) {
+    auto cmp = std::ranges::less();
+    auto by_key = [&proj](const T &elem) {
+      return radix_key(std::invoke(proj, elem));
+    };
+    pdq(data, data + len, cmp, by_key);
+    return;
+  }
+  const auto shift = (DIGITS - 1 - digit) * 8;
+  const auto byte_of = [&proj, shift](const T &elem) -> usize {
+    return (radix_key(std::invoke(proj, elem)) >> shift) & 0xff;
+  };
+
+  auto count = std::array<usize, 256>{};
+  for (usize i = 0; i < len; ++i) {
+    ++count[byte_of(data[i])];
+  }
+  if (count[byte_of(data[0])] == len) {
+    radix_msd(data, len, digit + 1, proj);
+    return;
+  }
+
+  auto head = std::array<usize, 256>{};
+  auto tail = std::array<usize, 256>{};
+  usize sum = 0;
+  for (usize b = 0; b < 256; ++b) {
+    head[b] = sum;
+    sum += count[b];
+    tail[b] = sum;
+  }
+  for (usize b = 0; b < 256; ++b) {
+    while (head[b] < tail[b]) {
+      auto elem = std::move(data[head[b]]);
+      for (auto to = byte_of(elem); to != b; to = byte_of(elem)) {
+        std::swap(elem, data[head[to]++]);
+      }
+      data[head[b]++] = std::move(elem);
+    }
+  }
+
+  usize start = 0;
+  for (usize b = 0; b < 256; ++b) {
+    if (count[b] > 1) {
+      radix_msd(data + start, count[b], digit + 1, proj);
+    }
+    start += count[b];
+  }
+}
+
+static constexpr usize PARALLEL_MIN = usize{1} << 16;
+static constexpr usize OVERSAMPLE = 32;
+static constexpr usize MAX_BUCKETS = 256;
+
+} // namespace exl::sort::impl
+
+namespace exl::sort {
+
+// Comparison sort: pattern-defeating quicksort with BlockQuicksort
+// partitioning for arithmetic keys under the default orders, heapsort as
+// the worst case guard, and sorting networks for the tiny ranges. Not
+// stable. Proj maps an element to what `cmp` compares, e.g. &Row::id.
+template <typename T, traits::CheckPolicy P, typename Cmp = std::ranges::less,
+          typename Proj = std::identity>
+requires std::indirect_strict_weak_order<Cmp, std::projected<T *, Proj>>
+auto pdq(const Slice<T, P> slice, Cmp cmp = {}, Proj proj = {}) -> void {
+  impl::pdq(slice.data(), slice.data() + slice.size(), cmp, proj);
+}
+
+// LSD radix sort on the integer or float key that Proj yields, in
+// ascending order. Stable. Needs a scratch copy of the slice; small slices
+// are insertion sorted on the same radix keys, so they are stable too and
+// order floats the same way.
+template <typename T, traits::CheckPolicy P, typename Proj = std::identity>
+requires traits::Number<impl::KeyOf<T, Proj>> && std::default_initializable<T>
+auto radix(const Slice<T, P> slice, Proj proj = {}) -> void {
+  if (slice.size() < impl::RADIX_MIN) {
+    auto less = [&proj](const T &lhs, const T &rhs) {
+      return impl::radix_key(std::invoke(proj, lhs)) <
+             impl::radix_key(std::invoke(proj, rhs));
+    };
+    impl::insertion_sort(slice.data(), slice.data() + slice.size(), less);
+    return;
+  }
+  auto buf = std::make_unique_for_overwrite<T[]>(slice.size()); // NOLINT
+  impl::radix_lsd(slice.data(), buf.get(), slice.size(), proj);
+}
+
+// MSD radix sort that permutes in place, for when a scratch copy does not
+// fit. Not stable.
+template <typename T, traits::CheckPolicy P, typename Proj = std::identity>
+requires traits::Number<impl::KeyOf<T, Proj>>
+auto radix_in_place(const Slice<T, P> slice, Proj proj = {}) -> void {
+  if (slice.size() > 1) {
+    impl::radix_msd(slice.data(), slice.size(), 0, proj);
+  }
+}
+
+// Sample sort on `pool`: splitters drawn from a sorted sample cut the input
+// into buckets, every block of the input is classified and scattered into
+// its buckets in parallel, then buckets are sorted with pdq() in parallel.
+// Not stable. Needs a scratch copy of the slice.
+template <typename T, traits::CheckPolicy P, typename Cmp = std::ranges::less,
+          typename Proj = std::identity>
+requires std::indirect_strict_weak_order<Cmp, std::projected<T *, Proj>> &&
+         std::default_initializable<T> && std::copyable<T>
+auto parallel(ThreadPool &pool, const Slice<T, P> slice, Cmp cmp = {},
+              Proj proj = {}) -> void {
+  const auto len = slice.size();
+  auto *data = slice.data();
+  if (pool.size() == 1 || len < impl::PARALLEL_MIN) {
+    impl::pdq(data, data + len, cmp, proj);
+    return;
+  }
+  auto less = [&cmp, &proj](const T &lhs, const T &rhs) -> bool {
+    return std::invoke(cmp, std::invoke(proj, lhs), std::invoke(proj, rhs));
+  };
+
+  const auto buckets =
+      std::min(impl::MAX_BUCKETS, std::bit_ceil(pool.size()) * 4);
+  const auto blocks = pool.size() * 4;
+  const auto block_len = (len + blocks - 1) / blocks;
+
+  // Evenly spread sample positions, jittered so periodic inputs do not
+  // alias with the stride.
+  auto sample = std::make_unique_for_overwrite<T[]>( // NOLINT
+      buckets * impl::OVERSAMPLE);
+  const auto stride = len / (buckets * impl::OVERSAMPLE);
+  u64 rng = len;
+  for (usize i = 0; i < buckets * impl::OVERSAMPLE; ++i) {
+    rng = rng * 6364136223846793005ULL + 1442695040888963407ULL; // NOLINT
+    sample[i] = data[i * stride + (rng >> 33) % stride];
+  }
+  impl::pdq(sample.get(), sample.get() + buckets * impl::OVERSAMPLE, cmp,
+            proj);
+  auto splitters = std::make_unique_for_overwrite<T[]>(buckets); // NOLINT
+  for (usize i = 0; i + 1 < buckets; ++i) {
+    splitters[i] = sample[(i + 1) * impl::OVERSAMPLE];
+  }
+  sample.reset();
+  const auto bucket_of = [&](const T &elem) -> u8 {
+    return static_cast<u8>(std::upper_bound(splitters.get(),
+                                            splitters.get() + buckets - 1,
+                                            elem, less) -
+                           splitters.get());
+  };
+
+  auto ids = std::make_unique_for_overwrite<u8[]>(len);       // NOLINT
+  auto counts = std::make_unique<usize[]>(blocks * buckets); // NOLINT
+  pool.run(blocks, [&](const usize block) {
+    const auto end = std::min(len, (block + 1) * block_len);
+    auto *count = counts.get() + block * buckets;
+    for (auto i = block * block_len; i < end; ++i) {
+      ids[i] = bucket_of(data[i]);
+      ++count[ids[i]];
+    }
+  });
+
+  // Bucket major, so each bucket ends up contiguous with the blocks'
+  // shares in block order.
+  auto bucket_start = std::make_unique<usize[]>(buckets + 1); // NOLINT
+  usize sum = 0;
+  for (usize b = 0; b < buckets; ++b) {
+    bucket_start[b] = sum;
+    for (usize block = 0; block < blocks; ++block) {
+      sum += std::exchange(counts[block * buckets + b], sum);
+    }
+  }
+  bucket_start[buckets] = sum;
+
+  auto buf = std::make_unique_for_overwrite<T[]>(len); // NOLINT
+  pool.run(blocks, [&](const usize block) {
+    const auto end = std::min(len, (block + 1) * block_len);
+    auto *offset = counts.get() + block * buckets;
+    for (auto i = block * block_len; i < end; ++i) {
+      buf[offset[ids[i]]++] = std::move(data[i]);
+    }
+  });
+  ids.reset();
+
+  pool.run(buckets, [&](const usize b) {
+    auto *begin = buf.get() + bucket_start[b];
+    auto *end = buf.get() + bucket_start[b + 1];
+    impl::pdq(begin, end, cmp, proj);
+    std::move(begin, end, data + bucket_start[b]);
+  });
+}
+
+} // namespace exl::sort
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <exl/fmt.hpp>
+#include <exl/mem.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+
+namespace exl {
+
+// Text builder over caller-supplied storage. It never allocates: once the
+// storage is full further output is dropped and counted in `truncated`.
+struct StrBuf {
+  using Self = StrBuf;
+
+  // fmt compatible output iterator appending to the buffer.
+  struct Out {
+    using iterator_category = std::output_iterator_tag;
+    using value_type = void;
+    using difference_type = ssize;
+    using pointer = void;
+    using reference = void;
+
+    StrBuf *buf{};
+
+    auto operator=(const char ch) -> Out & {
+      buf->push(ch);
+      return *this;
+    }
+    [[nodiscard]] auto operator*() -> Out & { return *this; }
+    auto operator++() -> Out & { return *this; }
+    auto operator++(int) -> Out { return *this; }
+  };
+
+  char *ptr{};
+  usize cap{};
+  usize len{};
+  usize truncated{};
+
+  [[nodiscard]] constexpr auto size() const -> usize { return len; }
+  [[nodiscard]] constexpr auto remaining() const -> usize { return cap - len; }
+  [[nodiscard]] constexpr auto is_truncated() const -> bool {
+    return truncated != 0;
+  }
+
+  [[nodiscard]] constexpr auto as_str() const -> std::string_view {
+    return {ptr, len};
+  }
+
+  [[nodiscard]] auto as_slice() const -> Slice<u8> {
+    return Slice<u8>::from_unchecked(ptr::cast<u8>(ptr), len);
+  }
+
+  [[nodiscard]] auto out() -> Out { return Out{this}; }
+
+  auto clear() -> void {
+    len = 0;
+    truncated = 0;
+  }
+
+  auto push(const char ch) -> Self & {
+    if (len < cap) {
+      ptr[len++] = ch;
+    } else {
+      ++truncated;
+    }
+    return *this;
+  }
+
+  auto append(const std::string_view str) -> Self & {
+    const auto count = std::min(str.size(), this->remaining());
+    std::memcpy(ptr + len, str.data(), count);
+    len += count;
+    truncated += str.size() - count;
+    return *this;
+  }
+
+  auto pad(const usize count, const char symbol = ' ') -> Self & {
+    const auto fill = std::min(count, this->remaining());
+    std::memset(ptr + len, symbol, fill);
+    len += fill;
+    truncated += count - fill;
+    return *this;
+  }
+
+  template <typename... Args>
+  auto format(const fmt::format_string<const Args &...> format,
+              const Args &...args) -> Self & {
+    auto res = fmt::format_to_n(ptr + len, this->remaining(), format, args...);
+    const auto written = std::min(res.size, this->remaining());
+    len += written;
+    truncated += res.size - written;
+    return *this;
+  }
+
+  template <traits::CompiledFormat S, typename... Args>
+  auto format(const S &format, const Args &...args) -> Self & {
+    auto res = fmt::format_to_n(ptr + len, this->remaining(), format, args...);
+    const auto written = std::min(res.size, this->remaining());
+    len += written;
+    truncated += res.size - written;
+    return *this;
+  }
+
+  // Appends one value, skipping the format machinery for strings and
+  // integers.
+  template <typename T> auto write(const T &val) -> Self & {
+    if constexpr (std::is_convertible_v<const T &, std::string_view>) {
+      return this->append(val);
+    } else if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                         !std::is_same_v<T, char>) {
+      const auto digits = fmt::format_int(val);
+      return this->append({digits.data(), digits.size()});
+    } else {
+      return this->format(FMT_COMPILE("{}"), val);
+    }
+  }
+
+  auto left(const std::string_view str, const usize width,
+            const char symbol = ' ') -> Self & {
+    this->append(str);
+    return this->pad(width - std::min(width, str.size()), symbol);
+  }
+
+  auto right(const std::string_view str, const usize width,
+             const char symbol = ' ') -> Self & {
+    this->pad(width - std::min(width, str.size()), symbol);
+    return this->append(str);
+  }
+
+  auto center(const std::string_view str, const usize width,
+              const char symbol = ' ') -> Self & {
+    const auto fill = width - std::min(width, str.size());
+    this->pad(fill / 2, symbol);
+    this->append(str);
+    return this->pad(fill - fill / 2, symbol);
+  }
+
+  // Writes every element of `range`, separated by `sep`.
+  template <traits::Range R>
+  auto join(const R &range, const std::string_view sep) -> Self & {
+    auto first = true;
+    for (const auto &elem : range) {
+      if (!first) {
+        this->append(sep);
+      }
+      first = false;
+      this->write(elem);
+    }
+    return *this;
+  }
+
+  [[nodiscard]] constexpr StrBuf() = default;
+  [[nodiscard]] constexpr explicit StrBuf(char *_ptr, const usize _cap)
+      : ptr{_ptr}, cap{_cap} {}
+
+  [[nodiscard]] static auto from_unchecked(const Slice<u8> storage) -> Self {
+    return Self(ptr::cast<char>(storage.as_ptr()), storage.cap);
+  }
+};
+
+// StrBuf that carries its own N bytes of storage.
+template <usize N> struct InlineStrBuf : StrBuf {
+  char storage[N]; // NOLINT
+
+  [[nodiscard]] InlineStrBuf() : StrBuf(storage, N) {}
+
+  InlineStrBuf(const InlineStrBuf &) = delete;
+  InlineStrBuf(InlineStrBuf &&) = delete;
+  auto operator=(const InlineStrBuf &) -> InlineStrBuf & = delete;
+  auto operator=(InlineStrBuf &&) -> InlineStrBuf & = delete;
+  ~InlineStrBuf() = default;
+};
+
+} // namespace exl
+
+template <>
+struct fmt::formatter<exl::StrBuf> : fmt::formatter<std::string_view> {
+  template <typename FormatContext>
+  auto format(const exl::StrBuf &buf, FormatContext &ctx) const
+      -> decltype(ctx.out()) {
+    return fmt::formatter<std::string_view>::format(buf.as_str(), ctx);
+  }
+};
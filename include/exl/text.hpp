@@ -0,0 +1,592 @@
+#pragma once
+
+#include <exl/fmt.hpp>
+#include <exl/mem.hpp>
+#include <exl/option.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <string_view>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define EXL_TEXT_X86 1
+#include <immintrin.h>
+#endif
+
+namespace exl::text {
+
+struct Utf8Error {
+  usize offset{};
+
+  template <typename OutputIt> auto format_to(OutputIt out) const -> OutputIt {
+    return fmt::format_to(out, "Invalid UTF-8 at offset {}", offset);
+  }
+};
+
+enum class Isa : u8 { Scalar, Avx2 };
+
+// A set of bytes. Besides the plain bitmap it keeps the two nibble tables
+// the vector scanners need: for each low nibble, one bit per high nibble
+// 0-7 in `low_table` and 8-15 in `high_table`, so any set costs the same
+// three shuffles per block.
+struct CharClass {
+  using Self = CharClass;
+
+  u64 bits[4]{};        // NOLINT
+  u8 low_table[16]{};   // NOLINT
+  u8 high_table[16]{};  // NOLINT
+
+  [[nodiscard]] constexpr auto contains(const u8 byte) const -> bool {
+    return ((bits[byte / 64] >> (byte % 64)) & 1) != 0;
+  }
+
+  constexpr auto add(const u8 byte) -> Self & {
+    bits[byte / 64] |= u64{1} << (byte % 64);
+    if (byte < 0x80) {
+      low_table[byte & 0xf] |= static_cast<u8>(1 << (byte >> 4));
+    } else {
+      high_table[byte & 0xf] |= static_cast<u8>(1 << ((byte >> 4) - 8));
+    }
+    return *this;
+  }
+
+  [[nodiscard]] constexpr auto operator|(const CharClass &other) const
+      -> Self {
+    auto ret = *this;
+    for (usize i = 0; i < 4; ++i) {
+      ret.bits[i] |= other.bits[i];
+    }
+    for (usize i = 0; i < 16; ++i) {
+      ret.low_table[i] |= other.low_table[i];
+      ret.high_table[i] |= other.high_table[i];
+    }
+    return ret;
+  }
+
+  [[nodiscard]] constexpr auto operator~() const -> Self {
+    auto ret = Self();
+    for (usize byte = 0; byte < 256; ++byte) {
+      if (!this->contains(static_cast<u8>(byte))) {
+        ret.add(static_cast<u8>(byte));
+      }
+    }
+    return ret;
+  }
+
+  [[nodiscard]] static constexpr auto of(const std::string_view chars)
+      -> Self {
+    auto ret = Self();
+    for (const auto ch : chars) {
+      ret.add(static_cast<u8>(ch));
+    }
+    return ret;
+  }
+
+  // Inclusive byte range.
+  [[nodiscard]] static constexpr auto range(const u8 first, const u8 last)
+      -> Self {
+    auto ret = Self();
+    for (usize byte = first; byte <= last; ++byte) {
+      ret.add(static_cast<u8>(byte));
+    }
+    return ret;
+  }
+};
+
+inline constexpr CharClass SPACE = CharClass::of(" \t\n\r\f\v");
+inline constexpr CharClass DIGIT = CharClass::range('0', '9');
+inline constexpr CharClass ALPHA =
+    CharClass::range('a', 'z') | CharClass::range('A', 'Z');
+inline constexpr CharClass IDENT = ALPHA | DIGIT | CharClass::of("_");
+inline constexpr CharClass NON_ASCII = CharClass::range(0x80, 0xff);
+
+[[nodiscard]] inline auto as_bytes(const std::string_view str)
+    -> Slice<const u8> {
+  return Slice<const u8>::from_unchecked(ptr::cast<const u8>(str.data()),
+                                         str.size());
+}
+
+} // namespace exl::text
+
+namespace exl::text::impl {
+
+// Decodes the code point at `src`, returning its width or 0 if the bytes
+// are not valid UTF-8 (overlong forms and surrogates included).
+[[nodiscard]] constexpr auto decode_one(const u8 *src, const usize len,
+                                        u32 &point) -> usize {
+  const u32 lead = src[0];
+  if (lead < 0x80) {
+    point = lead;
+    return 1;
+  }
+  if (lead < 0xc2) {
+    return 0;
+  }
+  if (lead < 0xe0) {
+    if (len < 2 || (src[1] & 0xc0) != 0x80) {
+      return 0;
+    }
+    point = ((lead & 0x1f) << 6) | (src[1] & 0x3f);
+    return 2;
+  }
+  if (lead < 0xf0) {
+    const u8 low = lead == 0xe0 ? 0xa0 : 0x80;
+    const u8 high = lead == 0xed ? 0x9f : 0xbf;
+    if (len < 3 || src[1] < low || src[1] > high || (src[2] & 0xc0) != 0x80) {
+      return 0;
+    }
+    point = ((lead & 0x0f) << 12) | ((src[1] & 0x3f) << 6) | (src[2] & 0x3f);
+    return 3;
+  }
+  if (lead < 0xf5) {
+    const u8 low = lead == 0xf0 ? 0x90 : 0x80;
+    const u8 high = lead == 0xf4 ? 0x8f : 0xbf;
+    if (len < 4 || src[1] < low || src[1] > high ||
+        (src[2] & 0xc0) != 0x80 || (src[3] & 0xc0) != 0x80) {
+      return 0;
+    }
+    point = ((lead & 0x07) << 18) | ((src[1] & 0x3f) << 12) |
+            ((src[2] & 0x3f) << 6) | (src[3] & 0x3f);
+    return 4;
+  }
+  return 0;
+}
+
+[[nodiscard]] inline auto is_ascii8(const u8 *src) -> bool {
+  u64 word{};
+  std::memcpy(&word, src, sizeof(word));
+  return (word & 0x8080808080808080ULL) == 0;
+}
+
+// Scans look at this many bytes one at a time before going wide.
+static constexpr usize SHORT_RUN = 16;
+
+namespace scalar {
+
+[[nodiscard]] inline auto validate(const u8 *src, const usize len,
+                                   usize at = 0) -> Result<usize, Utf8Error> {
+  u32 point{};
+  while (at < len) {
+    if (at + 8 <= len && is_ascii8(src + at)) {
+      at += 8;
+      continue;
+    }
+    const auto width = decode_one(src + at, len - at, point);
+    if (width == 0) {
+      return {Utf8Error{at}};
+    }
+    at += width;
+  }
+  return {len};
+}
+
+[[nodiscard]] inline auto decode(const u8 *src, const usize len, u32 *out,
+                                 const usize cap, usize at = 0,
+                                 usize written = 0)
+    -> Result<usize, Utf8Error> {
+  while (at < len && written < cap) {
+    if (at + 8 <= len && written + 8 <= cap && is_ascii8(src + at)) {
+      for (usize i = 0; i < 8; ++i) {
+        out[written + i] = src[at + i];
+      }
+      at += 8;
+      written += 8;
+      continue;
+    }
+    const auto width = decode_one(src + at, len - at, out[written]);
+    if (width == 0) {
+      return {Utf8Error{at}};
+    }
+    at += width;
+    ++written;
+  }
+  return {written};
+}
+
+[[nodiscard]] inline auto skip_while(const u8 *src, const usize len,
+                                     const CharClass &cls, usize at) -> usize {
+  while (at < len && cls.contains(src[at])) {
+    ++at;
+  }
+  return at;
+}
+
+[[nodiscard]] inline auto find_first_of(const u8 *src, const usize len,
+                                        const CharClass &cls, usize at)
+    -> usize {
+  while (at < len && !cls.contains(src[at])) {
+    ++at;
+  }
+  return at;
+}
+
+} // namespace scalar
+
+#ifdef EXL_TEXT_X86
+// AVX2 kernels. Validation is the lookup algorithm of Keiser and Lemire,
+// "Validating UTF-8 In Less Than One Instruction Per Byte": three nibble
+// lookups classify every byte pair, and saturating subtractions check that
+// 3 and 4 byte sequences get their continuation bytes. A block that fails is
+// handed back to the scalar code to find the exact offset.
+namespace avx2 {
+
+static constexpr usize BLOCK = 32;
+
+// Error bits of the byte pair lookup tables.
+static constexpr u8 TOO_SHORT = 1 << 0;
+static constexpr u8 TOO_LONG = 1 << 1;
+static constexpr u8 OVERLONG_3 = 1 << 2;
+static constexpr u8 TOO_LARGE = 1 << 3;
+static constexpr u8 SURROGATE = 1 << 4;
+static constexpr u8 OVERLONG_2 = 1 << 5;
+static constexpr u8 TOO_LARGE_1000 = 1 << 6;
+static constexpr u8 OVERLONG_4 = 1 << 6;
+static constexpr u8 TWO_CONTS = 1 << 7;
+static constexpr u8 CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+static constexpr u8 BYTE_1_HIGH[16] = { // NOLINT
+    TOO_LONG,
+    TOO_LONG,
+    TOO_LONG,
+    TOO_LONG,
+    TOO_LONG,
+    TOO_LONG,
+    TOO_LONG,
+    TOO_LONG,
+    TWO_CONTS,
+    TWO_CONTS,
+    TWO_CONTS,
+    TWO_CONTS,
+    TOO_SHORT | OVERLONG_2,
+    TOO_SHORT,
+    TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+};
+
+static constexpr u8 BYTE_1_LOW[16] = { // NOLINT
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+};
+
+static constexpr u8 BYTE_2_HIGH[16] = { // NOLINT
+    TOO_SHORT,
+    TOO_SHORT,
+    TOO_SHORT,
+    TOO_SHORT,
+    TOO_SHORT,
+    TOO_SHORT,
+    TOO_SHORT,
+    TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 |
+        OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_SHORT,
+    TOO_SHORT,
+    TOO_SHORT,
+    TOO_SHORT,
+};
+
+static constexpr u8 BIT_OF[16] = {1, 2, 4, 8, 16, 32, 64, 128, // NOLINT
+                                  1, 2, 4, 8, 16, 32, 64, 128};
+
+[[gnu::target("avx2")]] inline auto table(const u8 *entries) -> __m256i {
+  return _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(entries))); // NOLINT
+}
+
+[[gnu::target("avx2")]] inline auto load(const u8 *src) -> __m256i {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src)); // NOLINT
+}
+
+[[gnu::target("avx2")]] inline auto high_nibble(const __m256i bytes)
+    -> __m256i {
+  return _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0f));
+}
+
+// The block shifted N bytes later, with the tail of `prev` moved in front.
+template <int N>
+[[gnu::target("avx2")]] inline auto prev_bytes(const __m256i input,
+                                               const __m256i prev) -> __m256i {
+  return _mm256_alignr_epi8(
+      input, _mm256_permute2x128_si256(prev, input, 0x21), 16 - N);
+}
+
+[[gnu::target("avx2")]] inline auto block_errors(const __m256i input,
+                                                 const __m256i prev)
+    -> __m256i {
+  const auto prev1 = prev_bytes<1>(input, prev);
+  const auto special = _mm256_and_si256(
+      _mm256_and_si256(
+          _mm256_shuffle_epi8(table(BYTE_1_HIGH), high_nibble(prev1)),
+          _mm256_shuffle_epi8(
+              table(BYTE_1_LOW),
+              _mm256_and_si256(prev1, _mm256_set1_epi8(0x0f)))),
+      _mm256_shuffle_epi8(table(BYTE_2_HIGH), high_nibble(input)));
+
+  const auto third = _mm256_subs_epu8(prev_bytes<2>(input, prev),
+                                      _mm256_set1_epi8(0xe0 - 0x80));
+  const auto fourth = _mm256_subs_epu8(prev_bytes<3>(input, prev),
+                                       _mm256_set1_epi8(0xf0 - 0x80));
+  const auto must_continue = _mm256_and_si256(
+      _mm256_or_si256(third, fourth),
+      _mm256_set1_epi8(static_cast<char>(0x80)));
+  return _mm256_xor_si256(must_continue, special);
+}
+
+// Non-zero when the block ends inside a multi-byte sequence.
+[[gnu::target("avx2")]] inline auto block_incomplete(const __m256i input)
+    -> __m256i {
+  const auto max = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, static_cast<char>(0xf0 - 1),
+      static_cast<char>(0xe0 - 1), static_cast<char>(0xc0 - 1));
+  return _mm256_subs_epu8(input, max);
+}
+
+// Restarts the scalar validator on the character boundary at or before
+// block `at`, which the vector pass has already proven good up to.
+[[nodiscard]] inline auto rescan(const u8 *src, const usize len,
+                                 const usize at) -> Result<usize, Utf8Error> {
+  auto start = at >= 3 ? at - 3 : 0;
+  while (start < at && (src[start] & 0xc0) == 0x80) {
+    ++start;
+  }
+  return scalar::validate(src, len, start);
+}
+
+[[gnu::target("avx2")]] inline auto validate(const u8 *src, const usize len)
+    -> Result<usize, Utf8Error> {
+  auto prev = _mm256_setzero_si256();
+  auto incomplete = _mm256_setzero_si256();
+  usize at = 0;
+  u8 tail[BLOCK]{}; // NOLINT
+
+  while (at < len) {
+    __m256i input;
+    if (at + BLOCK <= len) {
+      input = load(src + at);
+    } else {
+      std::memcpy(tail, src + at, len - at);
+      input = load(tail);
+    }
+
+    if (_mm256_movemask_epi8(input) == 0) {
+      if (_mm256_testz_si256(incomplete, incomplete) == 0) {
+        return rescan(src, len, at);
+      }
+    } else {
+      const auto errors = block_errors(input, prev);
+      if (_mm256_testz_si256(errors, errors) == 0) {
+        return rescan(src, len, at);
+      }
+      incomplete = block_incomplete(input);
+    }
+    prev = input;
+    at += BLOCK;
+  }
+  if (_mm256_testz_si256(incomplete, incomplete) == 0) {
+    return rescan(src, len, at - BLOCK);
+  }
+  return {len};
+}
+
+[[gnu::target("avx2")]] inline auto decode(const u8 *src, const usize len,
+                                           u32 *out, const usize cap)
+    -> Result<usize, Utf8Error> {
+  usize at = 0;
+  usize written = 0;
+  // Runs of 16 ASCII bytes widen straight to code points.
+  while (at + 16 <= len && written + 16 <= cap) {
+    const auto bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + at)); // NOLINT
+    if (_mm_movemask_epi8(bytes) != 0) {
+      // Decode the rest of this block one character at a time; the scalar
+      // decoder copes with a character crossing into the next one.
+      const auto block_end = at + 16;
+      while (at < block_end && written < cap) {
+        const auto width = decode_one(src + at, len - at, out[written]);
+        if (width == 0) {
+          return {Utf8Error{at}};
+        }
+        at += width;
+        ++written;
+      }
+      continue;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + written), // NOLINT
+                        _mm256_cvtepu8_epi32(bytes));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i *>(out + written + 8), // NOLINT
+        _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8)));
+    at += 16;
+    written += 16;
+  }
+  return scalar::decode(src, len, out, cap, at, written);
+}
+
+// Bit i is set when byte i of the block is in the class.
+[[gnu::target("avx2")]] inline auto class_mask(const __m256i bytes,
+                                               const __m256i low,
+                                               const __m256i high) -> u32 {
+  const auto rows = _mm256_or_si256(
+      _mm256_shuffle_epi8(low, bytes),
+      _mm256_shuffle_epi8(
+          high,
+          _mm256_xor_si256(bytes, _mm256_set1_epi8(static_cast<char>(0x80)))));
+  const auto column = _mm256_shuffle_epi8(
+      table(BIT_OF),
+      _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x07)));
+  const auto miss = _mm256_cmpeq_epi8(_mm256_and_si256(rows, column),
+                                      _mm256_setzero_si256());
+  return ~static_cast<u32>(_mm256_movemask_epi8(miss));
+}
+
+[[gnu::target("avx2")]] inline auto skip_while(const u8 *src, const usize len,
+                                               const CharClass &cls,
+                                               usize at) -> usize {
+  const auto low = table(cls.low_table);
+  const auto high = table(cls.high_table);
+  for (; at + BLOCK <= len; at += BLOCK) {
+    const auto outside = ~class_mask(load(src + at), low, high);
+    if (outside != 0) {
+      return at + static_cast<usize>(std::countr_zero(outside));
+    }
+  }
+  return scalar::skip_while(src, len, cls, at);
+}
+
+[[gnu::target("avx2")]] inline auto find_first_of(const u8 *src,
+                                                  const usize len,
+                                                  const CharClass &cls,
+                                                  usize at) -> usize {
+  const auto low = table(cls.low_table);
+  const auto high = table(cls.high_table);
+  for (; at + BLOCK <= len; at += BLOCK) {
+    const auto inside = class_mask(load(src + at), low, high);
+    if (inside != 0) {
+      return at + static_cast<usize>(std::countr_zero(inside));
+    }
+  }
+  return scalar::find_first_of(src, len, cls, at);
+}
+
+} // namespace avx2
+#endif
+
+[[nodiscard]] inline auto detect_isa() -> Isa {
+#ifdef EXL_TEXT_X86
+  if (__builtin_cpu_supports("avx2")) {
+    return Isa::Avx2;
+  }
+#endif
+  return Isa::Scalar;
+}
+
+[[nodiscard]] inline auto active_isa() -> Isa & {
+  static auto isa = detect_isa();
+  return isa;
+}
+
+} // namespace exl::text::impl
+
+namespace exl::text {
+
+[[nodiscard]] inline auto isa() -> Isa { return impl::active_isa(); }
+
+// Limits the kernels to `want`, e.g. to compare them in tests and
+// benchmarks. An ISA the CPU lacks is ignored; returns the one now in use.
+inline auto set_isa(const Isa want) -> Isa {
+  impl::active_isa() = std::min(want, impl::detect_isa());
+  return impl::active_isa();
+}
+
+// Checks that `bytes` is well formed UTF-8, returning its length or the
+// offset of the first byte that is not.
+[[nodiscard]] inline auto validate(const Slice<const u8> bytes)
+    -> Result<usize, Utf8Error> {
+#ifdef EXL_TEXT_X86
+  if (isa() == Isa::Avx2) {
+    return impl::avx2::validate(bytes.as_ptr(), bytes.cap);
+  }
+#endif
+  return impl::scalar::validate(bytes.as_ptr(), bytes.cap);
+}
+
+// Decodes up to out.cap code points from `bytes`, returning how many were
+// written. out.cap == bytes.cap always suffices.
+[[nodiscard]] inline auto decode(const Slice<const u8> bytes,
+                                 const Slice<u32> out)
+    -> Result<usize, Utf8Error> {
+#ifdef EXL_TEXT_X86
+  if (isa() == Isa::Avx2) {
+    return impl::avx2::decode(bytes.as_ptr(), bytes.cap, out.as_ptr(),
+                              out.cap);
+  }
+#endif
+  return impl::scalar::decode(bytes.as_ptr(), bytes.cap, out.as_ptr(),
+                              out.cap);
+}
+
+// Offset of the first byte at or after `from` that is not in `cls`, or
+// bytes.cap if there is none.
+[[nodiscard]] inline auto skip_while(const Slice<const u8> bytes,
+                                     const CharClass &cls,
+                                     const usize from = 0) -> usize {
+  // Most lexer runs are a few bytes long and end before a vector pass
+  // would pay off.
+  const auto head = std::min(bytes.cap, from + impl::SHORT_RUN);
+  const auto at = impl::scalar::skip_while(bytes.as_ptr(), head, cls, from);
+  if (at < head || head == bytes.cap) {
+    return at;
+  }
+#ifdef EXL_TEXT_X86
+  if (isa() == Isa::Avx2) {
+    return impl::avx2::skip_while(bytes.as_ptr(), bytes.cap, cls, at);
+  }
+#endif
+  return impl::scalar::skip_while(bytes.as_ptr(), bytes.cap, cls, at);
+}
+
+// Offset of the first byte at or after `from` that is in `cls`.
+[[nodiscard]] inline auto find_first_of(const Slice<const u8> bytes,
+                                        const CharClass &cls,
+                                        const usize from = 0)
+    -> Option<usize> {
+  const auto head = std::min(bytes.cap, from + impl::SHORT_RUN);
+  auto at = impl::scalar::find_first_of(bytes.as_ptr(), head, cls, from);
+  if (at == head && head < bytes.cap) {
+#ifdef EXL_TEXT_X86
+    if (isa() == Isa::Avx2) {
+      at = impl::avx2::find_first_of(bytes.as_ptr(), bytes.cap, cls, at);
+    } else {
+      at = impl::scalar::find_first_of(bytes.as_ptr(), bytes.cap, cls, at);
+    }
+#else
+    at = impl::scalar::find_first_of(bytes.as_ptr(), bytes.cap, cls, at);
+#endif
+  }
+  if (at >= bytes.cap) {
+    return {};
+  }
+  return {at};
+}
+
+} // namespace exl::text
@@ -4,6 +4,8 @@
 
 #include <csignal>
 #include <atomic>
+#include <type_traits>
+#include <utility>
 
 #include <ucontext.h>
 #include <execinfo.h>
@@ -100,4 +102,140 @@ auto panic_register() -> void {
   }
 }
 
-} // namespace exl
\ No newline at end of file
+// Zig style error return trace: constructing an error starts a fresh trace
+// at its origin, every propagation site that passes it up records its own
+// address here, and nothing is symbolized until the trace is formatted.
+template <usize N = 32> struct BasicErrorTrace {
+  using Self = BasicErrorTrace<N>;
+
+  void *frames[N]{}; // NOLINT
+  usize len{};
+  usize dropped{};
+
+  auto push(void *addr) -> void {
+    if (len < N) {
+      frames[len++] = addr;
+    } else {
+      ++dropped;
+    }
+  }
+
+  auto clear() -> void {
+    len = 0;
+    dropped = 0;
+  }
+
+  [[nodiscard]] auto is_empty() const -> bool { return len == 0; }
+};
+
+using ErrorTrace = BasicErrorTrace<>;
+
+namespace trace {
+
+[[nodiscard]] inline auto local() -> ErrorTrace & {
+  thread_local ErrorTrace trace{};
+  return trace;
+}
+
+// Records the caller's address, i.e. the site propagating the error.
+[[gnu::noinline]] inline auto record() -> void {
+  local().push(__builtin_extract_return_addr(__builtin_return_address(0)));
+}
+
+// Drops the hops of earlier errors, which were handled or given up on, and
+// records the caller as the origin of a new one.
+[[gnu::noinline]] inline auto begin() -> void {
+  auto &trace = local();
+  trace.clear();
+  trace.push(__builtin_extract_return_addr(__builtin_return_address(0)));
+}
+
+// An error on its way up, which Result takes without starting a new trace.
+template <typename E> struct Propagated {
+  E err;
+};
+
+template <typename E>
+[[nodiscard]] auto propagate(E &&err) -> Propagated<std::remove_cvref_t<E>> {
+  return {std::forward<E>(err)};
+}
+
+inline auto clear() -> void { local().clear(); }
+
+// Fills `frames` with the return addresses of the calling stack, innermost
+// first, and returns how many were written.
+[[gnu::noinline]] inline auto capture(void **frames, const usize max) -> usize {
+  return static_cast<usize>(backtrace(frames, static_cast<int>(max)));
+}
+
+// Hands back the trace gathered so far and starts a fresh one.
+[[nodiscard]] inline auto take() -> ErrorTrace {
+  auto ret = local();
+  local().clear();
+  return ret;
+}
+
+} // namespace trace
+
+} // namespace exl
+
+#ifndef EXL_NO_ERROR_TRACE
+#define EXL_TRACE_BEGIN() ::exl::trace::begin()
+#define EXL_TRACE_HOP() ::exl::trace::record()
+#else
+#define EXL_TRACE_BEGIN() ((void)0)
+#define EXL_TRACE_HOP() ((void)0)
+#endif
+
+// Unwraps an Ok value or returns the error from the enclosing function,
+// recording the hop in the error return trace. This is a GNU statement
+// expression: GCC and Clang accept it under -std=c++20 as well, with
+// CMAKE_CXX_EXTENSIONS off, but -Wpedantic flags it and MSVC rejects it.
+// EXL_TRY_LET is the portable form.
+#define EXL_TRY(...)                                                           \
+  ({                                                                           \
+    auto exl_try_res_ = (__VA_ARGS__);                                         \
+    if (exl_try_res_.is_err()) [[unlikely]] {                                  \
+      EXL_TRACE_HOP();                                                         \
+      return ::exl::trace::propagate(std::get<1>(std::move(exl_try_res_)));    \
+    }                                                                          \
+    std::get<0>(std::move(exl_try_res_));                                      \
+  })
+
+template <usize N> struct fmt::formatter<exl::BasicErrorTrace<N>> {
+  constexpr auto parse(format_parse_context &ctx) -> decltype(ctx.begin()) {
+    return ctx.begin();
+  }
+
+  template <typename FormatContext>
+  auto format(const exl::BasicErrorTrace<N> &trace, FormatContext &ctx) const
+      -> decltype(ctx.out()) {
+    auto out = ctx.out();
+    if (trace.is_empty()) {
+      return fmt::format_to(out, "Error return trace: <empty>");
+    }
+
+    out = fmt::format_to(out, "Error return trace:");
+    auto symbols = backtrace_symbols(
+        const_cast<void *const *>(trace.frames), // NOLINT
+        static_cast<int>(trace.len));
+    for (usize i = 0; i < trace.len; ++i) {
+      out = fmt::format_to(out, "\n  {}", symbols[i]); // NOLINT
+    }
+    if (trace.dropped != 0) {
+      out = fmt::format_to(out, "\n  ... {} more", trace.dropped);
+    }
+    std::free(symbols); // NOLINT
+    return out;
+  }
+};
+
+// Statement form of EXL_TRY in standard C++: declares `name` holding the
+// Ok value, or returns the error from the enclosing function.
+#define EXL_TRY_LET(name, ...)                                                 \
+  auto exl_try_##name##_ = (__VA_ARGS__);                                      \
+  if (exl_try_##name##_.is_err()) [[unlikely]] {                               \
+    EXL_TRACE_HOP();                                                           \
+    return ::exl::trace::propagate(std::get<1>(std::move(exl_try_##name##_))); \
+  }                                                                            \
+  auto name = std::get<0>(std::move(exl_try_##name##_))
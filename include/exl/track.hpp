@@ -0,0 +1,585 @@
+#pragma once
+
+#include <exl/fmt.hpp>
+#include <exl/mem.hpp>
+#include <exl/traceback.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace exl::mem {
+
+// Compile time tag name, e.g. TrackingAllocator<"parser", Node>.
+template <usize N> struct Name {
+  char str[N]{}; // NOLINT
+
+  consteval Name(const char (&_str)[N]) { // NOLINT
+    std::copy_n(_str, N, str);
+  }
+};
+
+} // namespace exl::mem
+
+namespace exl::mem::track {
+
+inline constexpr usize MAX_TAGS = 64;
+inline constexpr usize BUCKETS = 16;
+inline constexpr usize MAX_FRAMES = 32;
+
+// Live bytes a thread accumulates before publishing them, which bounds the
+// error of peak_bytes to FLUSH per thread.
+inline constexpr s64 FLUSH = s64{64} << 10;
+
+// Bucket 0 counts sizes under 16 bytes, bucket i sizes in [8 << i, 16 << i),
+// the last bucket everything larger.
+[[nodiscard]] constexpr auto bucket_of(const usize size) -> usize {
+  return std::min<usize>(std::bit_width(size >> 4), BUCKETS - 1);
+}
+
+struct TagStats {
+  std::string_view name;
+  s64 live_bytes{};
+  s64 peak_bytes{};
+  u64 allocs{};
+  u64 frees{};
+  std::array<u64, BUCKETS> sizes{};
+};
+
+// Sampled allocations sharing one call stack.
+struct StackStats {
+  std::vector<void *> frames;
+  u64 live_objects{};
+  u64 live_bytes{};
+  u64 total_objects{};
+  u64 total_bytes{};
+};
+
+struct Snapshot {
+  std::vector<TagStats> tags;
+  std::vector<StackStats> stacks;
+  usize sample_rate{};
+};
+
+} // namespace exl::mem::track
+
+namespace exl::mem::impl {
+
+struct TagCounters {
+  std::atomic<s64> live;
+  std::atomic<u64> allocs;
+  std::atomic<u64> frees;
+  std::array<std::atomic<u64>, track::BUCKETS> sizes;
+};
+
+// Counters owned by one thread. Only the owner writes them, with plain
+// relaxed load/store pairs, and snapshot() sums them under the registry
+// lock.
+struct ThreadCounters {
+  std::array<TagCounters, track::MAX_TAGS> tags{};
+  ThreadCounters *next{};
+  s64 until_sample{};
+  u64 rng{};
+};
+
+struct Registry {
+  std::mutex lock;
+  std::array<const char *, track::MAX_TAGS> names{};
+  usize count{};
+  ThreadCounters *threads{};
+  ThreadCounters retired{};
+  std::array<std::atomic<s64>, track::MAX_TAGS> live{};
+  std::array<std::atomic<s64>, track::MAX_TAGS> peak{};
+};
+
+struct LiveSample {
+  u32 stack;
+  usize size;
+};
+
+inline constexpr usize FILTER_SLOTS = 4096;
+
+// Sampled stacks, plus the sampled blocks still alive so frees can be
+// matched. `filter` counts the live samples hashing to each slot, so that
+// unsampled frees stay off the lock and a slot empties again once its last
+// sample is freed. Slots that reach the counter's limit stay set.
+struct Profile {
+  std::mutex lock;
+  std::vector<track::StackStats> stacks;
+  std::unordered_map<u64, u32> by_hash;
+  std::unordered_map<void *, LiveSample> live;
+  std::array<std::atomic<u16>, FILTER_SLOTS> filter{};
+};
+
+// NOLINTBEGIN
+inline constinit std::atomic<bool> TRACKING{true};
+inline constinit std::atomic<usize> SAMPLE_RATE{0};
+inline constinit Registry REGISTRY{};
+inline Profile PROFILE{};
+inline constinit thread_local ThreadCounters *LOCAL = nullptr;
+inline constinit thread_local bool DETACHED = false;
+// NOLINTEND
+
+inline auto register_tag(const char *name) -> u32 {
+  const auto guard = std::lock_guard(REGISTRY.lock);
+  for (usize i = 0; i < REGISTRY.count; ++i) {
+    if (std::string_view(REGISTRY.names[i]) == name) {
+      return static_cast<u32>(i);
+    }
+  }
+  if (REGISTRY.count == track::MAX_TAGS - 1) {
+    REGISTRY.names[REGISTRY.count] = "<other>";
+    return static_cast<u32>(REGISTRY.count);
+  }
+  REGISTRY.names[REGISTRY.count] = name;
+  return static_cast<u32>(REGISTRY.count++);
+}
+
+template <typename T> auto bump(std::atomic<T> &counter, const T by) -> void {
+  counter.store(counter.load(std::memory_order_relaxed) + by,
+                std::memory_order_relaxed);
+}
+
+// Adds a thread's counters into `into`, which is the registry's record of
+// exited threads.
+inline auto fold(ThreadCounters &from, ThreadCounters &into) -> void {
+  for (usize tag = 0; tag < track::MAX_TAGS; ++tag) {
+    auto &src = from.tags[tag];
+    auto &dst = into.tags[tag];
+    REGISTRY.live[tag].fetch_add(src.live.exchange(0),
+                                 std::memory_order_relaxed);
+    bump(dst.allocs, src.allocs.load(std::memory_order_relaxed));
+    bump(dst.frees, src.frees.load(std::memory_order_relaxed));
+    for (usize i = 0; i < track::BUCKETS; ++i) {
+      bump(dst.sizes[i], src.sizes[i].load(std::memory_order_relaxed));
+    }
+  }
+}
+
+struct ThreadGuard {
+  ThreadGuard() = default;
+  ThreadGuard(const ThreadGuard &) = delete;
+  auto operator=(const ThreadGuard &) -> ThreadGuard & = delete;
+
+  ~ThreadGuard() {
+    auto *local = std::exchange(LOCAL, nullptr);
+    DETACHED = true;
+    const auto guard = std::lock_guard(REGISTRY.lock);
+    fold(*local, REGISTRY.retired);
+    for (auto **link = &REGISTRY.threads; *link != nullptr;
+         link = &(*link)->next) {
+      if (*link == local) {
+        *link = local->next;
+        break;
+      }
+    }
+    delete local; // NOLINT
+  }
+};
+
+// Null once the thread's guard has run: thread_local destructors that
+// still allocate or free go through count_detached instead, since a guard
+// cannot be constructed a second time to fold new counters.
+[[gnu::noinline]] inline auto attach_thread() -> ThreadCounters * {
+  if (DETACHED) {
+    return nullptr;
+  }
+  auto *local = new ThreadCounters(); // NOLINT
+  local->rng = reinterpret_cast<u64>(local) | 1; // NOLINT
+  {
+    const auto guard = std::lock_guard(REGISTRY.lock);
+    local->next = REGISTRY.threads;
+    REGISTRY.threads = local;
+  }
+  LOCAL = local;
+  static thread_local ThreadGuard guard;
+  return local;
+}
+
+// Counts straight into the exited threads' totals, under the lock.
+[[gnu::noinline]] inline auto count_detached(const u32 tag, const usize size,
+                                             const bool freed) -> void {
+  const auto guard = std::lock_guard(REGISTRY.lock);
+  auto &counters = REGISTRY.retired.tags[tag];
+  if (freed) {
+    REGISTRY.live[tag].fetch_sub(static_cast<s64>(size),
+                                 std::memory_order_relaxed);
+    bump(counters.frees, u64{1});
+  } else {
+    REGISTRY.live[tag].fetch_add(static_cast<s64>(size),
+                                 std::memory_order_relaxed);
+    bump(counters.allocs, u64{1});
+    bump(counters.sizes[track::bucket_of(size)], u64{1});
+  }
+}
+
+// Publishes the thread's live delta once it passes FLUSH either way.
+inline auto publish(const u32 tag, std::atomic<s64> &delta) -> void {
+  const auto pending = delta.load(std::memory_order_relaxed);
+  if (pending < track::FLUSH && pending > -track::FLUSH) {
+    return;
+  }
+  delta.store(0, std::memory_order_relaxed);
+  const auto live = REGISTRY.live[tag].fetch_add(
+                        pending, std::memory_order_relaxed) +
+                    pending;
+  auto peak = REGISTRY.peak[tag].load(std::memory_order_relaxed);
+  while (live > peak && !REGISTRY.peak[tag].compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+// Bytes until the next sample, exponentially distributed around the rate
+// so that samples form a Poisson process, as pprof expects.
+inline auto next_sample(ThreadCounters &local, const usize rate) -> s64 {
+  local.rng ^= local.rng << 13;
+  local.rng ^= local.rng >> 7;
+  local.rng ^= local.rng << 17;
+  const auto unit = static_cast<d64>(local.rng >> 11) * 0x1p-53;
+  return static_cast<s64>(-std::log1p(-unit) * static_cast<d64>(rate)) + 1;
+}
+
+[[nodiscard]] inline auto filter_slot(const void *ptr) -> usize {
+  return (reinterpret_cast<u64>(ptr) * 0x9e3779b97f4a7c15ULL) >> 52; // NOLINT
+}
+
+// Called under PROFILE.lock, which orders the writers; readers only test
+// for zero.
+inline auto filter_add(const void *ptr, const s32 by) -> void {
+  auto &slot = PROFILE.filter[filter_slot(ptr)];
+  const auto count = slot.load(std::memory_order_relaxed);
+  if (count != std::numeric_limits<u16>::max()) {
+    slot.store(static_cast<u16>(count + by), std::memory_order_relaxed);
+  }
+}
+
+[[gnu::noinline]] inline auto take_sample(void *ptr, const usize size)
+    -> void {
+  void *frames[track::MAX_FRAMES + 2]; // NOLINT
+  const auto depth = trace::capture(frames, track::MAX_FRAMES + 2);
+  // Drops the frames of capture() and of this function.
+  const auto stack =
+      std::vector<void *>(frames + std::min<usize>(depth, 2), frames + depth);
+
+  u64 hash = 0xcbf29ce484222325ULL;
+  for (auto *frame : stack) {
+    hash = (hash ^ reinterpret_cast<u64>(frame)) * 0x100000001b3ULL; // NOLINT
+  }
+
+  const auto guard = std::lock_guard(PROFILE.lock);
+  auto [it, inserted] = PROFILE.by_hash.try_emplace(
+      hash, static_cast<u32>(PROFILE.stacks.size()));
+  if (inserted) {
+    PROFILE.stacks.push_back({stack});
+  }
+  auto &stats = PROFILE.stacks[it->second];
+  ++stats.live_objects;
+  stats.live_bytes += size;
+  ++stats.total_objects;
+  stats.total_bytes += size;
+  if (PROFILE.live.insert_or_assign(ptr, LiveSample{it->second, size})
+          .second) {
+    filter_add(ptr, 1);
+  }
+}
+
+[[gnu::noinline]] inline auto drop_sample(void *ptr) -> void {
+  const auto guard = std::lock_guard(PROFILE.lock);
+  const auto it = PROFILE.live.find(ptr);
+  if (it == PROFILE.live.end()) {
+    return;
+  }
+  auto &stats = PROFILE.stacks[it->second.stack];
+  --stats.live_objects;
+  stats.live_bytes -= it->second.size;
+  PROFILE.live.erase(it);
+  filter_add(ptr, -1);
+}
+
+} // namespace exl::mem::impl
+
+namespace exl::mem {
+
+// Dense id of a tag, assigned once per name at static initialisation.
+template <Name Tag> inline const u32 TAG_ID = impl::register_tag(Tag.str);
+
+} // namespace exl::mem
+
+namespace exl::mem::track {
+
+// Runtime switch. Flip it only while no tracked memory is live, or live
+// bytes will drift by the allocations seen on one side only.
+inline auto set_enabled(const bool enabled) -> void {
+  impl::TRACKING.store(enabled, std::memory_order_relaxed);
+}
+
+[[nodiscard]] inline auto enabled() -> bool {
+  return impl::TRACKING.load(std::memory_order_relaxed);
+}
+
+// Captures a stack for one allocation per `bytes` on average, 0 to stop.
+inline auto set_sample_rate(const usize bytes) -> void {
+  impl::SAMPLE_RATE.store(bytes, std::memory_order_relaxed);
+}
+
+#ifndef EXL_NO_ALLOC_TRACKING
+
+inline auto record_alloc(const u32 tag, void *ptr, const usize size) -> void {
+  if (!enabled()) {
+    return;
+  }
+  auto *local = impl::LOCAL;
+  if (local == nullptr) [[unlikely]] {
+    local = impl::attach_thread();
+    if (local == nullptr) {
+      impl::count_detached(tag, size, false);
+      return;
+    }
+  }
+  auto &counters = local->tags[tag];
+  impl::bump(counters.live, static_cast<s64>(size));
+  impl::bump(counters.allocs, u64{1});
+  impl::bump(counters.sizes[bucket_of(size)], u64{1});
+  impl::publish(tag, counters.live);
+
+  if (const auto rate = impl::SAMPLE_RATE.load(std::memory_order_relaxed);
+      rate != 0) [[unlikely]] {
+    local->until_sample -= static_cast<s64>(size);
+    if (local->until_sample <= 0) {
+      // The first allocation of a thread only arms the countdown.
+      const auto first = local->until_sample + static_cast<s64>(size) == 0;
+      local->until_sample = impl::next_sample(*local, rate);
+      if (!first) {
+        impl::take_sample(ptr, size);
+      }
+    }
+  }
+}
+
+inline auto record_free(const u32 tag, void *ptr, const usize size) -> void {
+  if (!enabled()) {
+    return;
+  }
+  auto *local = impl::LOCAL;
+  if (local == nullptr) [[unlikely]] {
+    local = impl::attach_thread();
+  }
+  if (local != nullptr) [[likely]] {
+    auto &counters = local->tags[tag];
+    impl::bump(counters.live, -static_cast<s64>(size));
+    impl::bump(counters.frees, u64{1});
+    impl::publish(tag, counters.live);
+  } else {
+    impl::count_detached(tag, size, true);
+  }
+
+  if (impl::PROFILE.filter[impl::filter_slot(ptr)].load(
+          std::memory_order_relaxed) != 0) [[unlikely]] {
+    impl::drop_sample(ptr);
+  }
+}
+
+#else
+
+inline auto record_alloc(const u32 /*tag*/, void * /*ptr*/,
+                         const usize /*size*/) -> void {}
+
+inline auto record_free(const u32 /*tag*/, void * /*ptr*/,
+                        const usize /*size*/) -> void {}
+
+#endif
+
+// Merges the counters of every thread, live and exited, with the sampled
+// stacks.
+[[nodiscard]] inline auto snapshot() -> Snapshot {
+  auto ret = Snapshot();
+  ret.sample_rate = impl::SAMPLE_RATE.load(std::memory_order_relaxed);
+  {
+    const auto guard = std::lock_guard(impl::REGISTRY.lock);
+    for (usize tag = 0;
+         tag < MAX_TAGS && impl::REGISTRY.names[tag] != nullptr; ++tag) {
+      auto stats = TagStats{impl::REGISTRY.names[tag]};
+      stats.live_bytes =
+          impl::REGISTRY.live[tag].load(std::memory_order_relaxed);
+      stats.peak_bytes =
+          impl::REGISTRY.peak[tag].load(std::memory_order_relaxed);
+      const auto add = [&stats](const impl::TagCounters &counters) {
+        stats.live_bytes += counters.live.load(std::memory_order_relaxed);
+        stats.allocs += counters.allocs.load(std::memory_order_relaxed);
+        stats.frees += counters.frees.load(std::memory_order_relaxed);
+        for (usize i = 0; i < BUCKETS; ++i) {
+          stats.sizes[i] += counters.sizes[i].load(std::memory_order_relaxed);
+        }
+      };
+      add(impl::REGISTRY.retired.tags[tag]);
+      for (auto *local = impl::REGISTRY.threads; local != nullptr;
+           local = local->next) {
+        add(local->tags[tag]);
+      }
+      stats.peak_bytes = std::max(stats.peak_bytes, stats.live_bytes);
+      ret.tags.push_back(stats);
+    }
+  }
+  {
+    const auto guard = std::lock_guard(impl::PROFILE.lock);
+    ret.stacks = impl::PROFILE.stacks;
+  }
+  return ret;
+}
+
+// Writes the sampled stacks in the legacy gperftools heap profile format,
+// which `pprof <binary> <file>` reads. pprof scales the samples back up
+// with the sample rate given in the header.
+template <typename OutputIt>
+auto format_pprof(const Snapshot &snap, OutputIt out) -> OutputIt {
+  auto total = StackStats();
+  for (const auto &stack : snap.stacks) {
+    total.live_objects += stack.live_objects;
+    total.live_bytes += stack.live_bytes;
+    total.total_objects += stack.total_objects;
+    total.total_bytes += stack.total_bytes;
+  }
+
+  out = fmt::format_to(out, "heap profile: {}: {} [{}: {}] @ heap_v2/{}\n",
+                       total.live_objects, total.live_bytes,
+                       total.total_objects, total.total_bytes,
+                       snap.sample_rate);
+  for (const auto &stack : snap.stacks) {
+    out = fmt::format_to(out, "{}: {} [{}: {}] @", stack.live_objects,
+                         stack.live_bytes, stack.total_objects,
+                         stack.total_bytes);
+    for (auto *frame : stack.frames) {
+      out = fmt::format_to(out, " {}", fmt::ptr(frame));
+    }
+    out = fmt::format_to(out, "\n");
+  }
+
+  out = fmt::format_to(out, "\nMAPPED_LIBRARIES:\n");
+  if (auto *maps = std::fopen("/proc/self/maps", "r"); maps != nullptr) {
+    char buf[4096]; // NOLINT
+    for (usize len = 0; (len = std::fread(buf, 1, sizeof(buf), maps)) != 0;) {
+      out = std::copy_n(buf, len, out);
+    }
+    std::fclose(maps); // NOLINT
+  }
+  return out;
+}
+
+} // namespace exl::mem::track
+
+namespace exl::mem {
+
+// Allocator that records every allocation under Tag before passing it on
+// to Inner.
+template <Name Tag, typename T, typename Inner = std::allocator<T>>
+struct TrackingAllocator {
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other =
+        TrackingAllocator<Tag, U,
+                          typename std::allocator_traits<
+                              Inner>::template rebind_alloc<U>>;
+  };
+
+  [[no_unique_address]] Inner inner{};
+
+  [[nodiscard]] auto allocate(const usize len) -> T * {
+    auto *ret = inner.allocate(len);
+    track::record_alloc(TAG_ID<Tag>, ret, len * sizeof(T));
+    return ret;
+  }
+
+  auto deallocate(T *ptr, const usize len) -> void {
+    track::record_free(TAG_ID<Tag>, ptr, len * sizeof(T));
+    inner.deallocate(ptr, len);
+  }
+
+  [[nodiscard]] constexpr TrackingAllocator() = default;
+
+  template <typename U, typename I>
+  [[nodiscard]] constexpr TrackingAllocator( // NOLINT
+      const TrackingAllocator<Tag, U, I> &other)
+      : inner(other.inner) {}
+
+  [[nodiscard]] friend constexpr auto operator==(const TrackingAllocator &rhs,
+                                                 const TrackingAllocator &lhs)
+      -> bool {
+    return rhs.inner == lhs.inner;
+  }
+};
+
+// The same accounting as a std::pmr::memory_resource over `upstream`.
+template <Name Tag>
+struct TrackingResource final : std::pmr::memory_resource {
+  std::pmr::memory_resource *upstream;
+
+  [[nodiscard]] explicit TrackingResource(
+      std::pmr::memory_resource *_upstream = std::pmr::new_delete_resource())
+      : upstream{_upstream} {}
+
+private:
+  auto do_allocate(const usize bytes, const usize align) -> void * override {
+    auto *ret = upstream->allocate(bytes, align);
+    track::record_alloc(TAG_ID<Tag>, ret, bytes);
+    return ret;
+  }
+
+  auto do_deallocate(void *ptr, const usize bytes, const usize align)
+      -> void override {
+    track::record_free(TAG_ID<Tag>, ptr, bytes);
+    upstream->deallocate(ptr, bytes, align);
+  }
+
+  [[nodiscard]] auto do_is_equal(const std::pmr::memory_resource &other) const
+      noexcept -> bool override {
+    return this == &other;
+  }
+};
+
+} // namespace exl::mem
+
+template <> struct fmt::formatter<exl::mem::track::Snapshot> {
+  constexpr auto parse(format_parse_context &ctx) -> decltype(ctx.begin()) {
+    return ctx.begin();
+  }
+
+  template <typename FormatContext>
+  auto format(const exl::mem::track::Snapshot &snap, FormatContext &ctx) const
+      -> decltype(ctx.out()) {
+    auto out = fmt::format_to(ctx.out(), "{:<20} {:>14} {:>14} {:>12} {:>12}",
+                              "tag", "live bytes", "peak bytes", "allocs",
+                              "frees");
+    for (const auto &tag : snap.tags) {
+      out = fmt::format_to(out, "\n{:<20} {:>14} {:>14} {:>12} {:>12}",
+                           tag.name, tag.live_bytes, tag.peak_bytes,
+                           tag.allocs, tag.frees);
+      if (tag.allocs == 0) {
+        continue;
+      }
+      out = fmt::format_to(out, "\n  sizes:");
+      for (usize i = 0; i < exl::mem::track::BUCKETS; ++i) {
+        if (tag.sizes[i] == 0) {
+          continue;
+        }
+        out = i + 1 == exl::mem::track::BUCKETS
+                  ? fmt::format_to(out, " >={}:{}", usize{8} << i,
+                                   tag.sizes[i])
+                  : fmt::format_to(out, " <{}:{}", usize{16} << i,
+                                   tag.sizes[i]);
+      }
+    }
+    return out;
+  }
+};
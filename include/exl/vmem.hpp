@@ -0,0 +1,245 @@
+#pragma once
+
+#include <exl/check.hpp>
+#include <exl/iter.hpp>
+#include <exl/mem.hpp>
+#include <exl/option.hpp>
+#include <exl/types.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include <sys/mman.h>
+
+namespace exl::mem {
+
+inline constexpr usize PAGE = usize{4} << 10;
+inline constexpr usize HUGE_PAGE = usize{2} << 20;
+
+[[nodiscard]] constexpr auto round_up(const usize size, const usize align)
+    -> usize {
+  return (size + align - 1) & ~(align - 1);
+}
+
+namespace impl {
+
+// Maps `bytes` of anonymous memory starting on an `align` boundary by
+// mapping one alignment step more and trimming both ends. `bytes` and
+// `align` are multiples of PAGE. Null on failure.
+[[nodiscard]] inline auto map_aligned(const usize bytes, const usize align,
+                                      const int prot) -> u8 * {
+  const auto span = bytes + align - PAGE;
+  auto *base = static_cast<u8 *>(
+      mmap(nullptr, span, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+           -1, 0));
+  if (base == MAP_FAILED) {
+    return nullptr;
+  }
+  auto *start = ptr::offset<u8>(
+      round_up(reinterpret_cast<usize>(base), align)); // NOLINT
+  if (start != base) {
+    munmap(base, start - base);
+  }
+  if (const auto tail = span - (start - base) - bytes; tail != 0) {
+    munmap(start + bytes, tail);
+  }
+  return start;
+}
+
+// Out of line like the panics in check.hpp. Appends past the reservation
+// land here, as do commits the kernel refuses.
+[[noreturn, gnu::cold, gnu::noinline]] inline auto
+panic_full(const usize max_len, const usize len) -> void {
+  char msg[96]; // NOLINT
+  auto res = len >= max_len
+                 ? fmt::format_to_n(msg, sizeof(msg),
+                                    "VirtualBuffer is full at {} elements",
+                                    max_len)
+                 : fmt::format_to_n(msg, sizeof(msg),
+                                    "VirtualBuffer could not commit element {}",
+                                    len);
+  panic({msg, std::min(res.size, sizeof(msg))});
+  std::abort();
+}
+
+} // namespace impl
+
+// Growable array over a fixed range of reserved address space. Pages are
+// committed as the buffer grows and never move, so pointers, Slices and
+// Iters into it stay valid until the elements they cover are truncated.
+// Reservations of a huge page or more are huge page aligned and advised
+// for transparent huge pages, and commit in huge page steps.
+template <typename T> struct VirtualBuffer {
+  using Self = VirtualBuffer<T>;
+  using Val = T;
+  using Ptr = T *;
+  using Ref = T &;
+
+  using It = Iter<T>;
+  using CIt = CIter<T>;
+
+  Ptr ptr{};
+  usize len{};
+  usize committed{};
+  usize reserved{};
+
+  [[nodiscard]] constexpr auto size() const -> usize { return len; }
+  [[nodiscard]] constexpr auto is_empty() const -> bool { return len == 0; }
+  [[nodiscard]] constexpr auto data() const -> Ptr { return ptr; }
+
+  [[nodiscard]] constexpr auto capacity() const -> usize {
+    return committed / sizeof(T);
+  }
+
+  [[nodiscard]] constexpr auto max_size() const -> usize {
+    return reserved / sizeof(T);
+  }
+
+  // Granularity of commits and decommits.
+  [[nodiscard]] constexpr auto step() const -> usize {
+    return reserved >= HUGE_PAGE ? HUGE_PAGE : PAGE;
+  }
+
+  [[nodiscard]] constexpr auto as_ptr(const usize offset = 0) const -> Ptr {
+    return ptr::add(ptr, offset);
+  }
+
+  [[nodiscard]] constexpr auto as_slice() const -> Slice<T> {
+    return Slice<T>::from_unchecked(ptr, len);
+  }
+
+  [[nodiscard]] constexpr auto begin() const -> It {
+    return It::from_unchecked(ptr);
+  }
+  [[nodiscard]] constexpr auto end() const -> It {
+    return It::from_unchecked(this->as_ptr(len));
+  }
+
+  [[nodiscard]] constexpr auto operator[](const usize offset) const -> Ref {
+    if (offset >= len) [[unlikely]] {
+      exl::impl::panic_bounds(len, offset);
+    }
+    return ptr[offset];
+  }
+
+  // Makes room for at least `count` elements, committing geometrically so
+  // that appends cost one mprotect per doubling. False once `count` would
+  // pass the reservation.
+  [[nodiscard]] auto commit(const usize count) -> bool {
+    usize bytes = 0;
+    if (__builtin_mul_overflow(count, sizeof(T), &bytes)) [[unlikely]] {
+      return false;
+    }
+    if (bytes <= committed) {
+      return true;
+    }
+    if (bytes > reserved) {
+      return false;
+    }
+    const auto target = std::min(
+        round_up(std::max(bytes, committed * 2), this->step()), reserved);
+    if (mprotect(ptr::add(ptr::cast<u8>(ptr), committed), target - committed,
+                 PROT_READ | PROT_WRITE) != 0) {
+      return false;
+    }
+    committed = target;
+    return true;
+  }
+
+  template <typename... Args> auto emplace(Args &&...args) -> Ref {
+    if (!this->commit(len + 1)) [[unlikely]] {
+      impl::panic_full(this->max_size(), len);
+    }
+    auto *slot = new (this->as_ptr(len)) T(std::forward<Args>(args)...);
+    ++len;
+    return *slot;
+  }
+
+  auto push(const T &val) -> Self & {
+    this->emplace(val);
+    return *this;
+  }
+
+  auto truncate(const usize new_len) -> void {
+    if (new_len >= len) {
+      return;
+    }
+    std::destroy(this->as_ptr(new_len), this->as_ptr(len));
+    len = new_len;
+  }
+
+  auto clear() -> void { this->truncate(0); }
+
+  // Hands the pages past the last element back to the kernel. RSS drops
+  // right away, the address range stays reserved for regrowth.
+  auto shrink_to_fit() -> void {
+    const auto keep = round_up(len * sizeof(T), this->step());
+    if (keep >= committed) {
+      return;
+    }
+    auto *tail = ptr::add(ptr::cast<u8>(ptr), keep);
+    madvise(tail, committed - keep, MADV_DONTNEED);
+    mprotect(tail, committed - keep, PROT_NONE);
+    committed = keep;
+  }
+
+  [[nodiscard]] constexpr VirtualBuffer() = default;
+
+  VirtualBuffer(const VirtualBuffer &) = delete;
+  auto operator=(const VirtualBuffer &) -> VirtualBuffer & = delete;
+
+  VirtualBuffer(VirtualBuffer &&other) noexcept
+      : ptr{std::exchange(other.ptr, nullptr)},
+        len{std::exchange(other.len, 0)},
+        committed{std::exchange(other.committed, 0)},
+        reserved{std::exchange(other.reserved, 0)} {}
+
+  auto operator=(VirtualBuffer &&other) noexcept -> VirtualBuffer & {
+    std::swap(ptr, other.ptr);
+    std::swap(len, other.len);
+    std::swap(committed, other.committed);
+    std::swap(reserved, other.reserved);
+    return *this;
+  }
+
+  ~VirtualBuffer() {
+    if (ptr != nullptr) {
+      std::destroy(ptr, this->as_ptr(len));
+      munmap(ptr, reserved);
+    }
+  }
+
+  // Reserves address space for `max_len` elements without committing any
+  // memory, None if the size overflows or the range cannot be mapped.
+  [[nodiscard]] static auto reserve(const usize max_len) -> Option<Self> {
+    static_assert(alignof(T) <= PAGE);
+    usize bytes = 0;
+    if (max_len == 0 || __builtin_mul_overflow(max_len, sizeof(T), &bytes) ||
+        bytes > std::numeric_limits<usize>::max() - 2 * HUGE_PAGE) {
+      return {};
+    }
+
+    auto ret = Self();
+    ret.reserved = round_up(bytes, PAGE);
+    const auto align = ret.step();
+    ret.reserved = round_up(ret.reserved, align);
+
+    auto *start = impl::map_aligned(ret.reserved, align, PROT_NONE);
+    if (start == nullptr) {
+      return {};
+    }
+#ifdef MADV_HUGEPAGE
+    if (align == HUGE_PAGE) {
+      madvise(start, ret.reserved, MADV_HUGEPAGE);
+    }
+#endif
+
+    ret.ptr = ptr::cast<T>(start);
+    return {std::move(ret)};
+  }
+};
+
+} // namespace exl::mem
@@ -0,0 +1,101 @@
+// Replaces the global allocation functions with exl::mem::Heap. Built as the
+// exl_global_heap object library, which executables link to opt in.
+
+#include <exl/heap.hpp>
+
+#include <new>
+
+using exl::mem::Heap;
+
+namespace {
+
+auto alloc_or_throw(const usize size, const usize align) -> void * {
+  auto *ptr = Heap::alloc(size, align);
+  if (ptr == nullptr) [[unlikely]] {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+} // namespace
+
+// NOLINTBEGIN
+auto operator new(const usize size) -> void * {
+  return alloc_or_throw(size, 16);
+}
+
+auto operator new[](const usize size) -> void * {
+  return alloc_or_throw(size, 16);
+}
+
+auto operator new(const usize size, const std::align_val_t align) -> void * {
+  return alloc_or_throw(size, static_cast<usize>(align));
+}
+
+auto operator new[](const usize size, const std::align_val_t align)
+    -> void * {
+  return alloc_or_throw(size, static_cast<usize>(align));
+}
+
+auto operator new(const usize size, const std::nothrow_t & /*tag*/) noexcept
+    -> void * {
+  return Heap::alloc(size);
+}
+
+auto operator new[](const usize size, const std::nothrow_t & /*tag*/) noexcept
+    -> void * {
+  return Heap::alloc(size);
+}
+
+auto operator new(const usize size, const std::align_val_t align,
+                  const std::nothrow_t & /*tag*/) noexcept -> void * {
+  return Heap::alloc(size, static_cast<usize>(align));
+}
+
+auto operator new[](const usize size, const std::align_val_t align,
+                    const std::nothrow_t & /*tag*/) noexcept -> void * {
+  return Heap::alloc(size, static_cast<usize>(align));
+}
+
+auto operator delete(void *ptr) noexcept -> void { Heap::free(ptr); }
+
+auto operator delete[](void *ptr) noexcept -> void { Heap::free(ptr); }
+
+auto operator delete(void *ptr, const usize size) noexcept -> void {
+  Heap::free(ptr, size);
+}
+
+auto operator delete[](void *ptr, const usize size) noexcept -> void {
+  Heap::free(ptr, size);
+}
+
+auto operator delete(void *ptr, const std::align_val_t /*align*/) noexcept
+    -> void {
+  Heap::free(ptr);
+}
+
+auto operator delete[](void *ptr, const std::align_val_t /*align*/) noexcept
+    -> void {
+  Heap::free(ptr);
+}
+
+auto operator delete(void *ptr, const usize size,
+                     const std::align_val_t align) noexcept -> void {
+  Heap::free(ptr, size, static_cast<usize>(align));
+}
+
+auto operator delete[](void *ptr, const usize size,
+                       const std::align_val_t align) noexcept -> void {
+  Heap::free(ptr, size, static_cast<usize>(align));
+}
+
+auto operator delete(void *ptr, const std::nothrow_t & /*tag*/) noexcept
+    -> void {
+  Heap::free(ptr);
+}
+
+auto operator delete[](void *ptr, const std::nothrow_t & /*tag*/) noexcept
+    -> void {
+  Heap::free(ptr);
+}
+// NOLINTEND
@@ -0,0 +1,32 @@
+#pragma once
+
+// Replaces the global operator new and delete with counting wrappers around
+// malloc and free, for the tests and benchmarks that check how often code
+// allocates. Include it from exactly one file of a binary. Binaries linked
+// with exl_global_heap keep its allocator, and the count stays at zero.
+
+#include <exl/types.hpp>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<usize> ALLOCATIONS = 0; // NOLINT
+
+#ifndef EXPRLIB_GLOBAL_HEAP
+
+[[gnu::noinline]] auto operator new(const usize size) -> void * {
+  ALLOCATIONS.fetch_add(1, std::memory_order_relaxed);
+  return std::malloc(size); // NOLINT
+}
+
+[[gnu::noinline]] auto operator delete(void *ptr) noexcept -> void {
+  std::free(ptr); // NOLINT
+}
+
+[[gnu::noinline]] auto operator delete(void *ptr,
+                                       usize /*unused*/) noexcept -> void {
+  std::free(ptr); // NOLINT
+}
+
+#endif
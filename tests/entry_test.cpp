@@ -1,12 +1,24 @@
 #include <exl/core.hpp>
 #include <gtest/gtest.h>
 
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <span>
+#include <thread>
+#include <unordered_map>
+
+#include <fcntl.h>
+
+#include "count_alloc.hpp"
+
 using namespace exl; // NOLINT
 
 TEST(fmt, TestPrint) {
   ::testing::internal::CaptureStdout();
   std::string_view world = "World";
   print("Hellol {}", world);
+  flush();
   ASSERT_EQ(::testing::internal::GetCapturedStdout(), "Hellol World");
 }
 
@@ -14,9 +26,59 @@ TEST(fmt, TestPrintln) {
   ::testing::internal::CaptureStdout();
   std::string_view world = "World";
   println("Hellol {}", world);
+  flush();
   ASSERT_EQ(::testing::internal::GetCapturedStdout(), "Hellol World\n");
 }
 
+TEST(fmt, TestPrintCompiled) {
+  ::testing::internal::CaptureStdout();
+  println(FMT_COMPILE("{} + {} = {}"), 1, 2, 3);
+  println("{}", "done");
+  flush();
+  ASSERT_EQ(::testing::internal::GetCapturedStdout(), "1 + 2 = 3\ndone\n");
+}
+
+TEST(fmt, TestPrintTerminal) {
+  auto *file = std::tmpfile();
+  ASSERT_EQ(impl::PrintBuffer(file).flush_at,
+            impl::PrintBuffer::PRINT_FLUSH_AT);
+  std::fclose(file); // NOLINT
+
+  // A pseudo terminal stands in for an interactive stdout.
+  const auto pty = posix_openpt(O_RDWR | O_NOCTTY);
+  ASSERT_GE(pty, 0);
+  file = fdopen(pty, "w");
+  ASSERT_EQ(impl::PrintBuffer(file).flush_at, 1);
+  std::fclose(file); // NOLINT
+}
+
+TEST(fmt, TestEprintln) {
+  ::testing::internal::CaptureStderr();
+  eprintln("Bad {}", 42); // NOLINT
+  ASSERT_EQ(::testing::internal::GetCapturedStderr(), "Bad 42\n");
+}
+
+TEST(strbuf, TestFormat) {
+  auto buf = InlineStrBuf<64>();
+  const auto before = ALLOCATIONS.load();
+
+  buf.format("{}-{}", 1, "two").push('|').center("mid", 7, '*').push('|');
+  buf.join(Range(1, 3), ", ");
+
+  ASSERT_EQ(ALLOCATIONS.load(), before);
+  ASSERT_EQ(buf.as_str(), "1-two|**mid**|1, 2, 3");
+  ASSERT_EQ(buf.as_slice().size(), buf.size());
+}
+
+TEST(strbuf, TestTruncate) {
+  char storage[4]; // NOLINT
+  auto buf = StrBuf(storage, sizeof(storage));
+  buf.format("{}", 123456).right("x", 3); // NOLINT
+
+  ASSERT_EQ(buf.as_str(), "1234");
+  ASSERT_EQ(buf.truncated, 5);
+}
+
 TEST(defer, TestDefer) {
   auto res = 0;
   {
@@ -42,6 +104,60 @@ TEST(iter, TestRangeNegative) {
   ASSERT_EQ(res, 0);
 }
 
+TEST(iter, TestRangeStep) {
+  auto res = std::vector<ssize>{};
+  for (auto i : Range(0, 7, 3)) {
+    res.push_back(i);
+  }
+  ASSERT_EQ(res, (std::vector<ssize>{0, 3, 6}));
+
+  res.clear();
+  for (auto i : Range(7, 0, -2)) {
+    res.push_back(i);
+  }
+  ASSERT_EQ(res, (std::vector<ssize>{7, 5, 3, 1}));
+
+  ASSERT_TRUE(Range(3, 0, 1).empty());
+  ASSERT_TRUE(Range::from(0, 3, 0).is_none());
+}
+
+// The fast path rests on Range being a counted loop: the trip count is
+// fixed on construction and end() sits at that index, so loops whose step
+// overshoots `last` still stop, and a range of any length is measured
+// without walking it.
+constexpr auto sum_range(const Range range) -> ssize {
+  ssize res = 0;
+  for (auto i : range) {
+    res += i;
+  }
+  return res;
+}
+
+TEST(iter, TestRangeTripCount) {
+  static_assert(sum_range(Range(0, 99, 7)) == 735);
+  static_assert(sum_range(Range(98, -1, -7)) == 735);
+  static_assert(sum_range(Range(5, 4, 1)) == 0);
+
+  constexpr auto huge = Range(0, ssize{1} << 40, 3);
+  static_assert(huge.size() == (usize{1} << 40) / 3 + 1);
+  static_assert(huge.end() - huge.begin() == ssize{huge.size()});
+  static_assert(*(huge.end() - 1) == ((ssize{1} << 40) / 3) * 3);
+  static_assert(std::is_trivially_copyable_v<RangeIter>);
+}
+
+TEST(iter, TestStaticRange) {
+  static_assert(StaticRange<0, 9, 3>::size() == 4);
+  static_assert(StaticRange<9, 0, -4>::size() == 3);
+  static_assert(StaticRange<1, 0>::size() == 0);
+
+  ssize res = 0;
+  static_for<0, 9, 3>([&res](auto i) {
+    static_assert(decltype(i)::value % 3 == 0);
+    res += i;
+  });
+  ASSERT_EQ(res, 18);
+}
+
 TEST(iter, TestIter) {
   const auto len = 10;
   u8 arr[len]{0};                                   // NOLINT
@@ -72,6 +188,35 @@ TEST(iter, TestAsRef) {
   ASSERT_EQ(0, cit.as_ref());
 }
 
+TEST(iter, TestIterArithmetic) {
+  const auto len = 5;
+  u8 arr[len]{1, 2, 3, 4, 5};              // NOLINT
+  auto it = Iter<u8>::from_unchecked(arr); // NOLINT
+  auto last = it + len;
+
+  ASSERT_EQ(last - it, len);
+  ASSERT_EQ(it[2], 3);
+  ASSERT_EQ(*(--last), 5);
+  ASSERT_EQ(last[-1], 4);
+  ASSERT_EQ(*(it++), 1);
+  ASSERT_EQ(*it, 2);
+  ASSERT_EQ(it[-1], 1);
+  ASSERT_TRUE(it < last);
+
+  static_assert([] {
+    s32 vals[3]{1, 2, 3}; // NOLINT
+    const auto end = Iter<s32, check::Checked>::from_unchecked(vals + 3);
+    return end[-3] + end[-1];
+  }() == 4);
+}
+
+TEST(iter, TestRangeRandomAccess) {
+  auto range = Range(0, 4, 1);
+  ASSERT_EQ(range.size(), 5);
+  ASSERT_EQ(range[3], 3);
+  ASSERT_EQ(*std::ranges::find(range, 2), 2);
+}
+
 TEST(mem, TestCopy) {
   // NOLINTBEGIN
   const auto len = 3;
@@ -138,7 +283,7 @@ TEST(mem, TestSliceSize) {
   u8 arr[len]{1, 2, 3};                             // NOLINT
   auto slice = Slice<u8>::from_unchecked(arr, len); // NOLINT
 
-  ASSERT_EQ(len - 1, slice.size());
+  ASSERT_EQ(len, slice.size());
 }
 
 TEST(mem, TestSliceIter) {
@@ -157,6 +302,1395 @@ TEST(mem, TestSliceIndex) {
   ASSERT_EQ(arr[1], slice[1]);
 }
 
+TEST(mem, TestSliceStdAlgorithms) {
+  const auto len = 5;
+  u8 arr[len]{5, 3, 1, 4, 2};                       // NOLINT
+  u8 out[len]{};                                    // NOLINT
+  auto slice = Slice<u8>::from_unchecked(arr, len); // NOLINT
+
+  std::sort(slice.begin(), slice.end());
+  std::copy(slice.cbegin(), slice.cend(), out);
+  for (auto i = 0; i < len; ++i) {
+    ASSERT_EQ(out[i], i + 1);
+  }
+
+  std::ranges::reverse(slice);
+  ASSERT_EQ(std::span<u8>(slice).front(), 5);
+  ASSERT_EQ(std::ranges::data(slice), arr);
+}
+
+TEST(mem, TestSliceGet) {
+  const auto len = 3;
+  u8 arr[len]{1, 2, 3};                             // NOLINT
+  auto slice = Slice<u8>::from_unchecked(arr, len); // NOLINT
+
+  ASSERT_TRUE(slice.get(2).contains(3));
+  ASSERT_TRUE(slice.get(3).is_none());
+
+  slice.get(0).unwrap() = 7;
+  ASSERT_EQ(arr[0], 7);
+  ASSERT_EQ(&slice.get_unchecked(1), &arr[1]);
+}
+
+TEST(mem, TestSlicePolicy) {
+  static_assert(check::Checked::enabled);
+  static_assert(!check::Unchecked::enabled);
+  static_assert(traits::CheckPolicy<check::DebugOnly>);
+
+  const auto len = 3;
+  u8 arr[len]{1, 2, 3}; // NOLINT
+  auto slice = Slice<u8, check::Unchecked>::from_unchecked(arr, len);
+
+  ASSERT_EQ(slice[2], 3);
+  ASSERT_EQ(std::ranges::data(slice), arr);
+  ASSERT_EQ(Option<u8>(4).unwrap<check::Unchecked>(), 4);
+}
+
+TEST(mem, TestVirtualBufferStable) {
+  auto buf = mem::VirtualBuffer<u64>::reserve(1 << 20).unwrap();
+  ASSERT_EQ(buf.max_size(), 1 << 20);
+  ASSERT_EQ(buf.capacity(), 0);
+
+  buf.push(0);
+  const auto *first = buf.data();
+  const auto view = buf.as_slice();
+  for (u64 i = 1; i < 300000; ++i) {
+    buf.push(i);
+  }
+  ASSERT_EQ(buf.data(), first);
+  ASSERT_EQ(view[0], 0);
+  ASSERT_EQ(buf[299999], 299999);
+  ASSERT_EQ(std::accumulate(buf.begin(), buf.end(), u64{0}),
+            u64{299999} * 300000 / 2);
+}
+
+TEST(mem, TestVirtualBufferShrink) {
+  auto buf = mem::VirtualBuffer<u32>::reserve(10000).unwrap();
+  ASSERT_TRUE(buf.commit(10000));
+  ASSERT_FALSE(buf.commit(10241));
+  ASSERT_EQ(buf.capacity(), 10240);
+
+  for (u32 i = 0; i < 10000; ++i) {
+    buf.push(i);
+  }
+  buf.truncate(10);
+  buf.shrink_to_fit();
+  ASSERT_EQ(buf.capacity(), mem::PAGE / sizeof(u32));
+  ASSERT_EQ(buf[9], 9);
+
+  // Decommitted pages come back zeroed.
+  ASSERT_TRUE(buf.commit(10000));
+  ASSERT_EQ(*buf.as_ptr(9999), 0);
+
+  auto moved = std::move(buf);
+  ASSERT_EQ(moved.size(), 10);
+  ASSERT_EQ(buf.data(), nullptr);
+  ASSERT_TRUE(mem::VirtualBuffer<u8>::reserve(0).is_none());
+  ASSERT_TRUE(mem::VirtualBuffer<u64>::reserve(usize{1} << 61).is_none());
+  ASSERT_FALSE(moved.commit(usize{1} << 62));
+
+  auto full = mem::VirtualBuffer<u8>::reserve(mem::PAGE).unwrap();
+  for (usize i = 0; i < mem::PAGE; ++i) {
+    full.push(1);
+  }
+  ASSERT_DEATH(full.push(1), "full at 4096 elements");
+}
+
+TEST(mem, TestHeapClasses) {
+  auto blocks = std::vector<std::pair<u8 *, usize>>();
+  for (usize size = 0; size <= 70000; size += 1 + size / 8) {
+    auto *ptr = static_cast<u8 *>(mem::Heap::alloc(size));
+    ASSERT_NE(ptr, nullptr);
+    ASSERT_EQ(reinterpret_cast<usize>(ptr) % 16, 0); // NOLINT
+    ASSERT_GE(mem::Heap::size_of(ptr), size);
+    std::memset(ptr, static_cast<int>(size), size);
+    blocks.emplace_back(ptr, size);
+  }
+  for (const auto &[ptr, size] : blocks) {
+    ASSERT_TRUE(std::all_of(ptr, ptr + size, [size](u8 byte) {
+      return byte == static_cast<u8>(size);
+    }));
+    mem::Heap::free(ptr, size);
+  }
+
+  // Freed blocks are handed out again by the same thread.
+  auto *first = mem::Heap::alloc(24);
+  mem::Heap::free(first);
+  ASSERT_EQ(mem::Heap::alloc(24), first);
+  mem::Heap::free(first);
+}
+
+TEST(mem, TestHeapAligned) {
+  for (const usize align : {32, 64, 256, 4096}) {
+    auto *ptr = mem::Heap::alloc(40, align);
+    ASSERT_EQ(reinterpret_cast<usize>(ptr) % align, 0); // NOLINT
+    mem::Heap::free(ptr, 40, align);
+  }
+
+  auto vec = std::vector<u64, mem::HeapAllocator<u64>>();
+  for (u64 i = 0; i < 100000; ++i) {
+    vec.push_back(i);
+  }
+  ASSERT_EQ(std::accumulate(vec.begin(), vec.end(), u64{0}),
+            u64{99999} * 100000 / 2);
+}
+
+TEST(mem, TestHeapCrossThread) {
+  static constexpr usize COUNT = 20000;
+  auto blocks = std::vector<void *>(COUNT);
+  auto producer = std::thread([&blocks] {
+    for (usize i = 0; i < COUNT; ++i) {
+      blocks[i] = mem::Heap::alloc(48);
+      std::memset(blocks[i], 0xab, 48);
+    }
+  });
+  producer.join();
+
+  // The producer has exited and flushed its cache; its blocks now move
+  // through this thread's cache and back to the depot.
+  for (auto *ptr : blocks) {
+    mem::Heap::free(ptr);
+  }
+  auto consumer = std::thread([] {
+    for (usize i = 0; i < COUNT; ++i) {
+      mem::Heap::free(mem::Heap::alloc(48));
+    }
+  });
+  consumer.join();
+}
+
+// A thread that only frees fills its cache without ever refilling it; the
+// cache must still go back to the depot when the thread exits.
+TEST(mem, TestHeapFreeOnlyThread) {
+  static constexpr usize SIZE = 1500;
+  auto blocks = std::vector<void *>(4);
+  for (auto &ptr : blocks) {
+    ptr = mem::Heap::alloc(SIZE);
+  }
+  std::thread([&blocks] {
+    for (auto *ptr : blocks) {
+      mem::Heap::free(ptr, SIZE);
+    }
+  }).join();
+
+  void *reused = nullptr;
+  std::thread([&reused] { reused = mem::Heap::alloc(SIZE); }).join();
+  ASSERT_NE(std::find(blocks.begin(), blocks.end(), reused), blocks.end());
+  mem::Heap::free(reused, SIZE);
+}
+
+static auto tag_stats(const mem::track::Snapshot &snap,
+                      const std::string_view name) -> mem::track::TagStats {
+  for (const auto &tag : snap.tags) {
+    if (tag.name == name) {
+      return tag;
+    }
+  }
+  return {};
+}
+
+TEST(mem, TestTrackingCounts) {
+  {
+    auto vec = std::vector<u64, mem::TrackingAllocator<"test-vec", u64>>();
+    vec.reserve(4);
+    vec.reserve(1000);
+    const auto stats = tag_stats(mem::track::snapshot(), "test-vec");
+    ASSERT_EQ(stats.live_bytes, 8000);
+    ASSERT_EQ(stats.peak_bytes, 8000);
+    ASSERT_EQ(stats.allocs, 2);
+    ASSERT_EQ(stats.frees, 1);
+    ASSERT_EQ(stats.sizes[mem::track::bucket_of(32)], 1);
+    ASSERT_EQ(stats.sizes[mem::track::bucket_of(8000)], 1);
+  }
+  const auto snap = mem::track::snapshot();
+  ASSERT_EQ(tag_stats(snap, "test-vec").live_bytes, 0);
+  ASSERT_NE(fmt::format("{}", snap).find("test-vec"), std::string::npos);
+}
+
+TEST(mem, TestTrackingThreads) {
+  using Alloc = mem::TrackingAllocator<"test-threads", u8>;
+  auto blocks = std::vector<u8 *>();
+  auto workers = std::vector<std::thread>();
+  auto lock = std::mutex();
+  for (usize i = 0; i < 4; ++i) {
+    workers.emplace_back([&] {
+      for (usize j = 0; j < 100; ++j) {
+        auto *block = Alloc().allocate(1024);
+        const auto guard = std::lock_guard(lock);
+        blocks.push_back(block);
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  // Counts of exited threads are kept, and frees on another thread net
+  // out against them.
+  ASSERT_EQ(tag_stats(mem::track::snapshot(), "test-threads").live_bytes,
+            400 * 1024);
+  for (auto *block : blocks) {
+    Alloc().deallocate(block, 1024);
+  }
+  const auto stats = tag_stats(mem::track::snapshot(), "test-threads");
+  ASSERT_EQ(stats.live_bytes, 0);
+  ASSERT_EQ(stats.allocs, 400);
+  ASSERT_EQ(stats.frees, 400);
+  ASSERT_GE(stats.peak_bytes, 400 * 1024 - 4 * mem::track::FLUSH);
+}
+
+static auto registered_threads() -> usize {
+  const auto guard = std::lock_guard(mem::impl::REGISTRY.lock);
+  usize count = 0;
+  for (auto *local = mem::impl::REGISTRY.threads; local != nullptr;
+       local = local->next) {
+    ++count;
+  }
+  return count;
+}
+
+TEST(mem, TestTrackingLateFree) {
+  using Alloc = mem::TrackingAllocator<"test-late", u8>;
+  // Built before the thread's first tracked allocation, so destroyed after
+  // its tracking guard.
+  struct LateFree {
+    u8 *block{};
+    ~LateFree() { Alloc().deallocate(block, 256); }
+  };
+  const auto before = registered_threads();
+  auto worker = std::thread([] {
+    static thread_local auto late = LateFree();
+    late.block = Alloc().allocate(256);
+  });
+  worker.join();
+
+  ASSERT_EQ(registered_threads(), before);
+  const auto stats = tag_stats(mem::track::snapshot(), "test-late");
+  ASSERT_EQ(stats.live_bytes, 0);
+  ASSERT_EQ(stats.allocs, 1);
+  ASSERT_EQ(stats.frees, 1);
+}
+
+TEST(mem, TestTrackingSamples) {
+  auto resource = mem::TrackingResource<"test-samples">();
+  mem::track::set_sample_rate(1);
+  auto *kept = resource.allocate(64);
+  for (usize i = 0; i < 10; ++i) {
+    resource.deallocate(resource.allocate(128), 128);
+  }
+  mem::track::set_sample_rate(0);
+
+  const auto snap = mem::track::snapshot();
+  ASSERT_FALSE(snap.stacks.empty());
+  auto live = u64{0};
+  auto total = u64{0};
+  for (const auto &stack : snap.stacks) {
+    ASSERT_FALSE(stack.frames.empty());
+    live += stack.live_bytes;
+    total += stack.total_objects;
+  }
+  // The first allocation of a thread only arms the sampler.
+  ASSERT_GE(total, 10);
+  ASSERT_LE(live, 64);
+
+  auto out = std::string();
+  mem::track::format_pprof(snap, std::back_inserter(out));
+  ASSERT_TRUE(out.starts_with("heap profile: "));
+  ASSERT_NE(out.find("\nMAPPED_LIBRARIES:\n"), std::string::npos);
+  resource.deallocate(kept, 64);
+}
+
+TEST(mem, TestTrackingFilterDrains) {
+  auto resource = mem::TrackingResource<"test-filter">();
+  mem::track::set_sample_rate(1);
+  auto *kept = resource.allocate(64);
+  auto blocks = std::vector<void *>(8192);
+  for (usize round = 0; round < 4; ++round) {
+    for (auto *&block : blocks) {
+      block = resource.allocate(32);
+    }
+    for (auto *block : blocks) {
+      resource.deallocate(block, 32);
+    }
+  }
+  mem::track::set_sample_rate(0);
+
+  // With `kept` sampled and live throughout, only the slots of live
+  // samples may stay set; the frees above must not have filled the rest.
+  {
+    const auto guard = std::lock_guard(mem::impl::PROFILE.lock);
+    const auto set = std::ranges::count_if(
+        mem::impl::PROFILE.filter, [](const auto &slot) {
+          return slot.load(std::memory_order_relaxed) != 0;
+        });
+    ASSERT_LE(static_cast<usize>(set), mem::impl::PROFILE.live.size());
+    ASSERT_LE(mem::impl::PROFILE.live.size(), 1);
+  }
+  resource.deallocate(kept, 64);
+}
+
+TEST(bytes, TestSliceShares) {
+  auto bytes = Bytes::copy_from("hello world");
+  ASSERT_EQ(bytes.use_count(), 1);
+
+  auto word = bytes.slice(6, 11).unwrap();
+  ASSERT_EQ(word.as_str(), "world");
+  ASSERT_EQ(word.as_ptr(), bytes.as_ptr(6));
+  ASSERT_EQ(bytes.use_count(), 2);
+
+  ASSERT_TRUE(bytes.slice(3, 12).is_none());
+  ASSERT_TRUE(bytes.slice(4, 4).is_none());
+  ASSERT_EQ(Bytes::from_static("static").use_count(), 0);
+}
+
+TEST(bytes, TestFreeze) {
+  auto buf = BytesMut::with_capacity(4);
+  buf.append("key").push('=').append("value");
+  const auto *data = buf.as_ptr();
+
+  auto bytes = buf.freeze();
+  ASSERT_TRUE(buf.is_empty());
+  ASSERT_EQ(bytes.as_ptr(), data);
+  ASSERT_EQ(fmt::format("{}", bytes), "key=value");
+}
+
+TEST(bytes, TestOutlivesOwner) {
+  auto queue = SpscQueue<Bytes, 4>{};
+  {
+    auto bytes = Bytes::copy_from("payload");
+    ASSERT_TRUE(queue.try_push(bytes.slice(0, 3).unwrap()).is_none());
+  }
+  auto thread = std::thread([&queue]() {
+    auto bytes = queue.try_pop().unwrap();
+    ASSERT_EQ(bytes.as_str(), "pay");
+    ASSERT_EQ(bytes.use_count(), 1);
+  });
+  thread.join();
+}
+
+template <usize Bits> static auto check_packed_round_trip() -> void {
+  const auto len = 1000;
+  u32 values[len]{}; // NOLINT
+  for (u32 i = 0; i < len; ++i) {
+    values[i] = (i * 2654435761U) & PackedArray<Bits>::MASK; // NOLINT
+  }
+
+  auto packed =
+      PackedArray<Bits>::pack(Slice<const u32>::from_unchecked(values, len));
+  ASSERT_EQ(packed.size(), len);
+  ASSERT_TRUE(packed.get(len).is_none());
+
+  u32 out[len]{}; // NOLINT
+  ASSERT_EQ(packed.unpack(Slice<u32>::from_unchecked(out, len), 3), len - 3);
+  for (usize i = 0; i < len - 3; ++i) {
+    ASSERT_EQ(out[i], values[i + 3]);
+  }
+  ASSERT_TRUE(std::ranges::equal(packed, std::span<u32>(values)));
+}
+
+TEST(packed, TestPackedArray) {
+  check_packed_round_trip<1>();
+  check_packed_round_trip<5>();
+  check_packed_round_trip<17>();
+  check_packed_round_trip<32>();
+
+  auto packed = PackedArray<3>();
+  packed.push(5);
+  packed.push(9);
+  packed.set(0, 2);
+  ASSERT_EQ(packed[0], 2);
+  ASSERT_EQ(packed[1], 1);
+}
+
+TEST(packed, TestDeltaSeq) {
+  const auto len = 300;
+  u32 ids[len]{}; // NOLINT
+  for (u32 i = 1; i < len; ++i) {
+    ids[i] = ids[i - 1] + (i % 7 == 0 ? 70000 : i % 3); // NOLINT
+    ids[i] += i % 11 == 0 ? 300 : 0;                    // NOLINT
+    ids[i] += i % 13 == 0 ? 1U << 25 : 0;               // NOLINT
+  }
+  ids[len - 1] = 5; // NOLINT
+
+  auto seq = DeltaSeq::encode(Slice<const u32>::from_unchecked(ids, len));
+  ASSERT_EQ(seq.size(), len);
+  ASSERT_LT(seq.bytes(), len * sizeof(u32));
+  ASSERT_EQ(seq.get(200).unwrap(), ids[200]);
+  ASSERT_TRUE(seq.get(len).is_none());
+
+  u32 out[len]{}; // NOLINT
+  ASSERT_EQ(seq.decode(Slice<u32>::from_unchecked(out, len)), len);
+  ASSERT_TRUE(std::ranges::equal(std::span<u32>(out), std::span<u32>(ids)));
+  ASSERT_TRUE(std::ranges::equal(seq, std::span<u32>(ids)));
+
+  // The portable kernel, which decode() skips on CPUs with SSSE3.
+  std::fill(out, out + len, 0);
+  const auto count = seq.block_len(0);
+  const auto *ctrl = seq.data.data();
+  impl::scalar::delta_decode(ctrl, ctrl + (count + 3) / 4, count,
+                             seq.blocks[0].base, out);
+  ASSERT_TRUE(std::equal(out, out + count, ids));
+}
+
+TEST(bitset, TestSetOps) {
+  auto lhs = BitSet(200);
+  auto rhs = BitSet(200);
+  for (usize i = 0; i < 200; i += 3) {
+    lhs.set(i);
+  }
+  for (usize i = 0; i < 200; i += 5) {
+    rhs.set(i);
+  }
+  ASSERT_FALSE(lhs.is_inline());
+  ASSERT_EQ(lhs.count(), 67);
+
+  auto both = lhs;
+  both &= rhs;
+  ASSERT_EQ(both.count(), 14);
+  ASSERT_EQ(both.find_next(1).unwrap(), 15);
+
+  auto either = lhs;
+  either |= rhs;
+  ASSERT_EQ(either.count(), 67 + 40 - 14);
+
+  auto only = std::move(lhs);
+  only.and_not(rhs);
+  ASSERT_EQ(only.count(), 67 - 14);
+  ASSERT_FALSE(only.test(15));
+
+  auto diff = only;
+  diff ^= only;
+  ASSERT_TRUE(diff.none());
+  ASSERT_TRUE(diff.find_first().is_none());
+
+  // Bit 200 is still inside the last word, but past the end of the set.
+  ASSERT_DEATH(diff.set(200), "size 200, at offset 200");
+  diff.set<check::Unchecked>(199);
+  ASSERT_TRUE(diff.test<check::Unchecked>(199));
+}
+
+TEST(bitset, TestIterAndResize) {
+  auto set = BitSet(70);
+  ASSERT_TRUE(set.is_inline());
+  set.set(0);
+  set.set(63);
+  set.set(69);
+  set.set_all();
+  set.resize(300);
+  set.set(299);
+  ASSERT_EQ(set.count(), 71);
+
+  set.resize(65);
+  usize expected = 0;
+  for (const auto bit : set) {
+    ASSERT_EQ(bit, expected++);
+  }
+  ASSERT_EQ(expected, 65);
+}
+
+TEST(bitset, TestRankSelect) {
+  auto set = BitSet(5000);
+  for (usize i = 0; i < 5000; i += i % 7 + 1) {
+    set.set(i);
+  }
+  auto index = RankIndex(set.as_slice());
+
+  usize rank = 0;
+  for (usize i = 0; i <= 5000; ++i) {
+    ASSERT_EQ(index.rank(i), rank);
+    if (i < 5000 && set.test(i)) {
+      ASSERT_EQ(index.select(rank).unwrap(), i);
+      ++rank;
+    }
+  }
+  ASSERT_TRUE(index.select(rank).is_none());
+}
+
+static auto for_each_isa(const FnRef<void(void)> fn) -> void {
+  for (const auto isa : {text::Isa::Scalar, text::Isa::Avx2}) {
+    text::set_isa(isa);
+    fn();
+  }
+  text::set_isa(text::impl::detect_isa());
+}
+
+TEST(text, TestValidate) {
+  const auto valid = std::string(
+      "plain ascii that runs past one block, "
+      "Grüße, Καλημέρα, こんにちは, 😀 and back to ascii at the end");
+
+  for_each_isa([&valid]() {
+    ASSERT_EQ(text::validate(text::as_bytes(valid)).unwrap(), valid.size());
+
+    for (const auto *bad : {"\xc0\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80",
+                            "\x80", "\xe2\x82", "\xff"}) {
+      for (const usize at : {0UL, 5UL, 31UL, 33UL, valid.size()}) {
+        auto input = valid;
+        input.insert(at, bad);
+        auto res = text::validate(text::as_bytes(input));
+        ASSERT_EQ(res.err().unwrap().offset, at);
+      }
+    }
+  });
+}
+
+TEST(text, TestValidateMatchesScalar) {
+  auto input = std::string();
+  for (auto i = 0; i < 40; ++i) { // NOLINT
+    input += "ascii Ωμέγα 漢字 🎉 ";
+  }
+
+  auto seed = u32{12345}; // NOLINT
+  for (auto round = 0; round < 500; ++round) { // NOLINT
+    auto mutated = input;
+    seed = seed * 1103515245 + 12345; // NOLINT
+    mutated[seed % mutated.size()] = static_cast<char>(seed >> 24);
+
+    text::set_isa(text::Isa::Scalar);
+    const auto expected = text::validate(text::as_bytes(mutated));
+    text::set_isa(text::Isa::Avx2);
+    const auto actual = text::validate(text::as_bytes(mutated));
+    ASSERT_EQ(fmt::format("{}", actual), fmt::format("{}", expected));
+  }
+  text::set_isa(text::impl::detect_isa());
+}
+
+TEST(text, TestDecode) {
+  const auto input = std::string("a long enough ascii prefix ü€😀");
+  for_each_isa([&input]() {
+    u32 out[64]{}; // NOLINT
+    auto len = text::decode(text::as_bytes(input),
+                            Slice<u32>::from_unchecked(out, 64))
+                   .unwrap();
+    ASSERT_EQ(len, 30);
+    ASSERT_EQ(out[0], 'a');
+    ASSERT_EQ(out[27], 0xfc);
+    ASSERT_EQ(out[28], 0x20ac);
+    ASSERT_EQ(out[29], 0x1f600);
+  });
+}
+
+TEST(text, TestScan) {
+  const auto input = std::string(
+      "   \t\n  identifier_with_digits_0123456789 + \"body\xc3\xa9\"");
+  const auto bytes = text::as_bytes(input);
+  for_each_isa([&bytes]() {
+    const auto start = text::skip_while(bytes, text::SPACE);
+    ASSERT_EQ(start, 7);
+    const auto end = text::skip_while(bytes, text::IDENT, start);
+    ASSERT_EQ(end, 40);
+    ASSERT_EQ(text::find_first_of(bytes, text::CharClass::of("\"")).unwrap(),
+              43);
+    ASSERT_EQ(text::find_first_of(bytes, text::NON_ASCII).unwrap(), 48);
+    ASSERT_TRUE(text::find_first_of(bytes, text::CharClass::of("#")).is_none());
+    ASSERT_EQ(text::skip_while(bytes, ~text::CharClass::of("+")), 41);
+  });
+}
+
+template <typename T>
+static auto parse_str(const std::string_view str)
+    -> Result<std::pair<T, usize>, ParseError> {
+  return parse<T>(text::as_bytes(str));
+}
+
+TEST(parse, TestIntegers) {
+  ASSERT_EQ(parse_str<u64>("18446744073709551615").unwrap().first,
+            std::numeric_limits<u64>::max());
+  ASSERT_EQ(parse_str<s64>("-9223372036854775808").unwrap().first,
+            std::numeric_limits<s64>::min());
+  ASSERT_EQ(parse_str<u32>("00000000000000000000042").unwrap().first, 42);
+  ASSERT_EQ(parse_str<s16>("-1234)").unwrap(),
+            (std::pair<s16, usize>(-1234, 5)));
+  ASSERT_EQ(parse_str<u8>("255").unwrap().first, 255);
+
+  ASSERT_EQ(parse_str<u8>("256").err().unwrap().kind,
+            ParseError::Kind::OutOfRange);
+  ASSERT_EQ(parse_str<u64>("18446744073709551616").err().unwrap().kind,
+            ParseError::Kind::OutOfRange);
+  ASSERT_EQ(parse_str<u32>("-1").err().unwrap().kind,
+            ParseError::Kind::NoDigits);
+  ASSERT_EQ(fmt::format("{}", parse_str<s32>("x").err().unwrap()),
+            "Expected a number at offset 0");
+  ASSERT_EQ(parse_str<s32>("-x").err().unwrap().offset, 1);
+  ASSERT_EQ(parse_str<u8>("1000,").err().unwrap().offset, 4);
+}
+
+TEST(parse, TestFloats) {
+  for (const auto *str :
+       {"0", "-0.0", "1.5", "3.141592653589793", "2.2250738585072014e-308",
+        "1.7976931348623157e308", "4.9e-324", "123456789012345678901234",
+        "0.1e1", "9007199254740993", "7.0e22", ".5", "2.5E+3",
+        "0.30000000000000004", "-8.988465674311579e-17"}) {
+    const auto expected = std::strtod(str, nullptr);
+    const auto res = parse_str<d64>(str);
+    ASSERT_EQ(res.unwrap().first, expected) << str;
+    ASSERT_EQ(res.unwrap().second, std::strlen(str)) << str;
+  }
+  ASSERT_EQ(parse_str<d32>("16777217").unwrap().first, 16777216.0F);
+  ASSERT_EQ(parse_str<d128>("0.25").unwrap().first, 0.25L);
+  ASSERT_EQ(parse_str<d64>("12.5e+").unwrap().second, 4);
+  ASSERT_EQ(parse_str<d64>("1e400").err().unwrap().kind,
+            ParseError::Kind::OutOfRange);
+  ASSERT_EQ(parse_str<d64>("1e-400").err().unwrap().kind,
+            ParseError::Kind::OutOfRange);
+  ASSERT_EQ(parse_str<d64>("1e400 ").err().unwrap().offset, 5);
+  ASSERT_EQ(parse_str<d64>("-.").err().unwrap().offset, 1);
+}
+
+TEST(parse, TestRoundTrip) {
+  u8 buf[32]{}; // NOLINT
+  const auto out = Slice<u8>::from_unchecked(buf, 32);
+  for (const auto val : {0.1, 1.0 / 3.0, 6.02214076e23, 5e-324}) {
+    const auto len = write_num(out, val).unwrap();
+    ASSERT_EQ(parse<d64>(out.slice(0, len).unwrap()).unwrap().first, val);
+  }
+  ASSERT_EQ(write_num(out, s64{-42}).unwrap(), 3);
+  ASSERT_TRUE(write_num(Slice<u8>::from_unchecked(buf, 2), 1234).is_none());
+}
+
+struct EpochNode {
+  static inline std::atomic<usize> freed{}; // NOLINT
+
+  u64 value;
+
+  explicit EpochNode(const u64 _value) : value{_value} {}
+  EpochNode(const EpochNode &) = delete;
+  auto operator=(const EpochNode &) -> EpochNode & = delete;
+
+  ~EpochNode() {
+    value = 0;
+    freed.fetch_add(1, std::memory_order_relaxed);
+  }
+};
+
+TEST(sync, TestEpochDefersWhilePinned) {
+  EpochNode::freed = 0;
+  auto domain = sync::Epoch();
+  auto pinned = std::atomic<bool>(false);
+  auto release = std::atomic<bool>(false);
+  auto reader = std::thread([&] {
+    const auto guard = domain.pin();
+    pinned = true;
+    while (!release) {
+      std::this_thread::yield();
+    }
+  });
+  while (!pinned) {
+    std::this_thread::yield();
+  }
+
+  domain.retire(new EpochNode(1));
+  for (usize i = 0; i < 4 * sync::Epoch::PINS_PER_COLLECT; ++i) {
+    const auto guard = domain.pin();
+  }
+  ASSERT_EQ(domain.flush(), 1);
+  ASSERT_EQ(EpochNode::freed, 0);
+
+  release = true;
+  reader.join();
+  for (usize round = 0; round < 3; ++round) {
+    domain.flush();
+  }
+  ASSERT_EQ(domain.flush(), 0);
+  ASSERT_EQ(EpochNode::freed, 1);
+}
+
+TEST(sync, TestEpochNestedPins) {
+  EpochNode::freed = 0;
+  auto domain = sync::Epoch();
+  {
+    const auto outer = domain.pin();
+    {
+      const auto inner = domain.pin();
+    }
+    domain.retire(new EpochNode(1));
+    domain.flush();
+    domain.flush();
+    ASSERT_EQ(EpochNode::freed, 0);
+  }
+  domain.flush();
+  domain.flush();
+  ASSERT_EQ(domain.flush(), 0);
+  ASSERT_EQ(EpochNode::freed, 1);
+}
+
+TEST(sync, TestEpochChurn) {
+  static constexpr usize SLOTS = 16;
+  static constexpr usize WRITES = 20000;
+  EpochNode::freed = 0;
+  usize retired = 0;
+  {
+    auto domain = sync::Epoch();
+    auto slots = std::array<std::atomic<EpochNode *>, SLOTS>{};
+    for (usize i = 0; i < SLOTS; ++i) {
+      slots[i] = new EpochNode(i + 1);
+    }
+    auto done = std::atomic<bool>(false);
+    auto readers = std::vector<std::thread>();
+    for (usize t = 0; t < 3; ++t) {
+      readers.emplace_back([&, t] {
+        usize at = t;
+        while (!done.load(std::memory_order_relaxed)) {
+          const auto guard = domain.pin();
+          const auto *node =
+              slots[at++ % SLOTS].load(std::memory_order_acquire);
+          ASSERT_NE(node->value, 0);
+        }
+      });
+    }
+    auto writers = std::vector<std::thread>();
+    auto retires = std::atomic<usize>(0);
+    for (usize t = 0; t < 2; ++t) {
+      writers.emplace_back([&, t] {
+        for (usize i = 0; i < WRITES; ++i) {
+          auto *fresh = new EpochNode(i + 1);
+          auto *old = slots[(i + t) % SLOTS].exchange(
+              fresh, std::memory_order_acq_rel);
+          domain.retire(old);
+        }
+        retires.fetch_add(WRITES);
+      });
+    }
+    for (auto &writer : writers) {
+      writer.join();
+    }
+    done = true;
+    for (auto &reader : readers) {
+      reader.join();
+    }
+    retired = retires;
+    // Exited writers left their limbo lists with the domain; advancing
+    // frees them.
+    for (usize round = 0; round < 3; ++round) {
+      domain.flush();
+    }
+    ASSERT_EQ(EpochNode::freed, retired);
+    for (auto &slot : slots) {
+      delete slot.load(); // NOLINT
+    }
+  }
+  ASSERT_EQ(EpochNode::freed, retired + SLOTS);
+}
+
+TEST(concurrent, TestMapBasics) {
+  auto map = ConcurrentMap<u64, u64, std::hash<u64>, 4>();
+  ASSERT_TRUE(map.is_empty());
+  ASSERT_TRUE(map.get(7).is_none());
+  for (u64 i = 0; i < 1000; ++i) {
+    ASSERT_TRUE(map.upsert(i, i * 2));
+  }
+  ASSERT_FALSE(map.upsert(7, 70));
+  ASSERT_EQ(map.size(), 1000);
+  ASSERT_EQ(map.get(7).unwrap(), 70);
+  ASSERT_EQ(map.get(999).unwrap(), 1998);
+  ASSERT_TRUE(map.get(1000).is_none());
+
+  usize calls = 0;
+  const auto make = [&calls] {
+    ++calls;
+    return u64{5};
+  };
+  ASSERT_EQ(map.compute_if_absent(7, make), 70);
+  ASSERT_EQ(map.compute_if_absent(5000, make), 5);
+  ASSERT_EQ(map.compute_if_absent(5000, make), 5);
+  ASSERT_EQ(calls, 1);
+  ASSERT_EQ(map.size(), 1001);
+}
+
+TEST(concurrent, TestMapStridedKeys) {
+  // Keys differing only in their high bits still spread over the slots.
+  auto map = ConcurrentMap<u64, u64, std::hash<u64>, 4>();
+  for (u64 i = 0; i < 4096; ++i) {
+    ASSERT_TRUE(map.upsert(i << 32, i));
+  }
+  ASSERT_EQ(map.get(u64{77} << 32).unwrap(), 77);
+
+  usize longest = 0;
+  for (const auto &shard : map.shards) {
+    const auto *table = shard.table.load();
+    for (usize i = 0; i < table->capacity(); ++i) {
+      const auto tag = table->tags[i].load();
+      if (tag != 0) {
+        longest = std::max(longest, (i - table->home(tag)) & table->mask);
+      }
+    }
+  }
+  ASSERT_LT(longest, 64);
+}
+
+TEST(concurrent, TestMapThreads) {
+  static constexpr u64 KEYS = 20000;
+  struct Pair {
+    u64 lo;
+    u64 hi;
+  };
+  auto map = ConcurrentMap<u64, Pair, std::hash<u64>, 8>();
+  auto made = std::atomic<usize>(0);
+  auto threads = std::vector<std::thread>();
+  for (u64 t = 0; t < 4; ++t) {
+    threads.emplace_back([&map, &made, t] {
+      for (u64 i = 0; i < KEYS; ++i) {
+        const auto key = (i * 7 + t) % KEYS;
+        if (t % 2 == 0) {
+          // Both halves always match, so a torn read would show.
+          map.upsert(key, {key + t, key + t});
+        } else {
+          map.compute_if_absent(key, [&made, key] {
+            made.fetch_add(1);
+            return Pair{key, key};
+          });
+        }
+        const auto seen = map.get((key * 13) % KEYS);
+        if (seen.is_some()) {
+          ASSERT_EQ(seen.unwrap().lo, seen.unwrap().hi);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(map.size(), KEYS);
+  ASSERT_LE(made, 2 * KEYS);
+  for (u64 key = 0; key < KEYS; ++key) {
+    const auto pair = map.get(key).unwrap();
+    ASSERT_EQ(pair.lo, pair.hi);
+  }
+}
+
+TEST(sort, TestNetworks) {
+  // 0-1 principle: a network sorts everything if it sorts every bit mask.
+  const auto check = [&]<usize N>(std::integral_constant<usize, N>) {
+    for (u32 mask = 0; mask < (1U << N); ++mask) {
+      auto bits = std::array<u8, N>{};
+      for (usize i = 0; i < N; ++i) {
+        bits[i] = static_cast<u8>((mask >> i) & 1);
+      }
+      auto less = std::ranges::less();
+      sort::impl::network_sort<N>(bits.data(), less);
+      ASSERT_TRUE(std::is_sorted(bits.begin(), bits.end())) << N;
+    }
+  };
+  [&]<usize... N>(std::index_sequence<N...>) {
+    (check(std::integral_constant<usize, N>{}), ...);
+  }(std::make_index_sequence<sort::impl::NETWORK_MAX + 1>{});
+}
+
+static auto sort_inputs(const usize len) -> std::vector<std::vector<s64>> {
+  auto rng = std::mt19937_64(len);
+  auto random = std::vector<s64>(len);
+  auto few = std::vector<s64>(len);
+  for (usize i = 0; i < len; ++i) {
+    random[i] = static_cast<s64>(rng());
+    few[i] = static_cast<s64>(rng() % 4) - 2;
+  }
+  auto ascending = random;
+  std::sort(ascending.begin(), ascending.end());
+  auto descending = ascending;
+  std::reverse(descending.begin(), descending.end());
+  auto organ = ascending;
+  std::reverse(organ.begin() + static_cast<ssize>(len / 2), organ.end());
+  return {random, few, ascending, descending, organ};
+}
+
+TEST(sort, TestPdq) {
+  for (const usize len : {0, 1, 5, 16, 23, 100, 1000, 50000}) {
+    for (auto input : sort_inputs(len)) {
+      auto expected = input;
+      std::sort(expected.begin(), expected.end());
+      sort::pdq(Slice(input.data(), input.size()));
+      ASSERT_EQ(input, expected) << len;
+    }
+  }
+
+  struct Row {
+    std::string name;
+    u32 id;
+  };
+  auto rows = std::vector<Row>();
+  for (u32 i = 0; i < 300; ++i) {
+    rows.push_back({std::to_string(i), (i * 7919) % 300});
+  }
+  sort::pdq(Slice(rows.data(), rows.size()), std::ranges::greater(), &Row::id);
+  for (u32 i = 0; i < 300; ++i) {
+    ASSERT_EQ(rows[i].id, 299 - i);
+    ASSERT_EQ(std::stoul(rows[i].name) * 7919 % 300, rows[i].id);
+  }
+}
+
+TEST(sort, TestRadix) {
+  for (const usize len : {0, 3, 255, 256, 5000, 100000}) {
+    for (auto input : sort_inputs(len)) {
+      auto expected = input;
+      std::sort(expected.begin(), expected.end());
+      auto in_place = input;
+      sort::radix(Slice(input.data(), input.size()));
+      sort::radix_in_place(Slice(in_place.data(), in_place.size()));
+      ASSERT_EQ(input, expected) << len;
+      ASSERT_EQ(in_place, expected) << len;
+    }
+  }
+
+  auto floats = std::vector<d64>{3.5, -0.5, 1e300, -1e300, 0.0, 2.25, -7.0};
+  for (usize i = 0; i < 1000; ++i) {
+    floats.push_back(static_cast<d64>(i % 97) * (i % 2 == 0 ? -1.5 : 0.25));
+  }
+  auto expected = floats;
+  std::sort(expected.begin(), expected.end());
+  sort::radix(Slice(floats.data(), floats.size()));
+  ASSERT_EQ(floats, expected);
+
+  // Stable, through a projection into the record.
+  struct Rec {
+    s32 key;
+    u32 order;
+  };
+  // Below RADIX_MIN too, where the slice is not radix sorted.
+  for (const u32 len : {30, 100, 200, 255, 1000}) {
+    auto recs = std::vector<Rec>();
+    for (u32 i = 0; i < len; ++i) {
+      recs.push_back({static_cast<s32>((i * 7) % 3) - 1, i});
+    }
+    sort::radix(Slice(recs.data(), recs.size()), &Rec::key);
+    for (usize i = 1; i < recs.size(); ++i) {
+      ASSERT_LE(recs[i - 1].key, recs[i].key) << len;
+      if (recs[i - 1].key == recs[i].key) {
+        ASSERT_LT(recs[i - 1].order, recs[i].order) << len;
+      }
+    }
+  }
+
+  // Small and large slices order NaNs and signed zeros alike.
+  const auto nan = std::numeric_limits<d64>::quiet_NaN();
+  for (const usize len : {6, 600}) {
+    auto special = std::vector<d64>();
+    for (usize i = 0; i < len; ++i) {
+      const d64 values[] = {0.0, nan, -0.0, 1.0, -nan, -1.0}; // NOLINT
+      special.push_back(values[i % 6]);
+    }
+    sort::radix(Slice(special.data(), special.size()));
+    ASSERT_TRUE(std::ranges::is_sorted(special, {}, [](const d64 val) {
+      return sort::impl::radix_key(val);
+    })) << len;
+    ASSERT_TRUE(std::signbit(special[len / 6 * 2]));
+    ASSERT_FALSE(std::signbit(special[len / 6 * 3]));
+  }
+}
+
+TEST(sort, TestParallel) {
+  auto pool = ThreadPool(4);
+  for (const usize len : {1000, 200000}) {
+    for (auto input : sort_inputs(len)) {
+      auto expected = input;
+      std::sort(expected.begin(), expected.end());
+      sort::parallel(pool, Slice(input.data(), input.size()));
+      ASSERT_EQ(input, expected) << len;
+    }
+  }
+  auto hits = std::vector<usize>(100);
+  pool.run(hits.size(), [&hits](const usize i) { hits[i] += i; });
+  for (usize i = 0; i < hits.size(); ++i) {
+    ASSERT_EQ(hits[i], i);
+  }
+}
+
+struct Counted {
+  static inline s64 live = 0; // NOLINT
+
+  u64 value;
+
+  explicit Counted(const u64 _value) : value{_value} { ++live; }
+  Counted(const Counted &other) : value{other.value} { ++live; }
+  Counted(Counted &&other) noexcept : value{other.value} { ++live; }
+  auto operator=(const Counted &) -> Counted & = default;
+  auto operator=(Counted &&) noexcept -> Counted & = default;
+  ~Counted() { --live; }
+};
+
+// Puts every key in one of four buckets so that full collisions happen.
+struct CollidingHash {
+  auto operator()(const u64 key) const -> usize { return key % 4; }
+};
+
+TEST(persistent, TestVersions) {
+  Counted::live = 0;
+  {
+    auto empty = PersistentMap<std::string, Counted>();
+    auto one = empty.set("a", Counted(1));
+    auto two = one.set("b", Counted(2));
+    auto three = two.set("a", Counted(3)).erase("b");
+    ASSERT_TRUE(empty.is_empty());
+    ASSERT_TRUE(empty.get("a").is_none());
+    ASSERT_EQ(one.get("a").unwrap().value, 1);
+    ASSERT_FALSE(one.contains("b"));
+    ASSERT_EQ(two.size(), 2);
+    ASSERT_EQ(two.get("a").unwrap().value, 1);
+    ASSERT_EQ(two.get("b").unwrap().value, 2);
+    ASSERT_EQ(three.size(), 1);
+    ASSERT_EQ(three.get("a").unwrap().value, 3);
+    ASSERT_TRUE(three.get("b").is_none());
+    ASSERT_EQ(three.erase("zzz").size(), 1);
+  }
+  ASSERT_EQ(Counted::live, 0);
+}
+
+template <typename Hash> static auto check_against_std() -> void {
+  Counted::live = 0;
+  {
+    auto rng = std::mt19937_64(7);
+    auto model = std::unordered_map<u64, u64>();
+    auto map = PersistentMap<u64, Counted, Hash>();
+    using Snapshot = std::pair<PersistentMap<u64, Counted, Hash>,
+                               std::unordered_map<u64, u64>>;
+    auto snapshots = std::vector<Snapshot>();
+    for (usize step = 0; step < 20000; ++step) {
+      const auto key = rng() % 3000;
+      if (rng() % 3 == 0) {
+        map = map.erase(key);
+        model.erase(key);
+      } else {
+        map = map.set(key, Counted(step));
+        model[key] = step;
+      }
+      if (step % 2000 == 0) {
+        snapshots.emplace_back(map, model);
+      }
+    }
+    snapshots.emplace_back(map, model);
+
+    auto transient = map.transient();
+    for (u64 key = 0; key < 3000; key += 2) {
+      transient.erase(key);
+      model.erase(key);
+    }
+    for (u64 key = 3000; key < 5000; ++key) {
+      ASSERT_TRUE(transient.set(key, Counted(key)));
+      model[key] = key;
+    }
+    snapshots.emplace_back(std::move(transient).persistent(), model);
+
+    for (const auto &[version, expected] : snapshots) {
+      ASSERT_EQ(version.size(), expected.size());
+      usize seen = 0;
+      version.for_each([&](const u64 key, const Counted &val) {
+        ASSERT_EQ(expected.at(key), val.value);
+        ++seen;
+      });
+      ASSERT_EQ(seen, expected.size());
+      for (u64 key = 0; key < 5000; ++key) {
+        ASSERT_EQ(version.contains(key), expected.contains(key));
+      }
+    }
+  }
+  ASSERT_EQ(Counted::live, 0);
+}
+
+TEST(persistent, TestAgainstStd) { check_against_std<std::hash<u64>>(); }
+
+TEST(persistent, TestCollisions) { check_against_std<CollidingHash>(); }
+
+static auto naive_line_start(const std::string &text, const usize line)
+    -> Option<usize> {
+  usize seen = 0;
+  for (usize i = 0; i < text.size() && seen < line; ++i) {
+    if (text[i] == '\n' && ++seen == line) {
+      return {i + 1};
+    }
+  }
+  return line == 0 ? Option<usize>(usize{0}) : Option<usize>();
+}
+
+TEST(rope, TestAgainstString) {
+  auto rng = std::mt19937_64(11);
+  auto model = std::string();
+  for (usize i = 0; i < 20000; ++i) {
+    model.push_back(i % 61 == 0 ? '\n' : static_cast<char>('a' + i % 26));
+  }
+  auto rope = Rope(model);
+  const auto first = rope;
+  const auto first_text = model;
+  for (usize step = 0; step < 2000; ++step) {
+    const auto start = rng() % (model.size() + 1);
+    const auto end = std::min(model.size(), start + rng() % 1000);
+    const auto text = std::string(rng() % 4 == 0 ? rng() % 5000 : rng() % 4,
+                                  step % 7 == 0 ? '\n' : 'x');
+    const auto delta = rope.replace(start, end, text);
+    model.replace(start, end - start, text);
+    ASSERT_EQ(delta.new_end, start + text.size());
+    ASSERT_EQ(rope.size(), model.size());
+    ASSERT_LE(rope.height(), 8);
+  }
+  ASSERT_EQ(rope.to_string(), model);
+  ASSERT_EQ(first.to_string(), first_text);
+
+  const auto lines = static_cast<usize>(
+      std::count(model.begin(), model.end(), '\n') + 1);
+  ASSERT_EQ(rope.lines(), lines);
+  for (usize line = 0; line <= lines; line += lines / 200 + 1) {
+    ASSERT_EQ(rope.line_start(line), naive_line_start(model, line));
+  }
+  for (usize at = 0; at < model.size(); at += model.size() / 200 + 1) {
+    ASSERT_EQ(rope.line_of(at), static_cast<usize>(std::count(
+                                    model.begin(), model.begin() + at, '\n')));
+  }
+  const auto mid = model.size() / 2;
+  const auto part = rope.slice(mid / 3, mid);
+  ASSERT_EQ(part.to_string(), model.substr(mid / 3, mid - mid / 3));
+  auto clipped = std::string();
+  for (const auto chunk : rope.chunks(mid / 2, mid + 5000)) {
+    clipped.append(ptr::cast<char>(chunk.data()), chunk.size());
+  }
+  ASSERT_EQ(clipped, model.substr(mid / 2, mid + 5000 - mid / 2));
+}
+
+TEST(rope, TestChars) {
+  auto text = std::string();
+  for (usize i = 0; i < 3000; ++i) {
+    text += i % 3 == 0 ? "a" : (i % 3 == 1 ? "\xc3\xa9" : "\xe2\x82\xac");
+  }
+  const auto rope = Rope(text);
+  ASSERT_EQ(rope.chars(), 3000);
+  for (usize i = 0; i < 3000; i += 31) {
+    const auto offset = rope.char_to_offset(i).unwrap();
+    ASSERT_EQ(offset, (i / 3) * 6 + (i % 3 == 0 ? 0 : (i % 3 == 1 ? 1 : 3)));
+    ASSERT_EQ(rope.offset_to_char(offset), i);
+  }
+  ASSERT_EQ(rope.char_to_offset(3000).unwrap(), rope.size());
+  ASSERT_TRUE(rope.char_to_offset(3001).is_none());
+}
+
+TEST(rope, TestDelta) {
+  auto rope = Rope("let a = 1;\nlet b = 2;\nlet c = 3;\n");
+  const auto delta = rope.replace(15, 16, "bb");
+  ASSERT_EQ(delta.map(4), 4);
+  ASSERT_EQ(delta.map(15), 17);
+  ASSERT_EQ(delta.map(22), 23);
+  ASSERT_EQ(rope.to_string(), "let a = 1;\nlet bb = 2;\nlet c = 3;\n");
+  const auto [start, end] = rope.relex_range(delta);
+  ASSERT_EQ(start, 11);
+  ASSERT_EQ(end, 23);
+  const auto joined = rope.erase(21, 23);
+  ASSERT_EQ(rope.relex_range(joined), std::make_pair(usize{11}, usize{32}));
+  usize seen = 0;
+  for (const auto chunk : generate(rope.chunks(4, 30))) {
+    seen += chunk.size();
+  }
+  ASSERT_EQ(seen, 26);
+  ASSERT_TRUE(Rope().chunks().begin() == std::default_sentinel);
+}
+
+struct FileKey {
+  u32 crate;
+  u32 file;
+};
+
+struct Missing {
+  u32 file;
+
+  auto operator==(const Missing &) const -> bool = default;
+};
+
+// Equal by id alone, so it brings a matching std::hash.
+struct CachedId {
+  u32 id;
+  u32 cache;
+
+  auto operator==(const CachedId &rhs) const -> bool { return id == rhs.id; }
+};
+
+template <> struct std::hash<CachedId> {
+  auto operator()(const CachedId &key) const -> usize { return key.id; }
+};
+
+struct SpanKey {
+  u32 file;
+  u32 span[2]; // NOLINT
+};
+
+struct NestedKey {
+  FileKey file;
+  u32 line;
+};
+
+TEST(reflection, TestHashMembers) {
+  const auto lhs = FileKey{1, 2};
+  ASSERT_EQ(reflection::hash_members(lhs), reflection::hash_members(lhs));
+  ASSERT_TRUE(reflection::equal_members(lhs, FileKey{1, 2}));
+  ASSERT_NE(reflection::hash_members(lhs),
+            reflection::hash_members(FileKey{2, 1}));
+  ASSERT_FALSE(reflection::equal_members(lhs, FileKey{1, 3}));
+  ASSERT_EQ(reflection::hash_members(u64{7}), std::hash<u64>{}(7));
+
+  // The type's own equality and hash win over its fields.
+  ASSERT_TRUE(reflection::equal_members(CachedId{1, 2}, CachedId{1, 3}));
+  ASSERT_EQ(reflection::hash_members(CachedId{1, 2}),
+            reflection::hash_members(CachedId{1, 3}));
+
+  const auto span = SpanKey{1, {4, 9}};
+  ASSERT_TRUE(reflection::equal_members(span, SpanKey{1, {4, 9}}));
+  ASSERT_FALSE(reflection::equal_members(span, SpanKey{1, {4, 8}}));
+  ASSERT_EQ(reflection::hash_members(span),
+            reflection::hash_members(SpanKey{1, {4, 9}}));
+  ASSERT_NE(reflection::hash_members(span),
+            reflection::hash_members(SpanKey{1, {9, 4}}));
+  ASSERT_EQ(reflection::hash_members(std::array<u32, 2>{4, 9}),
+            reflection::hash_members(std::array<u32, 2>{4, 9}));
+
+  // Members that are aggregates themselves need the key's own == and hash.
+  static_assert(!reflection::FlatAggregate<NestedKey>);
+}
+
+TEST(query, TestRedGreen) {
+  auto db = query::Database();
+  auto source = query::Input<FileKey, std::string>(db);
+  auto length = query::derived<FileKey, usize, Missing>(
+      db, [&](auto &, const FileKey &key) -> Result<usize, Missing> {
+        const auto text = source.get(key);
+        if (text.is_none()) {
+          return {Missing{key.file}};
+        }
+        return {text.unwrap().size()};
+      });
+  auto total = query::derived<u32, usize, Missing>(
+      db, [&](auto &, const u32 &files) -> Result<usize, Missing> {
+        usize sum = 0;
+        for (u32 file = 0; file < files; ++file) {
+          const auto &len = length.get({0, file});
+          if (len.is_err()) {
+            return len.err().unwrap();
+          }
+          sum += len.unwrap();
+        }
+        return {sum};
+      });
+
+  source.set({0, 0}, "ab");
+  source.set({0, 1}, "cde");
+  ASSERT_EQ(total.get(3).err().unwrap(), Missing{2});
+  ASSERT_EQ(total.get(3).err().unwrap(), Missing{2});
+  ASSERT_EQ(length.executions, 3);
+  ASSERT_EQ(total.executions, 1);
+
+  source.set({0, 2}, "f");
+  ASSERT_EQ(total.get(3).unwrap(), 6);
+  ASSERT_EQ(length.executions, 4);
+  ASSERT_EQ(total.executions, 2);
+
+  // Same length: the file is recomputed, the total stays green.
+  source.set({0, 1}, "xyz");
+  ASSERT_EQ(total.get(3).unwrap(), 6);
+  ASSERT_EQ(length.executions, 5);
+  ASSERT_EQ(total.executions, 2);
+
+  // Equal inputs do not start a revision.
+  const auto revision = db.current();
+  source.set({0, 1}, "xyz");
+  ASSERT_EQ(db.current(), revision);
+}
+
+TEST(query, TestRecursive) {
+  auto db = query::Database();
+  auto weight = query::Input<u64, u64>(db);
+  // Path weight to node n through a chain n -> n - 1 -> ... -> 0.
+  auto path = query::derived<u64, u64, Missing>(
+      db, [&](auto &self, const u64 &node) -> Result<u64, Missing> {
+        const auto own = weight.get(node).unwrap_or(0);
+        return {node == 0 ? own : own + self.get(node - 1).unwrap()};
+      });
+  for (u64 node = 0; node < 100; ++node) {
+    weight.set(node, 1);
+  }
+  ASSERT_EQ(path.get(99).unwrap(), 100);
+  ASSERT_EQ(path.executions, 100);
+  weight.set(90, 5);
+  ASSERT_EQ(path.get(99).unwrap(), 104);
+  ASSERT_EQ(path.executions, 110);
+  ASSERT_EQ(path.get(10).unwrap(), 11);
+  ASSERT_EQ(path.executions, 110);
+}
+
+struct ConsExpr;
+
+struct ConsLit {
+  s64 value;
+};
+
+struct ConsAdd {
+  Interned<ConsExpr> lhs;
+  Interned<ConsExpr> rhs;
+};
+
+struct ConsMul {
+  Interned<ConsExpr> lhs;
+  Interned<ConsExpr> rhs;
+};
+
+struct ConsExpr {
+  Union<ConsLit, ConsAdd, ConsMul> _data;
+};
+
+TEST(hashcons, TestSharing) {
+  auto table = HashCons<ConsExpr>();
+  const auto build = [&table] {
+    const auto sum = table.make(ConsAdd{table.make(ConsLit{1}),
+                                        table.make(ConsLit{2})});
+    return table.make(ConsMul{sum, sum});
+  };
+  const auto lhs = build();
+  const auto rhs = build();
+  ASSERT_TRUE(lhs == rhs);
+  ASSERT_EQ(lhs.id(), rhs.id());
+  ASSERT_EQ(table.size(), 4);
+  ASSERT_FALSE(lhs == table.make(ConsAdd{table.make(ConsLit{2}),
+                                         table.make(ConsLit{1})}));
+
+  auto walked = 0;
+  const auto tree = match_recursively<s64>(*lhs)(
+      [&](auto, const ConsLit &lit) -> s64 { return ++walked, lit.value; },
+      [&](auto recurse, const ConsAdd &add) -> s64 {
+        return ++walked, recurse(*add.lhs) + recurse(*add.rhs);
+      },
+      [&](auto recurse, const ConsMul &mul) -> s64 {
+        return ++walked, recurse(*mul.lhs) * recurse(*mul.rhs);
+      });
+  auto evaluated = 0;
+  const auto shared = match_shared<s64>(lhs)(
+      [&](auto, const ConsLit &lit) -> s64 { return ++evaluated, lit.value; },
+      [&](auto recurse, const ConsAdd &add) -> s64 {
+        return ++evaluated, recurse(add.lhs) + recurse(add.rhs);
+      },
+      [&](auto recurse, const ConsMul &mul) -> s64 {
+        return ++evaluated, recurse(mul.lhs) * recurse(mul.rhs);
+      });
+  ASSERT_EQ(tree, 9);
+  ASSERT_EQ(shared, 9);
+  ASSERT_EQ(walked, 7);
+  ASSERT_EQ(evaluated, 4);
+}
+
+TEST(hashcons, TestCollect) {
+  auto table = HashCons<ConsExpr>();
+  const auto chain = [&table](const s64 len) {
+    auto root = table.make(ConsLit{0});
+    for (s64 i = 1; i < len; ++i) {
+      root = table.make(ConsAdd{root, table.make(ConsLit{i})});
+    }
+    return root;
+  };
+  const auto kept = std::array{chain(10)};
+  static_cast<void>(chain(20));
+  ASSERT_EQ(table.size(), 39);
+  // Nodes interned since the last collect are young and survive it.
+  ASSERT_EQ(table.collect(kept), 0);
+  const auto revived = table.make(ConsLit{15});
+  ASSERT_EQ(table.collect(kept), 19);
+  ASSERT_EQ(table.size(), 20);
+  ASSERT_EQ(revived->_data.index(), 0);
+  ASSERT_EQ(table.collect(kept), 1);
+  ASSERT_TRUE(chain(10) == kept[0]);
+  ASSERT_EQ(table.size(), 19);
+}
+
 TEST(traits, IsPattern) {
   static_assert(traits::Pattern<Option<u8>>);
 }
@@ -167,17 +1701,25 @@ TEST(traits, Sized) {
 }
 
 struct ReadError {
-  [[nodiscard]] auto description() const -> std::string {
+  [[nodiscard]] auto description() const -> std::string_view {
     return "Read Error";
   }
 };
 
 struct WriteError {
-  [[nodiscard]] auto description() const -> std::string {
+  [[nodiscard]] auto description() const -> std::string_view {
     return "Write Error";
   }
 };
 
+struct OffsetError {
+  usize offset{};
+
+  template <typename OutputIt> auto format_to(OutputIt out) const -> OutputIt {
+    return fmt::format_to(out, "Bad byte at {}", offset);
+  }
+};
+
 using IOError = Union<ReadError, WriteError>;
 
 TEST(traits, Error) {
@@ -189,6 +1731,251 @@ TEST(traits, Error) {
   );
 }
 
+auto count_to(const ssize n) -> Generator<ssize> {
+  for (ssize i = 0; i < n; ++i) {
+    co_yield i;
+  }
+}
+
+auto count_nested(const ssize depth) -> Generator<ssize> {
+  if (depth == 0) {
+    co_return;
+  }
+  co_yield depth;
+  co_yield count_nested(depth - 1);
+  co_yield -depth;
+}
+
+TEST(generator, TestGenerator) {
+  ssize res = 0;
+  for (auto i : count_to(4)) {
+    res += i;
+  }
+  ASSERT_EQ(res, 6);
+}
+
+TEST(generator, TestYieldFrom) {
+  auto res = std::vector<ssize>{};
+  for (auto i : count_nested(3)) {
+    res.push_back(i);
+  }
+  ASSERT_EQ(res, (std::vector<ssize>{3, 2, 1, -1, -2, -3}));
+}
+
+TEST(generator, TestRangeSource) {
+  ssize res = 0;
+  for (auto i : generate(Range(0, 3, 1)) |
+                    std::views::filter([](ssize i) { return i % 2 == 1; })) {
+    res += i;
+  }
+  ASSERT_EQ(res, 4);
+  static_assert(std::ranges::input_range<Generator<ssize>>);
+  static_assert(std::ranges::view<Generator<ssize>>);
+}
+
+TEST(queue, TestSpscPushPop) {
+  auto queue = SpscQueue<u32, 4>{};
+  for (u32 i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.try_push(i).is_none());
+  }
+  ASSERT_EQ(queue.try_push(4), Option<u32>(4));
+
+  for (u32 i = 0; i < 4; ++i) {
+    ASSERT_EQ(queue.try_pop(), Option<u32>(i));
+  }
+  ASSERT_TRUE(queue.try_pop().is_none());
+}
+
+TEST(queue, TestMpmcBatch) {
+  auto queue = MpmcQueue<u32>(5); // NOLINT
+  ASSERT_EQ(queue.capacity(), 8);
+
+  u32 in[10]{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}; // NOLINT
+  u32 out[10]{};                            // NOLINT
+  ASSERT_EQ(queue.push_batch(Slice<u32>::from_unchecked(in, 10)), 8);
+  ASSERT_EQ(queue.pop_batch(Slice<u32>::from_unchecked(out, 3)), 3);
+  ASSERT_EQ(queue.pop_batch(Slice<u32>::from_unchecked(out + 3, 7)), 5);
+  for (u32 i = 0; i < 8; ++i) {
+    ASSERT_EQ(out[i], i);
+  }
+}
+
+TEST(queue, TestSpscStress) {
+  static constexpr u64 count = 200000;
+  auto queue = SpscQueue<u64, 64>{};
+
+  auto producer = std::thread([&queue]() {
+    for (u64 i = 0; i < count; ++i) {
+      while (queue.try_push(i).is_some()) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  u64 expected = 0;
+  while (expected < count) {
+    if (auto val = queue.try_pop(); val.is_some()) {
+      ASSERT_EQ(val.unwrap(), expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+}
+
+TEST(queue, TestMpmcStress) {
+  static constexpr u64 threads = 4;
+  static constexpr u64 count = 50000;
+  auto queue = MpmcQueue<u64>(128); // NOLINT
+  auto sum = std::atomic<u64>{0};
+  auto popped = std::atomic<u64>{0};
+
+  auto workers = std::vector<std::thread>{};
+  for (u64 t = 0; t < threads; ++t) {
+    workers.emplace_back([&queue]() {
+      for (u64 i = 1; i <= count; ++i) {
+        while (queue.try_push(i).is_some()) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    workers.emplace_back([&]() {
+      while (popped.load() < threads * count) {
+        if (auto val = queue.try_pop(); val.is_some()) {
+          sum += val.unwrap();
+          ++popped;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  ASSERT_EQ(sum.load(), threads * count * (count + 1) / 2);
+}
+
+TEST(err, TestFormatError) {
+  static_assert(traits::Error<ReadError>);
+  static_assert(traits::Error<OffsetError>);
+  ASSERT_EQ(fmt::format("{}", ReadError{}), "Read Error");
+  ASSERT_EQ(fmt::format("{}", OffsetError{3}), "Bad byte at 3");
+}
+
+TEST(err, TestContext) {
+  auto res = Result<u32, ReadError>(ReadError{});
+  auto chained = res.context("reading header").context("loading file");
+  static_assert(
+      std::is_same_v<decltype(chained), Result<u32, Context<ReadError>>>);
+  ASSERT_EQ(fmt::format("{}", chained),
+            "Err(loading file: reading header: Read Error)");
+
+  auto ok = Result<u32, OffsetError>(1).context("parsing");
+  ASSERT_EQ(ok.unwrap(), 1);
+}
+
+TEST(err, TestContextOverflow) {
+  auto err = Context<OffsetError, 2>(OffsetError{1});
+  err = err.with("a").with("b").with("c");
+  ASSERT_EQ(fmt::format("{}", err), "c: b: (+1 frames): Bad byte at 1");
+  err = err.with("d").with("e");
+  ASSERT_EQ(fmt::format("{}", err), "e: d: (+3 frames): Bad byte at 1");
+}
+
+auto parse_digit(const char c) -> Result<u32, ReadError> {
+  if (c < '0' || c > '9') {
+    return {ReadError{}};
+  }
+  return {static_cast<u32>(c - '0')};
+}
+
+auto parse_pair(const char lhs, const char rhs) -> Result<u32, ReadError> {
+  auto tens = EXL_TRY(parse_digit(lhs));
+  auto ones = EXL_TRY(parse_digit(rhs));
+  return {tens * 10 + ones}; // NOLINT
+}
+
+auto parse_sum(const char lhs, const char rhs) -> Result<u32, ReadError> {
+  return {EXL_TRY(parse_pair(lhs, rhs)) + 1};
+}
+
+auto parse_sum_let(const char lhs, const char rhs) -> Result<u32, ReadError> {
+  EXL_TRY_LET(pair, parse_pair(lhs, rhs));
+  return {pair + 1};
+}
+
+[[gnu::noinline]] auto make_read_error() -> Result<u32, ReadError> {
+  return {ReadError{}};
+}
+
+TEST(traceback, TestErrorTrace) {
+  trace::clear();
+  ASSERT_EQ(parse_sum('4', '2').unwrap(), 43);
+  ASSERT_TRUE(trace::local().is_empty());
+
+  // The origin in parse_digit, then the hops in parse_pair and parse_sum.
+  ASSERT_TRUE(parse_sum('4', 'x').is_err());
+  auto hops = trace::take();
+  ASSERT_EQ(hops.len, 3);
+  ASSERT_TRUE(trace::local().is_empty());
+  ASSERT_TRUE(fmt::format("{}", hops).starts_with("Error return trace:"));
+
+  ASSERT_EQ(parse_sum_let('4', '2').unwrap(), 43);
+  ASSERT_TRUE(parse_sum_let('4', 'x').is_err());
+  ASSERT_EQ(trace::take().len, 3);
+
+  // The origin is the function creating the error, not Result's
+  // constructor, whatever the optimization level.
+  ASSERT_TRUE(make_read_error().is_err());
+  const auto *origin = static_cast<u8 *>(trace::take().frames[0]);
+  const auto *start = reinterpret_cast<u8 *>(&make_read_error); // NOLINT
+  ASSERT_GT(origin, start);
+  ASSERT_LT(origin, start + 256);
+}
+
+TEST(traceback, TestErrorTraceAfterHandled) {
+  for (auto i = 0; i < 40; ++i) { // NOLINT
+    ASSERT_EQ(parse_sum('x', '1').unwrap_or(0), 0);
+  }
+  ASSERT_TRUE(parse_pair('4', 'x').is_err());
+  auto hops = trace::take();
+  ASSERT_EQ(hops.len, 2);
+  ASSERT_EQ(hops.dropped, 0);
+
+  // Adding context passes the error on rather than starting over.
+  const auto res = Result<u32, ReadError>(ReadError{});
+  ASSERT_TRUE(res.context("pair").is_err());
+  ASSERT_EQ(trace::take().len, 1);
+}
+
+auto add_one(const s32 val) -> s32 { return val + 1; }
+
+TEST(function, TestFnRef) {
+  auto offset = 10;
+  auto add = [&offset](s32 val) { return val + offset; };
+
+  auto fn = FnRef<s32(s32)>(add);
+  ASSERT_EQ(fn(1), 11);
+  offset = 20; // NOLINT
+  ASSERT_EQ(fn(1), 21);
+
+  ASSERT_EQ(FnRef<s32(s32)>(add_one)(1), 2);
+  ASSERT_EQ(Option<s32>().unwrap_or_else([&offset]() { return offset; }), 20);
+}
+
+TEST(function, TestInplaceFn) {
+  auto owned = std::make_unique<s32>(5);
+  auto fn = InplaceFn<s32(s32)>(
+      [owned = std::move(owned)](s32 val) { return val * *owned; });
+  ASSERT_EQ(fn(2), 10);
+
+  auto moved = std::move(fn);
+  ASSERT_TRUE(fn.is_empty());
+  ASSERT_EQ(moved(3), 15);
+}
+
 auto main(int argc, char **argv) -> int {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();